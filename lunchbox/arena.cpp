@@ -0,0 +1,147 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "arena.h"
+
+#include <stdlib.h>
+
+namespace lunchbox
+{
+namespace detail
+{
+/** The header of a chunk, followed by its memory */
+struct ArenaChunk
+{
+    ArenaChunk* next;
+    size_t size; // including this header
+};
+}
+
+namespace
+{
+typedef detail::ArenaChunk Chunk;
+
+// Keeps the memory after the header aligned like malloc
+const size_t _headerSize = ( sizeof( Chunk ) + 15 ) & ~size_t( 15 );
+
+Chunk* _newChunk( const size_t size )
+{
+    Chunk* chunk = static_cast< Chunk* >( ::malloc( size ));
+    if( !chunk )
+        throw std::bad_alloc();
+    chunk->size = size;
+    return chunk;
+}
+
+uint8_t* _getBegin( Chunk* chunk )
+{
+    return reinterpret_cast< uint8_t* >( chunk ) + _headerSize;
+}
+
+uint8_t* _getEnd( Chunk* chunk )
+{
+    return reinterpret_cast< uint8_t* >( chunk ) + chunk->size;
+}
+}
+
+Arena::Arena( const size_t chunkSize )
+    : _pos( 0 )
+    , _end( 0 )
+    , _chunks( 0 )
+    , _free( 0 )
+    , _chunkSize( chunkSize )
+{
+    LBASSERT( chunkSize > _headerSize );
+}
+
+Arena::~Arena()
+{
+    clear();
+}
+
+void Arena::reset()
+{
+    while( _chunks )
+    {
+        Chunk* chunk = _chunks;
+        _chunks = chunk->next;
+        if( chunk->size == _chunkSize )
+        {
+            chunk->next = _free;
+            _free = chunk;
+        }
+        else
+            ::free( chunk );
+    }
+    _pos = _end = 0;
+}
+
+void Arena::clear()
+{
+    reset();
+    while( _free )
+    {
+        Chunk* chunk = _free;
+        _free = chunk->next;
+        ::free( chunk );
+    }
+}
+
+size_t Arena::getCapacity() const
+{
+    size_t capacity = 0;
+    for( const Chunk* chunk = _chunks; chunk; chunk = chunk->next )
+        capacity += chunk->size;
+    return capacity;
+}
+
+void* Arena::_allocateChunk( const size_t size, const size_t alignment )
+{
+    const size_t needed = _headerSize + size + alignment - 1;
+    if( needed > _chunkSize )
+    {
+        // Dedicated chunk, keep allocating from the current one
+        Chunk* chunk = _newChunk( needed );
+        if( _chunks )
+        {
+            chunk->next = _chunks->next;
+            _chunks->next = chunk;
+        }
+        else
+        {
+            chunk->next = 0;
+            _chunks = chunk;
+        }
+        const uintptr_t pos = ( uintptr_t( _getBegin( chunk )) + alignment - 1 )
+                              & ~uintptr_t( alignment - 1 );
+        return reinterpret_cast< void* >( pos );
+    }
+
+    Chunk* chunk = _free;
+    if( chunk )
+        _free = chunk->next;
+    else
+        chunk = _newChunk( _chunkSize );
+
+    chunk->next = _chunks;
+    _chunks = chunk;
+    _pos = _getBegin( chunk );
+    _end = _getEnd( chunk );
+    return allocate( size, alignment );
+}
+
+}
@@ -0,0 +1,187 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_ARENA_H
+#define LUNCHBOX_ARENA_H
+
+#include <lunchbox/api.h>
+#include <lunchbox/compiler.h> // LB_LIKELY
+#include <lunchbox/debug.h>    // used inline
+#include <lunchbox/types.h>
+#include <boost/noncopyable.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+
+#include <limits>
+#include <new>
+
+namespace lunchbox
+{
+namespace detail { struct ArenaChunk; }
+
+/**
+ * A region allocator for many short-lived objects.
+ *
+ * Memory is allocated by advancing a pointer in the current chunk, and is
+ * released in bulk by reset() or on destruction. Individual allocations can not
+ * be freed. A new chunk is chained when the current one is exhausted;
+ * allocations larger than a chunk get a chunk of their own. reset() keeps the
+ * standard-sized chunks for reuse, so a frame- or request-scoped arena does
+ * not use the system allocator once it has reached its working set.
+ *
+ * The arena does not call destructors, and it is not thread-safe. Use
+ * ArenaAllocator to allocate the elements of STL containers from an arena.
+ *
+ * Example: @include tests/arena.cpp
+ */
+class Arena : public boost::noncopyable
+{
+public:
+    /**
+     * Construct a new, empty arena.
+     *
+     * @param chunkSize the size of the chunks allocated from the system.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API explicit Arena( size_t chunkSize = 65536 );
+
+    /** Destruct the arena and release all memory. @version 1.9.2 */
+    LUNCHBOX_API ~Arena();
+
+    /**
+     * Allocate uninitialized memory.
+     *
+     * @param size the number of bytes.
+     * @param alignment the alignment of the memory, a power of two.
+     * @return the memory, valid until the next reset().
+     * @throw std::bad_alloc if no chunk can be allocated.
+     * @version 1.9.2
+     */
+    void* allocate( const size_t size, const size_t alignment = 16 )
+    {
+        LBASSERTINFO(( alignment & ( alignment - 1 )) == 0,
+                     "Alignment " << alignment << " is not a power of two" );
+        const uintptr_t pos = ( uintptr_t( _pos ) + alignment - 1 ) &
+                              ~uintptr_t( alignment - 1 );
+        if( LB_LIKELY( pos + size <= uintptr_t( _end ) && pos != 0 ))
+        {
+            _pos = reinterpret_cast< uint8_t* >( pos + size );
+            return reinterpret_cast< void* >( pos );
+        }
+        return _allocateChunk( size, alignment );
+    }
+
+    /** @return uninitialized memory for n objects of type T. @version 1.9.2 */
+    template< class T > T* allocate( const size_t n = 1 )
+    {
+        return static_cast< T* >( allocate( n * sizeof( T ),
+                                            boost::alignment_of< T >::value ));
+    }
+
+    /**
+     * Release all allocations at once.
+     *
+     * Standard-sized chunks are kept for reuse by later allocations.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API void reset();
+
+    /** Release all allocations and all memory. @version 1.9.2 */
+    LUNCHBOX_API void clear();
+
+    /** @return the size of the chunks in use. @version 1.9.2 */
+    LUNCHBOX_API size_t getCapacity() const;
+
+    /** @return the size of standard chunks. @version 1.9.2 */
+    size_t getChunkSize() const { return _chunkSize; }
+
+private:
+    uint8_t* _pos; // next free byte in the current chunk
+    uint8_t* _end; // end of the current chunk
+    detail::ArenaChunk* _chunks; // chunks in use, the current one first
+    detail::ArenaChunk* _free; // standard chunks kept by reset()
+    const size_t _chunkSize;
+
+    LUNCHBOX_API void* _allocateChunk( size_t size, size_t alignment );
+};
+
+/**
+ * An STL allocator allocating from an Arena.
+ *
+ * Deallocation is a no-op, the memory is released with the arena. Containers
+ * using the allocator must be destroyed or cleared before the arena is reset.
+ * @version 1.9.2
+ */
+template< class T > class ArenaAllocator
+{
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    /** The allocator for another type. @version 1.9.2 */
+    template< class U > struct rebind { typedef ArenaAllocator< U > other; };
+
+    /** Construct an allocator for the given arena. @version 1.9.2 */
+    explicit ArenaAllocator( Arena& arena ) : _arena( &arena ) {}
+
+    /** Construct an allocator from one for another type. @version 1.9.2 */
+    template< class U > ArenaAllocator( const ArenaAllocator< U >& from )
+        : _arena( &from.getArena( )) {}
+
+    /** @return uninitialized memory for n objects. @version 1.9.2 */
+    pointer allocate( const size_type n, const void* = 0 )
+        { return _arena->allocate< T >( n ); }
+
+    /** Does nothing, the memory is released with the arena. @version 1.9.2 */
+    void deallocate( pointer, size_type ) {}
+
+    /** Copy-construct an object in place. @version 1.9.2 */
+    void construct( pointer p, const T& value ) { new( p ) T( value ); }
+
+    /** Destroy an object in place. @version 1.9.2 */
+    void destroy( pointer p ) { p->~T(); }
+
+    /** @return the address of an object. @version 1.9.2 */
+    pointer address( reference x ) const { return &x; }
+
+    /** @return the address of an object. @version 1.9.2 */
+    const_pointer address( const_reference x ) const { return &x; }
+
+    /** @return the maximum number of objects. @version 1.9.2 */
+    size_type max_size() const
+        { return std::numeric_limits< size_type >::max() / sizeof( T ); }
+
+    /** @return the arena used by this allocator. @version 1.9.2 */
+    Arena& getArena() const { return *_arena; }
+
+    /** @return true if both allocate from the same arena. @version 1.9.2 */
+    template< class U > bool operator == ( const ArenaAllocator< U >& rhs )
+        const { return _arena == &rhs.getArena(); }
+
+    /** @return true if both allocate from different arenas. @version 1.9.2 */
+    template< class U > bool operator != ( const ArenaAllocator< U >& rhs )
+        const { return _arena != &rhs.getArena(); }
+
+private:
+    Arena* _arena;
+};
+}
+#endif // LUNCHBOX_ARENA_H
@@ -33,6 +33,52 @@
 
 namespace lunchbox
 {
+/**
+ * The memory ordering of an atomic operation, see C++11 std::memory_order.
+ *
+ * Compilers without the C++11 atomic builtins perform all operations
+ * sequentially consistent.
+ * @version 1.9.2
+ */
+enum MemoryOrder
+{
+    ORDER_RELAXED, //!< Atomicity only, no ordering of other accesses
+    ORDER_ACQUIRE, //!< Later accesses are not reordered before the operation
+    ORDER_RELEASE, //!< Earlier accesses are not reordered after the operation
+    ORDER_ACQ_REL, //!< Both acquire and release semantics
+    ORDER_SEQ_CST  //!< Acquire and release in a single total order
+};
+
+#if defined( LB_GCC_4_7_OR_LATER ) || defined( __clang__ )
+namespace detail
+{
+/** @internal @return the builtin memory order constant. */
+inline int getBuiltinOrder( const MemoryOrder order )
+{
+    switch( order )
+    {
+    case ORDER_RELAXED: return __ATOMIC_RELAXED;
+    case ORDER_ACQUIRE: return __ATOMIC_ACQUIRE;
+    case ORDER_RELEASE: return __ATOMIC_RELEASE;
+    case ORDER_ACQ_REL: return __ATOMIC_ACQ_REL;
+    default:            return __ATOMIC_SEQ_CST;
+    }
+}
+
+/** @internal @return the strongest valid failure order of a CAS. */
+inline int getBuiltinFailureOrder( const MemoryOrder order )
+{
+    switch( order )
+    {
+    case ORDER_RELAXED:
+    case ORDER_RELEASE: return __ATOMIC_RELAXED;
+    case ORDER_ACQUIRE:
+    case ORDER_ACQ_REL: return __ATOMIC_ACQUIRE;
+    default:            return __ATOMIC_SEQ_CST;
+    }
+}
+}
+#endif
 
 /** Perform a full memory barrier. */
 inline void memoryBarrier()
@@ -72,6 +118,35 @@ inline void memoryBarrierRelease()
 #endif
 }
 
+/** Perform a memory barrier with the given ordering. @version 1.9.2 */
+inline void memoryBarrier( const MemoryOrder order )
+{
+#if defined( LB_GCC_4_7_OR_LATER ) || defined( __clang__ )
+    __atomic_thread_fence( detail::getBuiltinOrder( order ));
+#else
+    if( order != ORDER_RELAXED )
+        memoryBarrier();
+#endif
+}
+
+/**
+ * Hint the processor that the calling thread is busy-waiting.
+ *
+ * Reduces the power consumption and the penalty on the sibling hyper-thread
+ * in spin loops.
+ * @version 1.9.2
+ */
+inline void spinPause()
+{
+#if defined( __GNUC__ ) && ( defined( __i386__ ) || defined( __x86_64__ ))
+    __asm__ __volatile__( "pause" ::: "memory" );
+#elif defined( __GNUC__ ) && ( defined( __aarch64__ ) || defined( __arm__ ))
+    __asm__ __volatile__( "yield" ::: "memory" );
+#elif defined( _MSC_VER )
+    _mm_pause();
+#endif
+}
+
 /**
  * A variable with atomic semantics and standalone atomic operations.
  *
@@ -83,6 +158,13 @@ inline void memoryBarrierRelease()
  * For implementation reasons, only signed atomic variables are supported, of
  * which int32_t and ssize_t are implemented and typedef'd as a_int32_t and
  * a_ssize_t.
+ *
+ * The member operators and the static operations without a MemoryOrder
+ * parameter are sequentially consistent. The member load and assignment
+ * operators use a full memory barrier, which orders them also against plain
+ * accesses and other atomic operations, as needed by Dekker-style code. The
+ * static operations taking a MemoryOrder allow lock-free code to use the
+ * weakest sufficient ordering.
  */
 template< class T > class Atomic
 {
@@ -109,6 +191,40 @@ public:
     LUNCHBOX_API static bool compareAndSwap( T* value, const T expected,
                                              const T newValue );
 
+    /** @return the value, loaded with acquire semantics. @version 1.9.2 */
+    static T loadAcquire( const T& value );
+
+    /** Store a new value with release semantics. @version 1.9.2 */
+    static void storeRelease( T& value, const T newValue );
+
+    /** @name Operations with explicit memory ordering. */
+    //@{
+    /** @return the value, loaded with the given order. @version 1.9.2 */
+    static T load( const T& value, MemoryOrder order );
+
+    /** Store a new value with the given order. @version 1.9.2 */
+    static void store( T& value, const T newValue, MemoryOrder order );
+
+    /** @return the old value, then add the given increment. @version 1.9.2 */
+    static T getAndAdd( T& value, const T increment, MemoryOrder order );
+
+    /** @return the old value, then substract the increment. @version 1.9.2 */
+    static T getAndSub( T& value, const T increment, MemoryOrder order );
+
+    /** @return the old value, then set the new value. @version 1.9.2 */
+    static T getAndSet( T& value, const T newValue, MemoryOrder order );
+
+    /**
+     * Perform a compare-and-swap atomic operation.
+     *
+     * A failed operation has the strongest valid ordering not stronger than
+     * the given order.
+     * @version 1.9.2
+     */
+    static bool compareAndSwap( T* value, const T expected, const T newValue,
+                                MemoryOrder order );
+    //@}
+
     /** Construct a new atomic variable with an initial value. @version 1.0 */
     explicit Atomic( const T v = 0 );
 
@@ -309,6 +425,122 @@ template< class T > T Atomic< T >::decAndGet( T& value )
 }
 #endif
 
+#if defined( LB_GCC_4_7_OR_LATER ) || defined( __clang__ )
+template< class T > T Atomic< T >::loadAcquire( const T& value )
+{
+    return __atomic_load_n( &value, __ATOMIC_ACQUIRE );
+}
+
+template< class T > void Atomic< T >::storeRelease( T& value, const T newValue )
+{
+    __atomic_store_n( &value, newValue, __ATOMIC_RELEASE );
+}
+#else
+template< class T > T Atomic< T >::loadAcquire( const T& value )
+{
+    const T result = *static_cast< const volatile T* >( &value );
+    memoryBarrierAcquire();
+    return result;
+}
+
+template< class T > void Atomic< T >::storeRelease( T& value, const T newValue )
+{
+    memoryBarrierRelease();
+    *static_cast< volatile T* >( &value ) = newValue;
+}
+#endif
+
+#if defined( LB_GCC_4_7_OR_LATER ) || defined( __clang__ )
+template< class T >
+T Atomic< T >::load( const T& value, const MemoryOrder order )
+{
+    return __atomic_load_n( &value, detail::getBuiltinOrder( order ));
+}
+
+template< class T >
+void Atomic< T >::store( T& value, const T newValue, const MemoryOrder order )
+{
+    __atomic_store_n( &value, newValue, detail::getBuiltinOrder( order ));
+}
+
+template< class T > T Atomic< T >::getAndAdd( T& value, const T increment,
+                                              const MemoryOrder order )
+{
+    return __atomic_fetch_add( &value, increment,
+                               detail::getBuiltinOrder( order ));
+}
+
+template< class T > T Atomic< T >::getAndSub( T& value, const T increment,
+                                              const MemoryOrder order )
+{
+    return __atomic_fetch_sub( &value, increment,
+                               detail::getBuiltinOrder( order ));
+}
+
+template< class T > T Atomic< T >::getAndSet( T& value, const T newValue,
+                                              const MemoryOrder order )
+{
+    return __atomic_exchange_n( &value, newValue,
+                                detail::getBuiltinOrder( order ));
+}
+
+template< class T >
+bool Atomic< T >::compareAndSwap( T* value, T expected, const T newValue,
+                                  const MemoryOrder order )
+{
+    const int failureOrder = detail::getBuiltinFailureOrder( order );
+    return __atomic_compare_exchange_n( value, &expected, newValue, false,
+                                        detail::getBuiltinOrder( order ),
+                                        failureOrder );
+}
+#else
+template< class T >
+T Atomic< T >::load( const T& value, const MemoryOrder order )
+{
+    if( order == ORDER_SEQ_CST )
+        memoryBarrier();
+    return loadAcquire( value );
+}
+
+template< class T >
+void Atomic< T >::store( T& value, const T newValue, const MemoryOrder order )
+{
+    storeRelease( value, newValue );
+    if( order == ORDER_SEQ_CST )
+        memoryBarrier();
+}
+
+template< class T > T Atomic< T >::getAndAdd( T& value, const T increment,
+                                              const MemoryOrder )
+{
+    return getAndAdd( value, increment );
+}
+
+template< class T > T Atomic< T >::getAndSub( T& value, const T increment,
+                                              const MemoryOrder )
+{
+    return getAndSub( value, increment );
+}
+
+template< class T > T Atomic< T >::getAndSet( T& value, const T newValue,
+                                              const MemoryOrder )
+{
+    for( ;; )
+    {
+        const T oldValue = loadAcquire( value );
+        if( compareAndSwap( &value, oldValue, newValue ))
+            return oldValue;
+    }
+}
+
+template< class T >
+bool Atomic< T >::compareAndSwap( T* value, const T expected, const T newValue,
+                                  const MemoryOrder )
+{
+    return compareAndSwap( value, expected, newValue );
+}
+#endif
+
 template< class T > Atomic< T >::Atomic ( const T v ) : _value(v) {}
 
 template <class T>
@@ -317,13 +549,14 @@ Atomic< T >::Atomic( const Atomic< T >& v ) : _value( v._value ) {}
 template <class T>
 Atomic< T >::operator T(void) const
 {
-    memoryBarrierAcquire();
-    return _value;
+    // full barrier: a seq_cst load does not order earlier stores on x86
+    memoryBarrier();
+    return load( _value, ORDER_RELAXED );
 }
 
 template< class T > void Atomic< T >::operator = ( const T v )
 {
-    _value = v;
+    store( _value, v, ORDER_RELAXED );
     memoryBarrier();
 }
 
@@ -0,0 +1,75 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "barrier.h"
+
+#include "debug.h"
+#include "detail/waitWord.h"
+
+namespace lunchbox
+{
+Barrier::Barrier( const uint32_t size )
+    : _size( int32_t( size ))
+    , _remaining( int32_t( size ))
+    , _phase( 0 )
+    , _nWaiting( 0 )
+    , _policy( detail::getDefaultWaitPolicy( ))
+{
+    LBASSERT( size > 0 );
+    memoryBarrier();
+}
+
+Barrier::Barrier( const uint32_t size, const WaitPolicy& policy )
+    : _size( int32_t( size ))
+    , _remaining( int32_t( size ))
+    , _phase( 0 )
+    , _nWaiting( 0 )
+    , _policy( policy )
+{
+    LBASSERT( size > 0 );
+    memoryBarrier();
+}
+
+Barrier::~Barrier()
+{
+    LBASSERTINFO( _remaining == _size, "Barrier destroyed during a phase" );
+}
+
+bool Barrier::enter()
+{
+    // Read before arriving: the phase can only advance after this arrival
+    const int32_t phase = Atomic< int32_t >::load( _phase, ORDER_RELAXED );
+    if( Atomic< int32_t >::getAndSub( _remaining, 1, ORDER_ACQ_REL ) > 1 )
+    {
+        detail::waitWord( _phase, phase, _nWaiting, _policy, _stats );
+        return false;
+    }
+
+    // Last thread: all others wait on the phase, nobody touches the counter
+    Atomic< int32_t >::store( _remaining, _size, ORDER_RELAXED );
+    Atomic< int32_t >::store( _phase, int32_t( uint32_t( phase ) + 1 ),
+                              ORDER_SEQ_CST );
+    detail::wakeWord( _phase, _nWaiting );
+    return true;
+}
+
+uint32_t Barrier::getPhase() const
+{
+    return uint32_t( Atomic< int32_t >::load( _phase, ORDER_ACQUIRE ));
+}
+
+}
@@ -0,0 +1,105 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_BARRIER_H
+#define LUNCHBOX_BARRIER_H
+
+#include <lunchbox/api.h>
+#include <lunchbox/types.h>
+#include <lunchbox/waitPolicy.h> // member
+#include <boost/noncopyable.hpp>
+
+namespace lunchbox
+{
+/**
+ * A reusable barrier for a fixed number of threads.
+ *
+ * Each thread calls enter() once per phase, which returns when all threads of
+ * the phase have entered. The barrier is sense-reversing: arriving threads
+ * decrement a counter without taking a lock, and the last thread resets the
+ * counter and advances the phase word on which the others wait. Waiting
+ * threads spin, yield and block according to a WaitPolicy, and the last thread
+ * only makes a system call if threads are blocked.
+ *
+ * Example: @include tests/barrier.cpp
+ * @sa Latch
+ */
+class Barrier : public boost::noncopyable
+{
+public:
+    /**
+     * Construct a new barrier with the default wait policy.
+     *
+     * The default policy spins briefly before blocking on multi-core machines,
+     * and blocks immediately otherwise.
+     *
+     * @param size the number of threads per phase.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API explicit Barrier( uint32_t size );
+
+    /**
+     * Construct a new barrier.
+     *
+     * @param size the number of threads per phase.
+     * @param policy how threads wait for the last thread.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API Barrier( uint32_t size, const WaitPolicy& policy );
+
+    /** Destruct the barrier. @version 1.9.2 */
+    LUNCHBOX_API ~Barrier();
+
+    /**
+     * Enter the barrier and wait for all threads of the current phase.
+     *
+     * @return true for the last thread of the phase, false for all others.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API bool enter();
+
+    /** @return the number of threads per phase. @version 1.9.2 */
+    uint32_t getSize() const { return uint32_t( _size ); }
+
+    /** @return the number of completed phases. @version 1.9.2 */
+    LUNCHBOX_API uint32_t getPhase() const;
+
+    /** @name Wait policy and statistics. */
+    //@{
+    /** Set how threads wait, not thread-safe. @version 1.9.2 */
+    void setWaitPolicy( const WaitPolicy& policy ) { _policy = policy; }
+
+    /** @return the policy used by waiting threads. @version 1.9.2 */
+    const WaitPolicy& getWaitPolicy() const { return _policy; }
+
+    /** @return the phases in which waits were satisfied. @version 1.9.2 */
+    WaitStats getWaitStats() const { return _stats.snapshot(); }
+
+    /** Reset the wait statistics, not thread-safe. @version 1.9.2 */
+    void resetWaitStats() { _stats = WaitStats(); }
+    //@}
+
+private:
+    const int32_t _size;
+    int32_t _remaining; // threads yet to enter the current phase
+    int32_t _phase; // advanced by the last thread, waited on
+    int32_t _nWaiting; // number of blocked threads
+    WaitPolicy _policy;
+    WaitStats _stats;
+};
+}
+#endif // LUNCHBOX_BARRIER_H
@@ -0,0 +1,250 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "biasedReferenced.h"
+
+#include "perThread.h"
+#include "scopedMutex.h"
+#include "spinLock.h"
+#include "detail/cpu.h"
+
+#include <map>
+#include <vector>
+
+namespace lunchbox
+{
+namespace detail
+{
+typedef std::vector< const lunchbox::BiasedReferenced* > BiasedObjects;
+
+/** The objects queued by other threads for merging by their owner. */
+class BiasedQueue
+{
+public:
+    explicit BiasedQueue( const int32_t thread_ )
+        : thread( thread_ ), size( 0 ) {}
+
+    /** Unregister and merge the remaining objects on thread exit. */
+    ~BiasedQueue();
+
+    static bool merge( const lunchbox::BiasedReferenced* object )
+        { return object->_mergeQueued(); }
+
+    const int32_t thread;
+    BiasedObjects objects; // protected by the registry lock
+    int32_t size; // hint for the owner, read without locking
+};
+}
+
+namespace
+{
+typedef std::map< int32_t, detail::BiasedQueue* > BiasedQueues;
+
+struct Registry
+{
+    Registry() : lock( "lunchbox::BiasedReferenced" ) {}
+
+    SpinLock lock;
+    BiasedQueues queues;
+};
+
+// Not destroyed, since queues are deleted during static destruction
+Registry& _getRegistry()
+{
+    static Registry* registry = new Registry;
+    return *registry;
+}
+
+lunchbox::PerThread< detail::BiasedQueue > _queue;
+
+void _mergeObjects( const detail::BiasedObjects& objects )
+{
+    for( detail::BiasedObjects::const_iterator i = objects.begin();
+         i != objects.end(); ++i )
+    {
+        detail::BiasedQueue::merge( *i );
+    }
+}
+
+detail::BiasedObjects _takeObjects( detail::BiasedQueue& queue )
+{
+    detail::BiasedObjects objects;
+    ScopedFastWrite mutex( _getRegistry().lock );
+    objects.swap( queue.objects );
+    Atomic< int32_t >::store( queue.size, 0, ORDER_RELAXED );
+    return objects;
+}
+}
+
+detail::BiasedQueue::~BiasedQueue()
+{
+    BiasedObjects remaining;
+    {
+        Registry& registry = _getRegistry();
+        ScopedFastWrite mutex( registry.lock );
+        registry.queues.erase( thread );
+        remaining.swap( objects );
+    }
+    // the exiting thread is still the owner of the queued objects
+    _mergeObjects( remaining );
+}
+
+BiasedReferenced::BiasedReferenced()
+    : _owner( 0 )
+    , _biased( 0 )
+    , _shared( 0 )
+    , _hasBeenDeleted( false )
+{}
+
+BiasedReferenced::~BiasedReferenced()
+{
+    LBASSERT( !_hasBeenDeleted );
+    _hasBeenDeleted = true;
+    LBASSERTINFO( getRefCount() == 0,
+                  "Deleting object with ref count " << getRefCount( ));
+}
+
+void BiasedReferenced::notifyFree()
+{
+    // Don't inline referenced destruction
+    delete this;
+}
+
+#ifdef _WIN32
+int32_t BiasedReferenced::_getThread()
+{
+    return int32_t( detail::getThreadIndex( )) + 1;
+}
+#else
+__thread int32_t BiasedReferenced::_thread = 0;
+
+int32_t BiasedReferenced::_newThread()
+{
+    return int32_t( detail::getThreadIndex( )) + 1;
+}
+#endif
+
+void BiasedReferenced::mergeQueued()
+{
+    detail::BiasedQueue* queue = _queue.get();
+    if( queue )
+        _mergeObjects( _takeObjects( *queue ));
+}
+
+bool BiasedReferenced::_own( const int32_t thread ) const
+{
+    // register the queue before other threads may find this thread as owner
+    if( LB_UNLIKELY( _queue.get() == 0 ))
+    {
+        detail::BiasedQueue* queue = new detail::BiasedQueue( thread );
+        _queue = queue;
+        Registry& registry = _getRegistry();
+        ScopedFastWrite mutex( registry.lock );
+        registry.queues[ thread ] = queue;
+    }
+    return Atomic< int32_t >::compareAndSwap( &_owner, 0, thread,
+                                              ORDER_RELAXED );
+}
+
+bool BiasedReferenced::_unrefShared() const
+{
+    int32_t old = Atomic< int32_t >::load( _shared, ORDER_RELAXED );
+    for( ;; )
+    {
+        int32_t value = old - _one;
+        // released a reference of the owner, which has to merge the counts
+        const bool enqueue = value < 0 && ( old & ( _queued | _merged )) == 0;
+        if( enqueue )
+            value |= _queued;
+
+        // acquire all writes of other holders before destruction
+        if( !Atomic< int32_t >::compareAndSwap( &_shared, old, value,
+                                                ORDER_ACQ_REL ))
+        {
+            old = Atomic< int32_t >::load( _shared, ORDER_RELAXED );
+            continue;
+        }
+
+        if( enqueue )
+            _enqueue();
+        else if( value == _merged )
+        {
+            const_cast< BiasedReferenced* >( this )->notifyFree();
+            return true;
+        }
+        return false;
+    }
+}
+
+bool BiasedReferenced::_merge() const
+{
+    Atomic< int32_t >::store( _owner, -1, ORDER_RELAXED );
+    const int32_t value = Atomic< int32_t >::getAndAdd( _shared, _merged,
+                                                        ORDER_ACQ_REL );
+    const bool last = ( value + _merged == _merged );
+    if( last )
+        const_cast< BiasedReferenced* >( this )->notifyFree();
+
+    // good time to merge other objects released by other threads
+    detail::BiasedQueue* queue = _queue.get();
+    if( queue && Atomic< int32_t >::load( queue->size, ORDER_RELAXED ) > 0 )
+        mergeQueued();
+    return last;
+}
+
+void BiasedReferenced::_enqueue() const
+{
+    {
+        Registry& registry = _getRegistry();
+        ScopedFastWrite mutex( registry.lock );
+        const int32_t owner = Atomic< int32_t >::load( _owner, ORDER_RELAXED );
+        BiasedQueues::const_iterator i = registry.queues.find( owner );
+        if( i != registry.queues.end( ))
+        {
+            detail::BiasedQueue* queue = i->second;
+            queue->objects.push_back( this );
+            Atomic< int32_t >::store( queue->size,
+                                      int32_t( queue->objects.size( )),
+                                      ORDER_RELAXED );
+            return;
+        }
+    }
+    // The owner has merged or exited, and does not change _biased anymore.
+    // The registry lock orders its last changes before the merge.
+    _mergeQueued();
+}
+
+bool BiasedReferenced::_mergeQueued() const
+{
+    int32_t add = -_queued;
+    if( Atomic< int32_t >::load( _owner, ORDER_RELAXED ) != -1 )
+    {
+        add += _biased * _one + _merged;
+        Atomic< int32_t >::store( _biased, 0, ORDER_RELAXED );
+        Atomic< int32_t >::store( _owner, -1, ORDER_RELAXED );
+    }
+
+    const int32_t value = Atomic< int32_t >::getAndAdd( _shared, add,
+                                                        ORDER_ACQ_REL ) + add;
+    if( value != _merged )
+        return false;
+
+    const_cast< BiasedReferenced* >( this )->notifyFree();
+    return true;
+}
+
+}
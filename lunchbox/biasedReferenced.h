@@ -0,0 +1,192 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_BIASEDREFERENCED_H
+#define LUNCHBOX_BIASEDREFERENCED_H
+
+#include <lunchbox/api.h>      // for LUNCHBOX_API
+#include <lunchbox/atomic.h>   // used inline
+#include <lunchbox/compiler.h> // LB_UNLIKELY
+#include <lunchbox/debug.h>    // for LBASSERT
+
+#include <iostream>
+
+namespace lunchbox
+{
+namespace detail { class BiasedQueue; }
+
+/**
+ * Base class for reference-counted objects with a biased reference count.
+ *
+ * Implements the same interface as Referenced, and can be used with RefPtr and
+ * boost::intrusive_ptr. The thread taking the first reference owns the object.
+ * Its references are counted in a plain integer without atomic operations,
+ * while references from other threads use an atomic count. When the owner
+ * releases its last reference, both counts are merged and all further
+ * references use the atomic count.
+ *
+ * A reference taken by the owner may be released by another thread, e.g., when
+ * a RefPtr is passed through a queue. If this makes the shared count negative,
+ * the object is queued for the owner, which merges the counts in
+ * mergeQueued(), when it releases its last reference to any biased object, or
+ * on thread exit. Until then, the object is not deleted. Threads owning
+ * objects released elsewhere should call mergeQueued() periodically.
+ *
+ * This is faster than Referenced if most references are created and released
+ * by the owning thread, and slower otherwise.
+ *
+ * @sa LocalReferenced for objects only used by one thread.
+ */
+class BiasedReferenced
+{
+public:
+    /** Increase the reference count. @version 1.9.2 */
+    void ref( const void* holder LB_UNUSED = 0 ) const
+    {
+#ifndef NDEBUG
+        LBASSERT( !_hasBeenDeleted );
+#endif
+        const int32_t thread = _getThread();
+        const int32_t owner = Atomic< int32_t >::load( _owner, ORDER_RELAXED );
+        if( owner == thread || ( owner == 0 && _own( thread )))
+        {
+            // only written by the owner, read by getRefCount()
+            Atomic< int32_t >::store( _biased, _biased + 1, ORDER_RELAXED );
+        }
+        else
+            Atomic< int32_t >::getAndAdd( _shared, _one, ORDER_RELAXED );
+    }
+
+    /**
+     * Decrease the reference count.
+     *
+     * The object is deleted when the reference count reaches 0.
+     * @return true if the object was deleted, false otherwise.
+     * @version 1.9.2
+     */
+    bool unref( const void* holder LB_UNUSED = 0 ) const
+    {
+#ifndef NDEBUG
+        LBASSERT( !_hasBeenDeleted );
+#endif
+        if( Atomic< int32_t >::load( _owner, ORDER_RELAXED ) != _getThread( ))
+            return _unrefShared();
+
+        LBASSERT( _biased > 0 );
+        Atomic< int32_t >::store( _biased, _biased - 1, ORDER_RELAXED );
+        if( _biased > 0 )
+            return false;
+        return _merge();
+    }
+
+    /** @return the current reference count. @version 1.9.2 */
+    int32_t getRefCount() const
+    {
+        const int32_t shared = Atomic< int32_t >::load( _shared,
+                                                        ORDER_RELAXED );
+        return Atomic< int32_t >::load( _biased, ORDER_RELAXED ) +
+               ( shared & ~( _one - 1 )) / _one;
+    }
+
+    /** @internal holders are not tracked. */
+    void printHolders( std::ostream& ) const {}
+
+    /**
+     * Merge the counts of objects owned by the calling thread and released
+     * by other threads, deleting unreferenced objects.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API static void mergeQueued();
+
+protected:
+    /** Construct a new reference-counted object. @version 1.9.2 */
+    LUNCHBOX_API BiasedReferenced();
+
+    /** Construct a new copy of a reference-counted object. @version 1.9.2 */
+    BiasedReferenced( const BiasedReferenced& )
+        : _owner( 0 )
+        , _biased( 0 )
+        , _shared( 0 )
+        , _hasBeenDeleted( false )
+    {}
+
+    /** Destruct a reference-counted object. @version 1.9.2 */
+    LUNCHBOX_API virtual ~BiasedReferenced();
+
+    /** Assign another object to this object. @version 1.9.2 */
+    // cppcheck-suppress operatorEqVarError
+    BiasedReferenced& operator = ( const BiasedReferenced& ) { return *this; }
+
+    /** Called when the reference count reaches 0. @version 1.9.2 */
+    LUNCHBOX_API virtual void notifyFree();
+
+private:
+    // _shared holds the count of the other threads in units of _one, and the
+    // _merged and _queued flags in the lowest bits. The count is negative if
+    // other threads released more references of the owner than they took.
+    enum
+    {
+        _merged = 1, // the owner merged its count, _biased is unused
+        _queued = 2, // waiting for the owner to merge, not deleted until then
+        _one = 4
+    };
+
+    mutable int32_t _owner;  // index + 1 of the owner, 0 for none, -1 merged
+    mutable int32_t _biased; // references of the owner
+    mutable int32_t _shared;
+    bool _hasBeenDeleted;
+
+#ifdef _WIN32 // thread-local data can't be exported from a DLL
+    LUNCHBOX_API static int32_t _getThread();
+#else
+    LUNCHBOX_API static __thread int32_t _thread; // index + 1 of the thread
+
+    static int32_t _getThread()
+    {
+        if( LB_UNLIKELY( _thread == 0 ))
+            _thread = _newThread();
+        return _thread;
+    }
+
+    LUNCHBOX_API static int32_t _newThread();
+#endif
+
+    LUNCHBOX_API bool _own( int32_t thread ) const;
+    LUNCHBOX_API bool _unrefShared() const;
+    LUNCHBOX_API bool _merge() const;
+    void _enqueue() const;
+    bool _mergeQueued() const;
+    friend class detail::BiasedQueue;
+};
+}
+
+namespace boost
+{
+/** Allow creation of boost::intrusive_ptr from BiasedReferenced. */
+inline void intrusive_ptr_add_ref( lunchbox::BiasedReferenced* referenced )
+{
+    referenced->ref();
+}
+
+/** Allow creation of boost::intrusive_ptr from BiasedReferenced. */
+inline void intrusive_ptr_release( lunchbox::BiasedReferenced* referenced )
+{
+    referenced->unref();
+}
+}
+
+#endif // LUNCHBOX_BIASEDREFERENCED_H
@@ -0,0 +1,233 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "buffer.h"
+
+#include <lunchbox/compiler.h> // LB_CACHELINE_SIZE
+
+#include <algorithm>
+#ifdef _WIN32
+#  include <malloc.h>
+#  include <windows.h>
+#else
+#  include <sys/mman.h>
+#  include <unistd.h>
+#  ifndef MAP_ANONYMOUS
+#    define MAP_ANONYMOUS MAP_ANON
+#  endif
+#endif
+
+namespace lunchbox
+{
+namespace
+{
+const size_t _hugePageSize = 2 * 1024 * 1024;
+
+size_t _queryPageSize()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo( &info );
+    return info.dwPageSize;
+#else
+    return ::sysconf( _SC_PAGESIZE );
+#endif
+}
+
+// also used by buffers constructed during static initialization
+size_t _getPageSize()
+{
+    static const size_t pageSize = _queryPageSize();
+    return pageSize;
+}
+
+size_t _round( const size_t size, const size_t alignment )
+{
+    return ( size + alignment - 1 ) & ~( alignment - 1 );
+}
+
+size_t _getAlignment( const BufferPolicy policy )
+{
+    switch( policy )
+    {
+    case BUFFER_MALLOC:
+        return 0;
+    case BUFFER_CACHELINE:
+        return LB_CACHELINE_SIZE;
+    default:
+        return _getPageSize();
+    }
+}
+
+void* _alignedAlloc( const size_t nBytes, const size_t alignment )
+{
+#ifdef _WIN32
+    return ::_aligned_malloc( nBytes, alignment );
+#else
+    void* data = 0;
+    if( ::posix_memalign( &data, alignment, nBytes ) != 0 )
+        return 0;
+    return data;
+#endif
+}
+
+void _alignedFree( void* data )
+{
+#ifdef _WIN32
+    ::_aligned_free( data );
+#else
+    ::free( data );
+#endif
+}
+
+#ifndef _WIN32
+/** @return the mapping size if the given allocation is mmap-backed, or 0 */
+size_t _getMapSize( const size_t nBytes, const BufferPolicy policy )
+{
+    switch( policy )
+    {
+    case BUFFER_MMAP:
+        return _round( nBytes, _getPageSize( ));
+    case BUFFER_HUGEPAGE:
+        return nBytes >= _hugePageSize ? _round( nBytes, _hugePageSize ) : 0;
+    default:
+        return 0;
+    }
+}
+
+void _adviseHugePages( void* data LB_UNUSED, const size_t size LB_UNUSED )
+{
+#ifdef MADV_HUGEPAGE
+    ::madvise( data, size, MADV_HUGEPAGE );
+#endif
+}
+
+void* _map( const size_t size, const BufferPolicy policy )
+{
+    const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    void* data = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    // needs reserved huge pages, falls back to transparent huge pages
+    if( policy == BUFFER_HUGEPAGE )
+        data = ::mmap( 0, size, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB,
+                       -1, 0 );
+#endif
+    if( data == MAP_FAILED )
+    {
+        data = ::mmap( 0, size, PROT_READ | PROT_WRITE, flags, -1, 0 );
+        if( data == MAP_FAILED )
+            return 0;
+        if( policy == BUFFER_HUGEPAGE )
+            _adviseHugePages( data, size );
+    }
+    return data;
+}
+
+void* _remap( void* data, const size_t oldSize, const size_t newSize,
+              const size_t usedBytes, const BufferPolicy policy )
+{
+#ifdef __linux__
+    void* remapped = ::mremap( data, oldSize, newSize, MREMAP_MAYMOVE );
+    if( remapped != MAP_FAILED )
+    {
+        if( policy == BUFFER_HUGEPAGE && newSize > oldSize )
+            _adviseHugePages( remapped, newSize );
+        return remapped;
+    }
+#endif
+    void* newData = _map( newSize, policy );
+    if( newData )
+    {
+        ::memcpy( newData, data, std::min( usedBytes, newSize ));
+        ::munmap( data, oldSize );
+    }
+    return newData;
+}
+#endif
+}
+
+namespace detail
+{
+void* allocBuffer( const size_t nBytes, const BufferPolicy policy )
+{
+    if( policy == BUFFER_MALLOC )
+        return ::malloc( nBytes );
+#ifndef _WIN32
+    const size_t mapSize = _getMapSize( nBytes, policy );
+    if( mapSize )
+        return _map( mapSize, policy );
+#endif
+    return _alignedAlloc( nBytes, _getAlignment( policy ));
+}
+
+void* reallocBuffer( void* data, const size_t oldBytes, const size_t newBytes,
+                     const size_t usedBytes, const BufferPolicy policy )
+{
+    if( newBytes == 0 )
+    {
+        freeBuffer( data, oldBytes, policy );
+        return 0;
+    }
+    if( !data )
+        return allocBuffer( newBytes, policy );
+    if( policy == BUFFER_MALLOC )
+        return ::realloc( data, newBytes );
+
+#ifdef _WIN32
+    return ::_aligned_realloc( data, newBytes, _getAlignment( policy ));
+#else
+    const size_t oldSize = _getMapSize( oldBytes, policy );
+    const size_t newSize = _getMapSize( newBytes, policy );
+    if( oldSize && newSize )
+    {
+        if( oldSize == newSize )
+            return data;
+        return _remap( data, oldSize, newSize, usedBytes, policy );
+    }
+
+    // aligned memory has no realloc, and huge pages may start or end here
+    void* newData = allocBuffer( newBytes, policy );
+    if( newData )
+    {
+        ::memcpy( newData, data, std::min( usedBytes, newBytes ));
+        freeBuffer( data, oldBytes, policy );
+    }
+    return newData;
+#endif
+}
+
+void freeBuffer( void* data, const size_t nBytes, const BufferPolicy policy )
+{
+    if( !data )
+        return;
+    if( policy == BUFFER_MALLOC )
+    {
+        ::free( data );
+        return;
+    }
+#ifndef _WIN32
+    const size_t mapSize = _getMapSize( nBytes, policy );
+    if( mapSize )
+    {
+        ::munmap( data, mapSize );
+        return;
+    }
+#endif
+    _alignedFree( data );
+}
+}
+}
@@ -19,6 +19,7 @@
 #ifndef LUNCHBOX_BUFFER_H
 #define LUNCHBOX_BUFFER_H
 
+#include <lunchbox/api.h>
 #include <lunchbox/debug.h>       // LBASSERT macro
 #include <lunchbox/os.h>          // setZero used inline
 #include <lunchbox/types.h>
@@ -28,6 +29,37 @@
 
 namespace lunchbox
 {
+/**
+ * The allocation policy of a Buffer.
+ * @version 1.9.2
+ */
+enum BufferPolicy
+{
+    BUFFER_MALLOC,    //!< malloc/realloc, no alignment guarantee
+    BUFFER_CACHELINE, //!< aligned to LB_CACHELINE_SIZE
+    BUFFER_PAGE,      //!< aligned to the page size
+    BUFFER_HUGEPAGE,  //!< page-aligned, large sizes backed by huge pages
+    BUFFER_MMAP       //!< anonymous mmap, grown in place where supported
+};
+
+namespace detail
+{
+/** @internal @return new memory for the given policy. */
+LUNCHBOX_API void* allocBuffer( size_t nBytes, BufferPolicy policy );
+
+/**
+ * @internal Resize memory allocated for the given policy.
+ *
+ * The first usedBytes are retained. A new size of zero frees the memory.
+ * @return the new memory.
+ */
+LUNCHBOX_API void* reallocBuffer( void* data, size_t oldBytes, size_t newBytes,
+                                  size_t usedBytes, BufferPolicy policy );
+
+/** @internal Free memory of the given size allocated for the policy. */
+LUNCHBOX_API void freeBuffer( void* data, size_t nBytes, BufferPolicy policy );
+}
+
 /**
  * A simple memory buffer with some helper functions.
  *
@@ -39,15 +71,30 @@ namespace lunchbox
  * elements. Primarily used for binary data, e.g., in eq::Image. The
  * implementation works like a pool, that is, data is only released when the
  * buffer is deleted or clear() is called.
+ *
+ * The BufferPolicy given at construction selects the allocator. Aligned
+ * policies suit SIMD kernels, BUFFER_HUGEPAGE reduces TLB misses for
+ * multi-megabyte buffers, and BUFFER_MMAP grows large buffers by remapping
+ * pages on Linux instead of copying them.
  */
 template< class T > class Buffer
 {
 public:
     /** Construct a new, empty buffer. @version 1.0 */
-    Buffer() : _data(0), _size(0), _maxSize(0) {}
+    Buffer() : _data(0), _size(0), _maxSize(0), _policy( BUFFER_MALLOC ) {}
 
     /** Construct a new buffer of the given size. @version 1.0 */
-    explicit Buffer( const uint64_t size ) : _data(0), _size(0), _maxSize(0)
+    explicit Buffer( const uint64_t size )
+        : _data(0), _size(0), _maxSize(0), _policy( BUFFER_MALLOC )
+        { reset( size ); }
+
+    /** Construct a new, empty buffer using a policy. @version 1.9.2 */
+    explicit Buffer( const BufferPolicy policy )
+        : _data(0), _size(0), _maxSize(0), _policy( policy ) {}
+
+    /** Construct a buffer of the given size and policy. @version 1.9.2 */
+    Buffer( const uint64_t size, const BufferPolicy policy )
+        : _data(0), _size(0), _maxSize(0), _policy( policy )
         { reset( size ); }
 
     /** "Move" constructor, transfers ownership to new Buffer. @version 1.0 */
@@ -57,7 +104,7 @@ public:
     ~Buffer() { clear(); }
 
     /** Flush the buffer, deleting all data. @version 1.0 */
-    void clear() { if( _data ) free( _data ); _data=0; _size=0; _maxSize=0; }
+    void clear();
 
     /**
      * Tighten the allocated memory to the size of the buffer.
@@ -158,6 +205,17 @@ public:
     /** @return the maximum size of the buffer. @version 1.0 */
     uint64_t getMaxSize() const { return _maxSize; }
 
+    /**
+     * Change the allocation policy.
+     *
+     * Existing data is moved to memory allocated using the new policy.
+     * @version 1.9.2
+     */
+    void setPolicy( BufferPolicy policy );
+
+    /** @return the allocation policy. @version 1.9.2 */
+    BufferPolicy getPolicy() const { return _policy; }
+
 private:
     /** A pointer to the data. */
     T* _data;
@@ -167,6 +225,11 @@ private:
 
     /** The allocation _size of the buffer. */
     uint64_t _maxSize;
+
+    /** The allocator used for _data. */
+    BufferPolicy _policy;
+
+    void _realloc( uint64_t nElems, uint64_t nUsed );
 };
 }
 
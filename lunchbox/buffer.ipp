@@ -21,16 +21,21 @@ namespace lunchbox
 template< class T > Buffer< T >::Buffer( Buffer< T >& from )
 {
     _data = from._data; _size = from._size; _maxSize = from._maxSize;
+    _policy = from._policy;
     from._data = 0; from._size = 0; from._maxSize = 0;
 }
 
+template< class T > void Buffer< T >::clear()
+{
+    if( _data )
+        detail::freeBuffer( _data, _maxSize * sizeof( T ), _policy );
+    _data = 0; _size = 0; _maxSize = 0;
+}
+
 template< class T > T* Buffer< T >::pack()
 {
     if( _maxSize != _size )
-    {
-        _data = static_cast< T* >( realloc( _data, _size * sizeof( T )));
-        _maxSize = _size;
-    }
+        _realloc( _size, _size );
     return _data;
 }
 
@@ -43,15 +48,10 @@ Buffer< T >& Buffer< T >::operator = ( const Buffer< T >& from )
 
 template< class T > T* Buffer< T >::resize( const uint64_t newSize )
 {
+    if( newSize > _maxSize )
+        // avoid excessive reallocs
+        _realloc( newSize + (newSize >> 3), _size );
     _size = newSize;
-    if( newSize <= _maxSize )
-        return _data;
-
-    // avoid excessive reallocs
-    const uint64_t nElems = newSize + (newSize >> 3);
-    const uint64_t nBytes = nElems * sizeof( T );
-    _data = static_cast< T* >( realloc( _data, nBytes ));
-    _maxSize = nElems;
     return _data;
 }
 
@@ -63,11 +63,8 @@ template< class T > void Buffer< T >::grow( const uint64_t newSize )
 
 template< class T > T* Buffer< T >::reserve( const uint64_t newSize )
 {
-    if( newSize <= _maxSize )
-        return _data;
-
-    _data = static_cast< T* >( realloc( _data, newSize * sizeof( T )));
-    _maxSize = newSize;
+    if( newSize > _maxSize )
+        _realloc( newSize, _size );
     return _data;
 }
 
@@ -111,14 +108,17 @@ template< class T > void Buffer< T >::swap( Buffer< T >& buffer )
     T*             tmpData    = buffer._data;
     const uint64_t tmpSize    = buffer._size;
     const uint64_t tmpMaxSize = buffer._maxSize;
+    const BufferPolicy tmpPolicy = buffer._policy;
 
     buffer._data = _data;
     buffer._size = _size;
     buffer._maxSize = _maxSize;
+    buffer._policy = _policy;
 
     _data     = tmpData;
     _size     = tmpSize;
     _maxSize = tmpMaxSize;
+    _policy = tmpPolicy;
 }
 
 template< class T > bool Buffer< T >::setSize( const uint64_t size )
@@ -130,4 +130,33 @@ template< class T > bool Buffer< T >::setSize( const uint64_t size )
     _size = size;
     return true;
 }
+
+template< class T > void Buffer< T >::setPolicy( const BufferPolicy policy )
+{
+    if( policy == _policy )
+        return;
+    if( !_data )
+    {
+        _policy = policy;
+        return;
+    }
+
+    const size_t nBytes = _maxSize * sizeof( T );
+    T* data = static_cast< T* >( detail::allocBuffer( nBytes, policy ));
+    memcpy( data, _data, _size * sizeof( T ));
+    detail::freeBuffer( _data, nBytes, _policy );
+    _data = data;
+    _policy = policy;
+}
+
+template< class T >
+void Buffer< T >::_realloc( const uint64_t nElems, const uint64_t nUsed )
+{
+    _data = static_cast< T* >( detail::reallocBuffer( _data,
+                                                      _maxSize * sizeof( T ),
+                                                      nElems * sizeof( T ),
+                                                      nUsed * sizeof( T ),
+                                                      _policy ));
+    _maxSize = _data ? nElems : 0;
+}
 }
@@ -0,0 +1,218 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "bufferPool.h"
+
+#include "bitOperation.h"
+#include "scopedMutex.h"
+#include "spinLock.h"
+
+#include <vector>
+
+#define NCLASSES 64
+
+namespace lunchbox
+{
+namespace
+{
+typedef std::vector< Bufferb* > Buffers;
+
+/** @return the size class, the index of the most significant bit */
+size_t _getClass( const uint64_t size )
+{
+    return size ? getIndexOfLastBit( size ) : 0;
+}
+
+void _delete( const Buffers& buffers )
+{
+    for( Buffers::const_iterator i = buffers.begin(); i != buffers.end(); ++i )
+        delete *i;
+}
+}
+
+namespace detail
+{
+class BufferPool
+{
+public:
+    explicit BufferPool( const BufferPolicy policy_ )
+        : policy( policy_ )
+        , lock( "lunchbox::BufferPool" )
+        , maxCached( 16 )
+        , nAllocations( 0 )
+        , nReuses( 0 )
+    {}
+
+    /** @return a cached buffer of the given class and size, or 0 */
+    Bufferb* find( const size_t index, const uint64_t size )
+    {
+        Buffers& buffers = classes[ index ];
+        // most recently released first, it is the most likely to be cached
+        for( Buffers::iterator i = buffers.end(); i != buffers.begin(); )
+        {
+            --i;
+            if( (*i)->getMaxSize() < size )
+                continue;
+            Bufferb* buffer = *i;
+            buffers.erase( i );
+            return buffer;
+        }
+        return 0;
+    }
+
+    const BufferPolicy policy;
+    mutable SpinLock lock;
+    Buffers classes[ NCLASSES ];
+    size_t maxCached;
+    size_t nAllocations;
+    size_t nReuses;
+};
+}
+
+BufferPool::BufferPool( const BufferPolicy policy )
+    : _impl( new detail::BufferPool( policy ))
+{}
+
+BufferPool::~BufferPool()
+{
+    flush();
+    delete _impl;
+}
+
+Bufferb* BufferPool::alloc( const uint64_t size )
+{
+    const size_t index = _getClass( size );
+    {
+        ScopedFastWrite mutex( _impl->lock );
+        // buffers in the next class are always large enough
+        Bufferb* buffer = _impl->find( index, size );
+        if( !buffer && index + 1 < NCLASSES )
+            buffer = _impl->find( index + 1, size );
+        if( buffer )
+        {
+            ++_impl->nReuses;
+            buffer->setSize( 0 );
+            return buffer;
+        }
+        ++_impl->nAllocations;
+    }
+
+    Bufferb* buffer = new Bufferb( _impl->policy );
+    buffer->reserve( size );
+    return buffer;
+}
+
+void BufferPool::release( Bufferb* buffer )
+{
+    if( !buffer )
+        return;
+
+    Bufferb* evicted = 0;
+    {
+        ScopedFastWrite mutex( _impl->lock );
+        Buffers& buffers = _impl->classes[ _getClass( buffer->getMaxSize( ))];
+        if( _impl->maxCached == 0 )
+            evicted = buffer;
+        else
+        {
+            if( buffers.size() >= _impl->maxCached )
+            {
+                evicted = buffers.front();
+                buffers.erase( buffers.begin( ));
+            }
+            buffers.push_back( buffer );
+        }
+    }
+    delete evicted;
+}
+
+void BufferPool::reserve( Bufferb*& buffer, const uint64_t size )
+{
+    if( buffer && buffer->getMaxSize() >= size )
+        return;
+    release( buffer );
+    buffer = alloc( size );
+}
+
+void BufferPool::flush()
+{
+    Buffers buffers;
+    {
+        ScopedFastWrite mutex( _impl->lock );
+        for( size_t i = 0; i < NCLASSES; ++i )
+        {
+            buffers.insert( buffers.end(), _impl->classes[i].begin(),
+                            _impl->classes[i].end( ));
+            _impl->classes[i].clear();
+        }
+    }
+    _delete( buffers );
+}
+
+void BufferPool::setMaxCached( const size_t nBuffers )
+{
+    Buffers excess;
+    {
+        ScopedFastWrite mutex( _impl->lock );
+        _impl->maxCached = nBuffers;
+        for( size_t i = 0; i < NCLASSES; ++i )
+        {
+            Buffers& buffers = _impl->classes[i];
+            if( buffers.size() <= nBuffers )
+                continue;
+            const Buffers::iterator end = buffers.end() - nBuffers;
+            excess.insert( excess.end(), buffers.begin(), end );
+            buffers.erase( buffers.begin(), end );
+        }
+    }
+    _delete( excess );
+}
+
+size_t BufferPool::getMaxCached() const
+{
+    ScopedFastRead mutex( _impl->lock );
+    return _impl->maxCached;
+}
+
+size_t BufferPool::getNCached() const
+{
+    ScopedFastRead mutex( _impl->lock );
+    size_t nBuffers = 0;
+    for( size_t i = 0; i < NCLASSES; ++i )
+        nBuffers += _impl->classes[i].size();
+    return nBuffers;
+}
+
+size_t BufferPool::getNAllocations() const
+{
+    ScopedFastRead mutex( _impl->lock );
+    return _impl->nAllocations;
+}
+
+size_t BufferPool::getNReuses() const
+{
+    ScopedFastRead mutex( _impl->lock );
+    return _impl->nReuses;
+}
+
+void BufferPool::resetStatistics()
+{
+    ScopedFastWrite mutex( _impl->lock );
+    _impl->nAllocations = 0;
+    _impl->nReuses = 0;
+}
+}
@@ -0,0 +1,103 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_BUFFERPOOL_H
+#define LUNCHBOX_BUFFERPOOL_H
+
+#include <lunchbox/api.h>
+#include <lunchbox/buffer.h> // BufferPolicy
+#include <boost/noncopyable.hpp>
+
+namespace lunchbox
+{
+namespace detail { class BufferPool; }
+
+/**
+ * A thread-safe pool of byte buffers, sorted into power-of-two size classes.
+ *
+ * alloc() returns a cached buffer with at least the requested capacity, or a
+ * new one if none is cached. Released buffers are kept in the class of their
+ * capacity, up to a maximum number per class beyond which the least recently
+ * released buffer is deleted. The allocation counters allow to verify that a
+ * steady-state workload does not allocate memory.
+ *
+ * Example: @include tests/bufferPool.cpp
+ */
+class BufferPool : public boost::noncopyable
+{
+public:
+    /**
+     * Construct a new, empty pool.
+     *
+     * @param policy the allocation policy of new buffers.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API explicit BufferPool( BufferPolicy policy = BUFFER_MALLOC );
+
+    /** Destruct the pool and all cached buffers. @version 1.9.2 */
+    LUNCHBOX_API ~BufferPool();
+
+    /**
+     * Get an empty buffer with at least the given capacity.
+     *
+     * @param size the minimum capacity in bytes.
+     * @return the buffer, to be given back using release().
+     * @version 1.9.2
+     */
+    LUNCHBOX_API Bufferb* alloc( uint64_t size );
+
+    /** Give a buffer back to the pool for reuse. @version 1.9.2 */
+    LUNCHBOX_API void release( Bufferb* buffer );
+
+    /**
+     * Make sure a buffer has at least the given capacity.
+     *
+     * A too small buffer is released and replaced by one from alloc(). The
+     * content of the buffer is not retained.
+     * @param buffer the buffer to check, may be 0.
+     * @param size the minimum capacity in bytes.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API void reserve( Bufferb*& buffer, uint64_t size );
+
+    /** Delete all cached buffers. @version 1.9.2 */
+    LUNCHBOX_API void flush();
+
+    /** Set the maximum number of buffers cached per class. @version 1.9.2 */
+    LUNCHBOX_API void setMaxCached( size_t nBuffers );
+
+    /** @return the maximum number of buffers per class. @version 1.9.2 */
+    LUNCHBOX_API size_t getMaxCached() const;
+
+    /** @return the number of cached buffers. @version 1.9.2 */
+    LUNCHBOX_API size_t getNCached() const;
+
+    /** @return the number of buffers allocated by alloc(). @version 1.9.2 */
+    LUNCHBOX_API size_t getNAllocations() const;
+
+    /** @return the number of buffers reused by alloc(). @version 1.9.2 */
+    LUNCHBOX_API size_t getNReuses() const;
+
+    /** Reset the allocation and reuse counters. @version 1.9.2 */
+    LUNCHBOX_API void resetStatistics();
+
+private:
+    detail::BufferPool* const _impl;
+};
+}
+
+#endif // LUNCHBOX_BUFFERPOOL_H
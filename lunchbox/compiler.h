@@ -30,6 +30,17 @@
 #    define final
 #    define override
 #  endif
+
+#  if !defined( BOOST_NO_CXX11_RVALUE_REFERENCES ) && \
+      !defined( BOOST_NO_CXX11_VARIADIC_TEMPLATES )
+/** Defined if rvalue references and variadic templates are supported. */
+#    define LB_MOVE_SEMANTICS
+#    include <utility>
+/** Move the given value if supported by the compiler, otherwise copy it. */
+#    define LB_MOVE( value ) std::move( value )
+#  else
+#    define LB_MOVE( value ) value
+#  endif
 #endif
 
 #ifdef _MSC_VER
@@ -48,6 +59,9 @@
 #  define LB_ALIGN16( var ) var __attribute__ ((aligned (16)));
 #endif
 
+/** The assumed size of a CPU cache line, used to avoid false sharing. */
+#define LB_CACHELINE_SIZE 64
+
 #ifdef __GNUC__
 #  define LB_UNUSED __attribute__((unused))
 #  ifdef WARN_DEPRECATED // Set CMake option ENABLE_WARN_DEPRECATED
@@ -20,6 +20,7 @@
 
 #include "compressor.h"
 
+#include "compressor/compressor.h"
 #include "compressorInfo.h"
 #include "compressorResult.h"
 #include "plugin.h"
@@ -252,4 +253,19 @@ CompressorResult Compressor::getResult() const
     return CompressorResult( impl_->info.name, chunks );
 }
 
+void Compressor::setPackResults( const bool pack )
+{
+    plugin::Compressor::setPackResults( pack );
+}
+
+bool Compressor::getPackResults()
+{
+    return plugin::Compressor::getPackResults();
+}
+
+BufferPool& Compressor::getResultPool()
+{
+    return plugin::Compressor::getResultPool();
+}
+
 }
@@ -155,6 +155,26 @@ public:
     LUNCHBOX_API void getResult( const unsigned i, void** const out,
                                  uint64_t* const outSize ) const LB_DEPRECATED;
 
+    /**
+     * Set if the built-in compressors shrink their results to size.
+     *
+     * Packing frees unused memory after each compression, while retaining the
+     * result buffers avoids reallocations in a steady-state compression loop.
+     * Results are packed by default, unless Lunchbox was built with
+     * LUNCHBOX_AGGRESSIVE_CACHING.
+     * @version 1.9.2
+     */
+    static LUNCHBOX_API void setPackResults( bool pack );
+
+    /** @return true if results are packed to size. @version 1.9.2 */
+    static LUNCHBOX_API bool getPackResults();
+
+    /**
+     * @return the pool of result buffers used by the built-in compressors.
+     * @version 1.9.2
+     */
+    static LUNCHBOX_API BufferPool& getResultPool();
+
 private:
     detail::Compressor* const impl_;
     LB_TS_VAR( _thread );
@@ -18,6 +18,9 @@
 
 #include "compressor.h"
 
+#include <lunchbox/atomic.h>
+#include <lunchbox/bufferPool.h>
+
 namespace lunchbox
 {
 namespace plugin
@@ -27,6 +30,15 @@ namespace
 typedef std::vector< Compressor::Functions > Compressors;
 static Compressors* _functions;
 
+// Not destroyed, since compressors may be deleted during static destruction
+static BufferPool* _resultPool = new BufferPool;
+// Changed and read by different threads, accessed using relaxed atomics
+#ifdef LUNCHBOX_AGGRESSIVE_CACHING
+static int32_t _packResults = 0;
+#else
+static int32_t _packResults = 1;
+#endif
+
 const Compressor::Functions& _findFunctions( const unsigned name )
 {
     BOOST_FOREACH( const Compressor::Functions& functions, *_functions )
@@ -44,8 +56,15 @@ Compressor::Compressor()
 
 Compressor::~Compressor()
 {
+    // packed results are too small to be reused, only cache retained ones
+    const bool pack = getPackResults();
     for ( size_t i = 0; i < _results.size(); i++ )
-        delete ( _results[i] );
+    {
+        if( pack )
+            delete _results[i];
+        else
+            _resultPool->release( _results[i] );
+    }
 
     _results.clear();
 }
@@ -71,6 +90,41 @@ void Compressor::registerEngine( const Compressor::Functions& functions )
     _functions->push_back( functions );
 }
 
+BufferPool& Compressor::getResultPool()
+{
+    return *_resultPool;
+}
+
+void Compressor::setPackResults( const bool pack )
+{
+    Atomic< int32_t >::store( _packResults, pack ? 1 : 0, ORDER_RELAXED );
+}
+
+bool Compressor::getPackResults()
+{
+    return Atomic< int32_t >::load( _packResults, ORDER_RELAXED ) != 0;
+}
+
+void Compressor::reserveResult( Result*& result, const eq_uint64_t size )
+{
+    if( !getPackResults( ))
+    {
+        _resultPool->reserve( result, size );
+        return;
+    }
+
+    // a packed result grows in place, the pool would only keep packed ones
+    if( !result )
+        result = new Result;
+    result->reserve( size );
+}
+
+void Compressor::packResult( Result* result )
+{
+    if( getPackResults( ))
+        result->pack();
+}
+
 void Compressor::compress( const void* const inData, const eq_uint64_t* inDims,
                            const eq_uint64_t flags )
 {
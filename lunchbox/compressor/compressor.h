@@ -173,6 +173,26 @@ public:
     /** Convenience function for instance-less decompressor allocation. */
     static Compressor* getNewDecompressor( const unsigned /*name*/ ){ return 0;}
 
+    /** @return the pool of retained result buffers of all compressors. */
+    static BufferPool& getResultPool();
+
+    /** Set if results are packed to their size after compression. */
+    static void setPackResults( bool pack );
+
+    /** @return true if results are packed after compression. */
+    static bool getPackResults();
+
+    /**
+     * Make sure a result can hold the given number of bytes.
+     *
+     * Retained results are exchanged through the result pool, packed results
+     * are grown in place.
+     */
+    static void reserveResult( Result*& result, eq_uint64_t size );
+
+    /** Pack a result to its size, if results are packed. */
+    static void packResult( Result* result );
+
 protected:
     ResultVector _results;  //!< The compressed data
     unsigned _nResults;     //!< Number of elements used in _results
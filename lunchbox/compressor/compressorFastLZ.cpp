@@ -56,9 +56,9 @@ void CompressorFastLZ::compress( const void* const inData,
 {
     _nResults = 1;
     if( _results.size() < _nResults )
-        _results.push_back( new lunchbox::plugin::Compressor::Result );
+        _results.push_back( 0 );
     const eq_uint64_t maxSize = eq_uint64_t( float( nPixels ) * 1.1f ) + 66;
-    _results[0]->reserve( maxSize );
+    reserveResult( _results[0], maxSize );
 
     const int size = fastlz_compress( inData, nPixels, _results[0]->getData( ));
     _results[0]->resize( size );
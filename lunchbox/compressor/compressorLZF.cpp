@@ -57,9 +57,9 @@ void CompressorLZF::compress( const void* const inData,
 {
     _nResults = 1;
     if( _results.size() < _nResults )
-        _results.push_back( new lunchbox::plugin::Compressor::Result );
+        _results.push_back( 0 );
     const eq_uint64_t maxSize = eq_uint64_t( float( nPixels ) * 1.1f ) + 8;
-    _results[0]->reserve( maxSize );
+    reserveResult( _results[0], maxSize );
 
     const unsigned size = lzf_compress( inData, nPixels,
                                         _results[0]->getData(), maxSize );
@@ -183,12 +183,10 @@ static inline void _compress( const void* const input, const uint64_t nPixels,
                          results[2]->getData( ));
     results[3]->setSize( reinterpret_cast< uint8_t* >( fourOut )  -
                          results[3]->getData( ));
-#ifndef LUNCHBOX_AGGRESSIVE_CACHING
-    results[0]->pack();
-    results[1]->pack();
-    results[2]->pack();
-    results[3]->pack();
-#endif
+    lunchbox::plugin::Compressor::packResult( results[0] );
+    lunchbox::plugin::Compressor::packResult( results[1] );
+    lunchbox::plugin::Compressor::packResult( results[2] );
+    lunchbox::plugin::Compressor::packResult( results[3] );
 }
 
 #define READ( name )                                        \
@@ -299,14 +297,15 @@ static unsigned _setupResults( const unsigned nChannels,
     const unsigned nChunks = nChannels;
 #endif
 
-    while( results.size() < nChunks )
-        results.push_back( new lunchbox::plugin::Compressor::Result );
+    if( results.size() < nChunks )
+        results.resize( nChunks, 0 );
 
     // The maximum possible size is twice the input size for each chunk, since
     // the worst case scenario is input made of tupels of 'rle marker, data'
     const eq_uint64_t maxChunkSize = (inSize/nChunks + 1) * 2;
     for( size_t i = 0; i < nChunks; ++i )
-        results[i]->reserve( maxChunkSize );
+        lunchbox::plugin::Compressor::reserveResult( results[i],
+                                                     maxChunkSize );
 
     LBVERB << "Compressing " << inSize << " bytes in " << nChunks << " chunks"
            << std::endl;
@@ -120,9 +120,7 @@ void CompressorRLE4BU::compress( const void* const inData,
         const uint64_t cSize = _compress( &data[ startIndex ],
                                           endIndex-startIndex, out );
         _results[i]->setSize( cSize );
-#ifndef LUNCHBOX_AGGRESSIVE_CACHING
-        _results[i]->pack();
-#endif
+        packResult( _results[i] );
     }
 }
 
@@ -59,9 +59,7 @@ inline void _compressChunk( const T* const in, const eq_uint64_t nPixels,
     WRITE_OUTPUT( token );
     result->setSize( (tokenOut - reinterpret_cast< T* >( result->getData( ))) *
                      sizeof( T ));
-#ifndef LUNCHBOX_AGGRESSIVE_CACHING
-    result->pack();
-#endif
+    Compressor::packResult( result );
 }
 
 template< typename T >
@@ -58,9 +58,9 @@ void CompressorSnappy::compress( const void* const inData,
 {
     _nResults = 1;
     if( _results.size() < _nResults )
-        _results.push_back( new lunchbox::plugin::Compressor::Result );
+        _results.push_back( 0 );
     size_t size = snappy::MaxCompressedLength( nPixels );
-    _results[0]->reserve( size );
+    reserveResult( _results[0], size );
 
     snappy::RawCompress( (const char*)(inData), nPixels,
                          (char*)( _results[0]->getData( )), &size );
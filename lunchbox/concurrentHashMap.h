@@ -0,0 +1,206 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_CONCURRENTHASHMAP_H
+#define LUNCHBOX_CONCURRENTHASHMAP_H
+
+#include <lunchbox/atomic.h>     // member
+#include <lunchbox/epoch.h>      // used inline
+#include <lunchbox/spinLock.h>   // member
+#include <lunchbox/uint128_t.h>  // used inline
+#include <boost/functional/hash.hpp>
+#include <cstring> // memset
+
+namespace lunchbox
+{
+/**
+ * The default hash function of ConcurrentHashMap.
+ *
+ * ConcurrentHashMap selects buckets and lock stripes using the low bits of the
+ * hash value. The specializations for integer, pointer and 128 bit keys mix all
+ * key bits into the low bits, so that sequential IDs and UUIDs are distributed
+ * evenly. Other keys use boost::hash.
+ */
+template< class K > struct ConcurrentHash
+{
+    size_t operator()( const K& key ) const { return boost::hash< K >()( key );}
+};
+
+/** @internal Mix all bits of a 64 bit value (MurmurHash3 finalizer). */
+inline size_t mixHash( uint64_t key )
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ull;
+    key ^= key >> 33;
+    return size_t( key );
+}
+
+/** Hash function for 32 bit IDs. @version 1.9.2 */
+template<> struct ConcurrentHash< uint32_t >
+{
+    size_t operator()( const uint32_t key ) const
+    {
+        const uint32_t hash = key * 0x9e3779b1u;
+        return hash ^ ( hash >> 16 );
+    }
+};
+
+/** Hash function for 64 bit IDs. @version 1.9.2 */
+template<> struct ConcurrentHash< uint64_t >
+{
+    size_t operator()( const uint64_t key ) const { return mixHash( key ); }
+};
+
+/** Hash function for 128 bit IDs and UUIDs. @version 1.9.2 */
+template<> struct ConcurrentHash< uint128_t >
+{
+    size_t operator()( const uint128_t& key ) const
+        { return mixHash( key.low() ^ ( key.high() * 0x9e3779b97f4a7c15ull ));}
+};
+
+/** Hash function for pointers. @version 1.9.2 */
+template< class T > struct ConcurrentHash< T* >
+{
+    size_t operator()( const T* key ) const
+        { return mixHash( uint64_t( reinterpret_cast< size_t >( key ))); }
+};
+
+/**
+ * A hash map with lock-free lookup for concurrent use.
+ *
+ * Lookups are lock-free and never block: they traverse immutable nodes inside
+ * a ScopedEpoch and copy the value out. Modifications lock one of 64 stripes,
+ * selected by the low bits of the hash, so that writers on different stripes
+ * proceed in parallel. Removed and replaced nodes are retired to the global
+ * Epoch.
+ *
+ * The table doubles when the number of elements exceeds the number of
+ * buckets. The resize is incremental: the new table is published immediately,
+ * and each stripe is migrated by the first writer locking it, or by writers
+ * helping with one additional stripe after each modification. Lookups on
+ * stripes not yet migrated read the old table.
+ *
+ * Current implementation constraints:
+ * * Values are copied on lookup and replaced as a whole, not modified in place
+ * * No iteration
+ * * The table does not shrink, except on clear()
+ * * Not copyable
+ *
+ * Example: @include tests/concurrentHashMap.cpp
+ */
+template< class K, class V, class H = ConcurrentHash< K > >
+class ConcurrentHashMap : public boost::noncopyable
+{
+public:
+    typedef K key_type;
+    typedef V mapped_type;
+
+    /**
+     * Construct a new hash map.
+     *
+     * @param nBuckets the initial number of buckets, rounded to the next power
+     *                 of two and at least the number of lock stripes.
+     * @version 1.9.2
+     */
+    explicit ConcurrentHashMap( size_t nBuckets = 0 );
+
+    /** Destruct this hash map. @version 1.9.2 */
+    ~ConcurrentHashMap();
+
+    /** @return true if the map is empty. @version 1.9.2 */
+    bool empty() const { return size() == 0; }
+
+    /** @return the number of elements in the map. @version 1.9.2 */
+    size_t size() const
+        { return size_t( Atomic< ssize_t >::loadAcquire( _size )); }
+
+    /** @return the current number of buckets. @version 1.9.2 */
+    size_t getNBuckets() const;
+
+    /**
+     * Look up an element, lock-free.
+     *
+     * @param key the key of the element.
+     * @param value receives a copy of the element's value if found.
+     * @return true if the element was found, false otherwise.
+     * @version 1.9.2
+     */
+    bool find( const K& key, V& value ) const;
+
+    /** @return true if the map contains the key, lock-free. @version 1.9.2 */
+    bool contains( const K& key ) const;
+
+    /**
+     * Insert a new element if the key is not yet used.
+     *
+     * @return true if the element was inserted, false if the key exists.
+     * @version 1.9.2
+     */
+    bool insert( const K& key, const V& value );
+
+    /**
+     * Insert a new element or replace the value of an existing element.
+     *
+     * Concurrent lookups either find the old or the new value.
+     * @return true if the element was inserted, false if it was replaced.
+     * @version 1.9.2
+     */
+    bool set( const K& key, const V& value );
+
+    /**
+     * Remove an element.
+     *
+     * @return true if the element was removed, false if it was not found.
+     * @version 1.9.2
+     */
+    bool erase( const K& key );
+
+    /** Remove all elements and reset the table size. @version 1.9.2 */
+    void clear();
+
+private:
+    struct Node;
+    struct Table;
+    enum { nStripes = 64 };
+
+    Table* _table;
+    const size_t _nBuckets; // initial size
+    char _pad0[ LB_CACHELINE_SIZE ];
+    ssize_t _size;
+    char _pad1[ LB_CACHELINE_SIZE ];
+    mutable SpinLock _stripes[ nStripes ];
+    SpinLock _resizing;
+    const H _hash;
+
+    const Node* _find( const K& key ) const;
+    bool _insert( const K& key, const V& value, bool replace );
+
+    Table* _lock( size_t stripe );
+    void _migrate( Table* table, size_t stripe );
+    void _grow( Table* table, size_t stripe );
+    void _help();
+
+    static size_t _getNBuckets( size_t nBuckets );
+    static void _deleteTable( void* table );
+};
+}
+
+#include "concurrentHashMap.ipp" // template implementation
+
+#endif // LUNCHBOX_CONCURRENTHASHMAP_H
@@ -0,0 +1,325 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+namespace lunchbox
+{
+/** An immutable element, published to readers using a release store. */
+template< class K, class V, class H >
+struct ConcurrentHashMap< K, V, H >::Node
+{
+    Node( const size_t hash_, const K& key_, const V& value_, Node* next_ )
+        : hash( hash_ ), key( key_ ), value( value_ ), next( next_ ) {}
+
+    const size_t hash;
+    const K key;
+    const V value;
+    Node* next;
+};
+
+/**
+ * A bucket array. During a resize, the stripes not yet migrated are read from
+ * the old table.
+ */
+template< class K, class V, class H >
+struct ConcurrentHashMap< K, V, H >::Table
+{
+    Table( const size_t size, Table* old_ )
+        : mask( size - 1 )
+        , buckets( new Node*[ size ]( ))
+        , old( old_ )
+        , pending( old_ ? nStripes : 0 )
+        , nextStripe( 0 )
+    {
+        LBASSERT(( size & mask ) == 0 );
+        LBASSERT( size >= nStripes );
+        ::memset( migrated, old_ ? 0 : 1, nStripes );
+    }
+
+    ~Table()
+    {
+        for( size_t i = 0; i <= mask; ++i )
+        {
+            Node* node = buckets[ i ];
+            while( node )
+            {
+                Node* next = node->next;
+                delete node;
+                node = next;
+            }
+        }
+        delete [] buckets;
+    }
+
+    Node*& getBucket( const size_t hash ) { return buckets[ hash & mask ]; }
+    const Node* getHead( const size_t hash ) const
+        { return Atomic< Node* >::loadAcquire( buckets[ hash & mask ] ); }
+
+    bool isMigrated( const size_t stripe ) const
+        { return Atomic< char >::loadAcquire( migrated[ stripe ] ) != 0; }
+
+    bool isMigrating() const
+        { return Atomic< int32_t >::loadAcquire( pending ) > 0; }
+
+    const size_t mask;
+    Node** const buckets;
+    Table* const old; // not used after all stripes are migrated
+    int32_t pending; // number of stripes to migrate from old
+    int32_t nextStripe; // next stripe to help migrating
+    char migrated[ nStripes ];
+};
+
+template< class K, class V, class H >
+ConcurrentHashMap< K, V, H >::ConcurrentHashMap( const size_t nBuckets )
+    : _table( 0 )
+    , _nBuckets( _getNBuckets( nBuckets ))
+    , _size( 0 )
+    , _resizing( "lunchbox::ConcurrentHashMap" )
+    , _hash()
+{
+    _table = new Table( _nBuckets, 0 );
+    memoryBarrier();
+}
+
+template< class K, class V, class H >
+ConcurrentHashMap< K, V, H >::~ConcurrentHashMap()
+{
+    if( _table->isMigrating( ))
+        delete _table->old;
+    delete _table;
+}
+
+template< class K, class V, class H >
+size_t ConcurrentHashMap< K, V, H >::getNBuckets() const
+{
+    ScopedEpoch critical;
+    return Atomic< Table* >::loadAcquire( _table )->mask + 1;
+}
+
+template< class K, class V, class H >
+bool ConcurrentHashMap< K, V, H >::find( const K& key, V& value ) const
+{
+    ScopedEpoch critical;
+    const Node* node = _find( key );
+    if( !node )
+        return false;
+    value = node->value;
+    return true;
+}
+
+template< class K, class V, class H >
+bool ConcurrentHashMap< K, V, H >::contains( const K& key ) const
+{
+    ScopedEpoch critical;
+    return _find( key ) != 0;
+}
+
+template< class K, class V, class H >
+bool ConcurrentHashMap< K, V, H >::insert( const K& key, const V& value )
+{
+    return _insert( key, value, false );
+}
+
+template< class K, class V, class H >
+bool ConcurrentHashMap< K, V, H >::set( const K& key, const V& value )
+{
+    return _insert( key, value, true );
+}
+
+template< class K, class V, class H >
+bool ConcurrentHashMap< K, V, H >::erase( const K& key )
+{
+    ScopedEpoch critical;
+    const size_t hash = _hash( key );
+    const size_t stripe = hash & ( nStripes - 1 );
+    Table* table = _lock( stripe );
+
+    Node** link = &table->getBucket( hash );
+    for( Node* node = *link; node; link = &node->next, node = *link )
+    {
+        if( node->hash != hash || !( node->key == key ))
+            continue;
+
+        Atomic< Node* >::storeRelease( *link, node->next );
+        Atomic< ssize_t >::decAndGet( _size );
+        _stripes[ stripe ].unset();
+        Epoch::getGlobal().retire( node );
+        _help();
+        return true;
+    }
+    _stripes[ stripe ].unset();
+    return false;
+}
+
+template< class K, class V, class H >
+void ConcurrentHashMap< K, V, H >::clear()
+{
+    for( size_t i = 0; i < nStripes; ++i )
+        _stripes[ i ].set();
+
+    Table* table = _table;
+    Atomic< Table* >::storeRelease( _table, new Table( _nBuckets, 0 ));
+    Atomic< ssize_t >::storeRelease( _size, 0 );
+
+    for( size_t i = 0; i < nStripes; ++i )
+        _stripes[ i ].unset();
+
+    if( table->isMigrating( ))
+        Epoch::getGlobal().retire( table->old, &_deleteTable );
+    Epoch::getGlobal().retire( table, &_deleteTable );
+}
+
+template< class K, class V, class H > const typename
+ConcurrentHashMap< K, V, H >::Node* ConcurrentHashMap< K, V, H >::_find(
+    const K& key ) const
+{
+    const size_t hash = _hash( key );
+    const Table* table = Atomic< Table* >::loadAcquire( _table );
+    if( !table->isMigrated( hash & ( nStripes - 1 )))
+        table = table->old;
+
+    for( const Node* node = table->getHead( hash ); node;
+         node = Atomic< Node* >::loadAcquire( node->next ))
+    {
+        if( node->hash == hash && node->key == key )
+            return node;
+    }
+    return 0;
+}
+
+template< class K, class V, class H >
+bool ConcurrentHashMap< K, V, H >::_insert( const K& key, const V& value,
+                                            const bool replace )
+{
+    ScopedEpoch critical;
+    const size_t hash = _hash( key );
+    const size_t stripe = hash & ( nStripes - 1 );
+    Table* table = _lock( stripe );
+
+    Node*& bucket = table->getBucket( hash );
+    for( Node** link = &bucket; *link; link = &(*link)->next )
+    {
+        Node* node = *link;
+        if( node->hash != hash || !( node->key == key ))
+            continue;
+
+        if( replace )
+        {
+            Node* replacement = new Node( hash, key, value, node->next );
+            Atomic< Node* >::storeRelease( *link, replacement );
+        }
+        _stripes[ stripe ].unset();
+        if( replace )
+            Epoch::getGlobal().retire( node );
+        return false;
+    }
+
+    Node* node = new Node( hash, key, value, bucket );
+    Atomic< Node* >::storeRelease( bucket, node );
+    if( Atomic< ssize_t >::incAndGet( _size ) > ssize_t( table->mask + 1 ) &&
+        !table->isMigrating( ))
+        _grow( table, stripe );
+    _stripes[ stripe ].unset();
+    _help();
+    return true;
+}
+
+template< class K, class V, class H > typename
+ConcurrentHashMap< K, V, H >::Table* ConcurrentHashMap< K, V, H >::_lock(
+    const size_t stripe )
+{
+    _stripes[ stripe ].set();
+    Table* table = Atomic< Table* >::loadAcquire( _table );
+    if( !table->isMigrated( stripe ))
+        _migrate( table, stripe );
+    return table;
+}
+
+template< class K, class V, class H >
+void ConcurrentHashMap< K, V, H >::_migrate( Table* table, const size_t stripe )
+{
+    // Copy the nodes, concurrent readers may still traverse the old table.
+    // The new buckets of this stripe are not read until the stripe is flagged.
+    const Table* old = table->old;
+    for( size_t i = stripe; i <= old->mask; i += nStripes )
+    {
+        for( const Node* node = old->buckets[ i ]; node; node = node->next )
+        {
+            Node*& bucket = table->getBucket( node->hash );
+            bucket = new Node( node->hash, node->key, node->value, bucket );
+        }
+    }
+
+    Atomic< char >::storeRelease( table->migrated[ stripe ], 1 );
+    if( Atomic< int32_t >::decAndGet( table->pending ) == 0 )
+        Epoch::getGlobal().retire( table->old, &_deleteTable );
+}
+
+template< class K, class V, class H >
+void ConcurrentHashMap< K, V, H >::_grow( Table* table, const size_t stripe )
+{
+    // Called with the stripe locked, which excludes clear()
+    if( !_resizing.trySet( ))
+        return;
+
+    if( Atomic< Table* >::loadAcquire( _table ) == table &&
+        !table->isMigrating( ))
+    {
+        Table* grown = new Table(( table->mask + 1 ) << 1, table );
+        Atomic< Table* >::storeRelease( _table, grown );
+        _migrate( grown, stripe );
+    }
+    _resizing.unset();
+}
+
+template< class K, class V, class H >
+void ConcurrentHashMap< K, V, H >::_help()
+{
+    // Migrate one more stripe, so that resizes finish without writes to all
+    // stripes. Does not wait for stripes locked by other writers.
+    Table* table = Atomic< Table* >::loadAcquire( _table );
+    if( !table->isMigrating( ))
+        return;
+
+    const int32_t next = Atomic< int32_t >::getAndAdd( table->nextStripe, 1 );
+    const size_t stripe = size_t( next ) & ( nStripes - 1 );
+    if( table->isMigrated( stripe ) || !_stripes[ stripe ].trySet( ))
+        return;
+
+    // recheck under lock, the table may have been cleared
+    if( Atomic< Table* >::loadAcquire( _table ) == table &&
+        !table->isMigrated( stripe ))
+    {
+        _migrate( table, stripe );
+    }
+    _stripes[ stripe ].unset();
+}
+
+template< class K, class V, class H >
+size_t ConcurrentHashMap< K, V, H >::_getNBuckets( const size_t nBuckets )
+{
+    size_t size = nStripes;
+    while( size < nBuckets )
+        size <<= 1;
+    return size;
+}
+
+template< class K, class V, class H >
+void ConcurrentHashMap< K, V, H >::_deleteTable( void* table )
+{
+    delete static_cast< Table* >( table );
+}
+}
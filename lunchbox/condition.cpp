@@ -17,6 +17,7 @@
 
 #include "condition.h"
 #include "debug.h"
+#include "lockProfile.h"
 #include "time.h"
 
 #include <cstring>
@@ -36,51 +37,78 @@ namespace detail
 class Condition
 {
 public:
+    explicit Condition( const char* name )
+        : profile( lunchbox::LockProfile::create( name ))
+    {
+        // mutex init
+        int error = pthread_mutex_init( &mutex, 0 );
+        if( error )
+        {
+            LBERROR << "Error creating pthread mutex: " << strerror( error )
+                    << std::endl;
+            return;
+        }
+
+        // condvar init
+        error = pthread_cond_init( &cond, 0 );
+        if( error )
+        {
+            LBERROR << "Error creating pthread condition: "
+                    << strerror( error ) << std::endl;
+            return;
+        }
+    }
+
+    ~Condition()
+    {
+        int error = pthread_mutex_destroy( &mutex );
+        if( error )
+            LBERROR << "Error destroying pthread mutex: " << strerror( error )
+                    << std::endl;
+
+        error = pthread_cond_destroy( &cond );
+        if( error )
+            LBERROR << "Error destroying pthread condition: "
+                    << strerror( error ) << std::endl;
+
+        delete profile;
+    }
+
     pthread_mutex_t mutex;
     pthread_cond_t  cond;
+    lunchbox::LockProfile* const profile;
 };
 }
 
 Condition::Condition()
-        : _impl( new detail::Condition )
-{
-    // mutex init
-    int error = pthread_mutex_init( &_impl->mutex, 0 );
-    if( error )
-    {
-        LBERROR << "Error creating pthread mutex: " << strerror( error )
-                << std::endl;
-        return;
-    }
+        : _impl( new detail::Condition( 0 ))
+{}
 
-    // condvar init
-    error = pthread_cond_init( &_impl->cond, 0 );
-    if( error )
-    {
-        LBERROR << "Error creating pthread condition: " << strerror( error )
-                << std::endl;
-        return;
-    }
-}
+Condition::Condition( const char* name )
+        : _impl( new detail::Condition( name ))
+{}
 
 Condition::~Condition()
 {
-    int error = pthread_mutex_destroy( &_impl->mutex );
-    if( error )
-        LBERROR << "Error destroying pthread mutex: " << strerror( error )
-                << std::endl;
-
-    error = pthread_cond_destroy( &_impl->cond );
-    if( error )
-        LBERROR << "Error destroying pthread condition: " << strerror( error )
-                << std::endl;
-
     delete _impl;
 }
 
 void Condition::lock()
 {
+    if( !_impl->profile )
+    {
+        pthread_mutex_lock( &_impl->mutex );
+        return;
+    }
+
+    if( pthread_mutex_trylock( &_impl->mutex ) == 0 )
+    {
+        _impl->profile->acquired( true );
+        return;
+    }
+    const uint64_t start = LockProfile::getTime();
     pthread_mutex_lock( &_impl->mutex );
+    _impl->profile->acquired( true, start );
 }
 
 void Condition::signal()
@@ -95,12 +123,19 @@ void Condition::broadcast()
 
 void Condition::unlock()
 {
+    if( _impl->profile )
+        _impl->profile->released();
     pthread_mutex_unlock( &_impl->mutex );
 }
 
 void Condition::wait()
 {
+    // the mutex is released while waiting, which does not count as contention
+    if( _impl->profile )
+        _impl->profile->released();
     pthread_cond_wait( &_impl->cond, &_impl->mutex );
+    if( _impl->profile )
+        _impl->profile->acquired( true );
 }
 
 bool Condition::timedWait( const uint32_t timeout )
@@ -113,6 +148,8 @@ bool Condition::timedWait( const uint32_t timeout )
 
     const uint32_t time = timeout == LB_TIMEOUT_DEFAULT ?
         300000 /* 5 min */ : timeout;
+    if( _impl->profile )
+        _impl->profile->released();
 
 #ifdef _WIN32
     int error = pthread_cond_timedwait_w32_np( &_impl->cond, &_impl->mutex,
@@ -133,6 +170,8 @@ bool Condition::timedWait( const uint32_t timeout )
 
     int error = pthread_cond_timedwait( &_impl->cond, &_impl->mutex, &then );
 #endif
+    if( _impl->profile )
+        _impl->profile->acquired( true );
     if( error == ETIMEDOUT )
         return false;
 
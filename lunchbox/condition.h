@@ -36,6 +36,15 @@ public:
     /** Construct a new condition variable. @version 1.0 */
     LUNCHBOX_API Condition();
 
+    /**
+     * Construct a new named condition variable.
+     *
+     * @param name the name used for lock profiling.
+     * @sa LockProfile
+     * @version 1.9.2
+     */
+    LUNCHBOX_API explicit Condition( const char* name );
+
     /** Destruct this condition variable. @version 1.0 */
     LUNCHBOX_API ~Condition();
 
@@ -67,6 +67,11 @@ int pthread_mutex_lock( pthread_mutex_t* mutex )
     return 0;
 }
 
+int pthread_mutex_trylock( pthread_mutex_t* mutex )
+{
+    return TryEnterCriticalSection( mutex ) ? 0 : EBUSY;
+}
+
 int pthread_mutex_unlock( pthread_mutex_t* mutex )
 {
     LeaveCriticalSection( mutex );
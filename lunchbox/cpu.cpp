@@ -0,0 +1,85 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "detail/cpu.h"
+
+#include "atomic.h"
+#include "perThread.h"
+
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <unistd.h>
+#endif
+
+namespace lunchbox
+{
+namespace
+{
+size_t _computeNCores()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo( &info );
+    const long nCores = info.dwNumberOfProcessors;
+#else
+    const long nCores = sysconf( _SC_NPROCESSORS_ONLN );
+#endif
+    return nCores > 0 ? size_t( nCores ) : 1;
+}
+
+/** The slot index of a thread, valid for all users. */
+struct ThreadIndex
+{
+    size_t index;
+};
+
+int32_t _nThreadIndices = 0;
+lunchbox::PerThread< ThreadIndex > _threadIndex;
+}
+
+namespace detail
+{
+size_t getNCores()
+{
+    static const size_t nCores = _computeNCores();
+    return nCores;
+}
+
+size_t getNSlots( const size_t maxSlots )
+{
+    const size_t nCores = getNCores();
+    size_t nSlots = 1;
+    while( nSlots < nCores && nSlots < maxSlots )
+        nSlots <<= 1;
+    return nSlots;
+}
+
+size_t getThreadIndex()
+{
+    ThreadIndex* id = _threadIndex.get();
+    if( LB_UNLIKELY( !id ))
+    {
+        id = new ThreadIndex;
+        id->index = size_t( Atomic< int32_t >::getAndAdd( _nThreadIndices, 1,
+                                                          ORDER_RELAXED ));
+        _threadIndex = id;
+    }
+    return id->index;
+}
+}
+}
@@ -71,7 +71,7 @@ static void backtrace_( std::ostream& os, const size_t skipFrames )
 {
 #ifdef _WIN32
     // Sym* functions from DbgHelp are not thread-safe...
-    static Lock lock;
+    static Lock lock( "lunchbox::backtrace" );
     ScopedMutex<> mutex( lock );
 
     typedef USHORT (WINAPI *CaptureStackBackTraceType)( ULONG, ULONG,
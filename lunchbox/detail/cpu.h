@@ -0,0 +1,43 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_DETAIL_CPU_H
+#define LUNCHBOX_DETAIL_CPU_H
+
+#include <lunchbox/types.h>
+
+namespace lunchbox
+{
+namespace detail
+{
+/** @return the number of online cores, at least one. */
+size_t getNCores();
+
+/**
+ * @return the number of cores rounded up to a power of two, at most the given
+ *         power of two. Used to size per-core slot arrays.
+ */
+size_t getNSlots( const size_t maxSlots );
+
+/**
+ * @return a small index of the calling thread, unique during its lifetime.
+ *         Used to pick a per-core slot, masked by the number of slots.
+ */
+size_t getThreadIndex();
+}
+}
+#endif // LUNCHBOX_DETAIL_CPU_H
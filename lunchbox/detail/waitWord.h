@@ -0,0 +1,85 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_DETAIL_WAITWORD_H
+#define LUNCHBOX_DETAIL_WAITWORD_H
+
+#include <lunchbox/atomic.h>
+#include <lunchbox/futex.h>
+#include <lunchbox/thread.h>
+#include <lunchbox/waitPolicy.h>
+#include "cpu.h"
+
+// Spin rounds of the default wait policy on multi-core machines
+#define LB_WAITWORD_SPINS 1000
+
+namespace lunchbox
+{
+namespace detail
+{
+/** @return a policy spinning before blocking on multi-core machines. */
+inline WaitPolicy getDefaultWaitPolicy()
+{
+    // The signaling thread can't run while we spin on its only core
+    return WaitPolicy( getNCores() > 1 ? LB_WAITWORD_SPINS : 0 );
+}
+
+/**
+ * Wait while the word has the given value, spinning, yielding and blocking
+ * according to the policy. Blocked threads are counted in nWaiting, the
+ * changing thread has to call wakeWord() after updating the word.
+ */
+inline void waitWord( int32_t& word, const int32_t value, int32_t& nWaiting,
+                      const WaitPolicy& policy, WaitStats& stats )
+{
+    for( uint32_t i = 0; i < policy.nSpins; ++i )
+    {
+        if( Atomic< int32_t >::load( word, ORDER_ACQUIRE ) != value )
+        {
+            Atomic< ssize_t >::getAndAdd( stats.spun, 1, ORDER_RELAXED );
+            return;
+        }
+        spinPause();
+    }
+    for( uint32_t i = 0; i < policy.nYields; ++i )
+    {
+        if( Atomic< int32_t >::load( word, ORDER_ACQUIRE ) != value )
+        {
+            Atomic< ssize_t >::getAndAdd( stats.yielded, 1, ORDER_RELAXED );
+            return;
+        }
+        lunchbox::Thread::yield();
+    }
+
+    // Pairs with wakeWord(): either the waker sees the registration, or the
+    // recheck sees the new value.
+    Atomic< int32_t >::getAndAdd( nWaiting, 1, ORDER_SEQ_CST );
+    while( Atomic< int32_t >::load( word, ORDER_SEQ_CST ) == value )
+        futexWait( &word, value );
+    Atomic< int32_t >::getAndSub( nWaiting, 1, ORDER_RELAXED );
+    Atomic< ssize_t >::getAndAdd( stats.blocked, 1, ORDER_RELAXED );
+}
+
+/** Wake the threads blocked in waitWord() after a seq_cst word update. */
+inline void wakeWord( int32_t& word, const int32_t& nWaiting )
+{
+    if( Atomic< int32_t >::load( nWaiting, ORDER_SEQ_CST ) > 0 )
+        futexWakeAll( &word );
+}
+}
+}
+#endif // LUNCHBOX_DETAIL_WAITWORD_H
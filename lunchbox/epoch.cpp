@@ -0,0 +1,281 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "epoch.h"
+
+#include "atomic.h"
+#include "debug.h"
+#include "perThread.h"
+#include "scopedMutex.h"
+#include "spinLock.h"
+#include "thread.h"
+
+#include <deque>
+#include <vector>
+
+// Number of retire() calls between attempts to advance the epoch
+#define LB_EPOCH_COLLECT_INTERVAL 32
+
+namespace lunchbox
+{
+namespace detail
+{
+struct Retired
+{
+    void* object;
+    lunchbox::Epoch::Deleter deleter;
+    ssize_t epoch;
+};
+typedef std::deque< Retired > RetiredList;
+typedef std::vector< Retired > Retireds;
+
+/** The per-thread state of one Epoch, reused after thread exit. */
+struct EpochRecord
+{
+    EpochRecord()
+        : state( 0 ), nesting( 0 ), used( 1 ), next( 0 )
+        , lock( "lunchbox::Epoch" ), nRetires( 0 ) {}
+
+    ~EpochRecord()
+    {
+        for( RetiredList::const_iterator i = retired.begin();
+             i != retired.end(); ++i )
+        {
+            i->deleter( i->object );
+        }
+    }
+
+    /**
+     * Move the memory reclaimable in the given epoch to freed.
+     * @return the number of objects still waiting for reclamation.
+     */
+    size_t collect( const ssize_t epoch, Retireds& freed )
+    {
+        // Threads inside may have seen epoch - 1, memory retired in epoch e
+        // is unreachable once the epoch is e + 2.
+        ScopedFastWrite mutex( lock );
+        while( !retired.empty() && retired.front().epoch + 2 <= epoch )
+        {
+            freed.push_back( retired.front( ));
+            retired.pop_front();
+        }
+        return retired.size();
+    }
+
+    ssize_t state; // (epoch << 1) | 1 inside a critical region, 0 outside
+    size_t nesting; // written only by the owner thread
+    int32_t used;
+    EpochRecord* next;
+
+    // Retired memory of the owner thread. The lock is only contended by
+    // reclaim() calls from other threads.
+    SpinLock lock;
+    RetiredList retired; // ordered by epoch, protected by lock
+    size_t nRetires; // written only by the owner thread
+    char pad[ LB_CACHELINE_SIZE ]; // records are written by different threads
+};
+
+void freeRetired( const Retireds& freed )
+{
+    for( Retireds::const_iterator i = freed.begin(); i != freed.end(); ++i )
+        i->deleter( i->object );
+}
+
+void releaseEpochRecord( EpochRecord* record )
+{
+    record->nesting = 0;
+    Atomic< ssize_t >::storeRelease( record->state, 0 );
+    Atomic< int32_t >::storeRelease( record->used, 0 );
+}
+
+class Epoch
+{
+public:
+    Epoch() : global( 0 ), records( 0 ) {}
+
+    ~Epoch()
+    {
+        current = 0; // TLS destructor would release the deleted record
+        while( records )
+        {
+            EpochRecord* record = records;
+            LBASSERTINFO( record->nesting == 0,
+                          "Destroying Epoch used by a thread" );
+            records = record->next;
+            delete record;
+        }
+    }
+
+    EpochRecord* getRecord()
+    {
+        EpochRecord* record = current.get();
+        if( record )
+            return record;
+
+        // reuse the record of an exited thread
+        for( record = Atomic< EpochRecord* >::loadAcquire( records ); record;
+             record = record->next )
+        {
+            if( Atomic< int32_t >::loadAcquire( record->used ) == 0 &&
+                Atomic< int32_t >::compareAndSwap( &record->used, 0, 1 ))
+                break;
+        }
+
+        if( !record )
+        {
+            record = new EpochRecord;
+            void** head = reinterpret_cast< void** >( &records );
+            do
+                record->next = Atomic< EpochRecord* >::loadAcquire( records );
+            while( !Atomic< void* >::compareAndSwap( head, record->next,
+                                                     record ));
+        }
+
+        current = record;
+        return record;
+    }
+
+    /** Advance the epoch if all threads inside have seen the current one. */
+    bool tryAdvance()
+    {
+        memoryBarrier(); // load states after the unlink, pairs with enter()
+        const ssize_t epoch = Atomic< ssize_t >::loadAcquire( global );
+        for( const EpochRecord* record =
+                 Atomic< EpochRecord* >::loadAcquire( records );
+             record; record = record->next )
+        {
+            const ssize_t state = Atomic< ssize_t >::loadAcquire(
+                record->state );
+            if(( state & 1 ) && ( state >> 1 ) != epoch )
+                return false;
+        }
+        return Atomic< ssize_t >::compareAndSwap( &global, epoch, epoch + 1 );
+    }
+
+    /**
+     * Free the reclaimable memory of the given record and of the records of
+     * exited threads, or of all records if record is 0.
+     * @return the number of objects still waiting for reclamation.
+     */
+    size_t reclaim( EpochRecord* const record )
+    {
+        tryAdvance();
+
+        const ssize_t epoch = Atomic< ssize_t >::loadAcquire( global );
+        Retireds freed;
+        size_t nRetired = 0;
+        for( EpochRecord* i = Atomic< EpochRecord* >::loadAcquire( records );
+             i; i = i->next )
+        {
+            if( !record || i == record ||
+                Atomic< int32_t >::loadAcquire( i->used ) == 0 )
+            {
+                nRetired += i->collect( epoch, freed );
+            }
+        }
+        freeRetired( freed );
+        return nRetired;
+    }
+
+    char pad0[ LB_CACHELINE_SIZE ];
+    ssize_t global;
+    char pad1[ LB_CACHELINE_SIZE ];
+
+    EpochRecord* records; // lock-free list, only grows
+    lunchbox::PerThread< EpochRecord, releaseEpochRecord > current;
+};
+}
+
+Epoch::Epoch()
+    : _impl( new detail::Epoch )
+{}
+
+Epoch::~Epoch()
+{
+    delete _impl;
+}
+
+Epoch& Epoch::getGlobal()
+{
+    static Epoch global;
+    return global;
+}
+
+void Epoch::enter()
+{
+    detail::EpochRecord* record = _impl->getRecord();
+    if( record->nesting++ > 0 )
+        return;
+
+    const ssize_t epoch = Atomic< ssize_t >::loadAcquire( _impl->global );
+    Atomic< ssize_t >::storeRelease( record->state, ( epoch << 1 ) | 1 );
+    memoryBarrier(); // state before shared reads, pairs with tryAdvance()
+}
+
+void Epoch::leave()
+{
+    detail::EpochRecord* record = _impl->current.get();
+    LBASSERT( record && record->nesting > 0 );
+    if( --record->nesting == 0 )
+        Atomic< ssize_t >::storeRelease( record->state, 0 );
+}
+
+bool Epoch::isInside() const
+{
+    const detail::EpochRecord* record = _impl->current.get();
+    return record && record->nesting > 0;
+}
+
+void Epoch::retire( void* object, const Deleter deleter )
+{
+    LBASSERT( deleter );
+    detail::EpochRecord* record = _impl->getRecord();
+    const detail::Retired retired = {
+        object, deleter, Atomic< ssize_t >::loadAcquire( _impl->global ) };
+    {
+        ScopedFastWrite mutex( record->lock );
+        record->retired.push_back( retired );
+    }
+    if(( ++record->nRetires % LB_EPOCH_COLLECT_INTERVAL ) == 0 )
+        _impl->reclaim( record );
+}
+
+size_t Epoch::reclaim()
+{
+    return _impl->reclaim( 0 );
+}
+
+void Epoch::synchronize()
+{
+    LBASSERTINFO( !isInside(), "Epoch::synchronize() would deadlock" );
+    while( _impl->reclaim( 0 ) > 0 )
+        Thread::yield();
+}
+
+size_t Epoch::getNRetired() const
+{
+    size_t nRetired = 0;
+    for( detail::EpochRecord* record =
+             Atomic< detail::EpochRecord* >::loadAcquire( _impl->records );
+         record; record = record->next )
+    {
+        ScopedFastRead mutex( record->lock );
+        nRetired += record->retired.size();
+    }
+    return nRetired;
+}
+}
@@ -0,0 +1,152 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_EPOCH_H
+#define LUNCHBOX_EPOCH_H
+
+#include <lunchbox/api.h>
+#include <lunchbox/types.h>
+#include <boost/noncopyable.hpp>
+
+namespace lunchbox
+{
+namespace detail { class Epoch; }
+
+/**
+ * Epoch-based memory reclamation for lock-free data structures.
+ *
+ * Readers of a lock-free data structure enter a critical region before
+ * accessing shared memory and leave it afterwards, preferably using a
+ * ScopedEpoch. Writers unlink memory from the data structure and retire() it
+ * instead of deleting it directly. Retired memory is freed once every thread
+ * which was inside a critical region during the unlink has left it.
+ *
+ * Entering and leaving a critical region only writes to a thread-local record
+ * and is lock-free. Critical regions may be nested. Retiring appends to a list
+ * of the calling thread. Every 32nd retire() of a thread tries to advance the
+ * global epoch, which scans the records of all registered threads, and frees
+ * the reclaimable memory of this thread and of exited threads. reclaim() and
+ * synchronize() free the memory retired by all threads.
+ *
+ * Readers should not block for a long time inside a critical region, since
+ * this delays the reclamation of all memory retired to the same instance.
+ *
+ * Example: @include tests/epoch.cpp
+ */
+class Epoch : public boost::noncopyable
+{
+public:
+    /** The function used to free retired memory. @version 1.9.2 */
+    typedef void (*Deleter)( void* );
+
+    /** Construct a new reclamation domain. @version 1.9.2 */
+    LUNCHBOX_API Epoch();
+
+    /**
+     * Destruct the domain and free all retired memory.
+     *
+     * No thread may be inside a critical region of this domain.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API ~Epoch();
+
+    /** @return the process-wide default domain. @version 1.9.2 */
+    LUNCHBOX_API static Epoch& getGlobal();
+
+    /** Enter a critical region in the calling thread. @version 1.9.2 */
+    LUNCHBOX_API void enter();
+
+    /** Leave a critical region in the calling thread. @version 1.9.2 */
+    LUNCHBOX_API void leave();
+
+    /**
+     * @return true if the calling thread is inside a critical region.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API bool isInside() const;
+
+    /**
+     * Retire memory which is no longer reachable by new readers.
+     *
+     * The deleter is called with the given pointer once no reader can hold a
+     * reference to it anymore, from an arbitrary thread calling retire(),
+     * reclaim(), synchronize() or the destructor. Use reclaim() to release
+     * large allocations early.
+     *
+     * @param object the unlinked memory.
+     * @param deleter the function freeing the memory.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API void retire( void* object, Deleter deleter );
+
+    /** Retire an object allocated using new. @version 1.9.2 */
+    template< class T > void retire( T* object )
+        { retire( object, &_delete< T > ); }
+
+    /** Retire an array allocated using new []. @version 1.9.2 */
+    template< class T > void retireArray( T* array )
+        { retire( array, &_deleteArray< T > ); }
+
+    /**
+     * Try to advance the epoch and free all reclaimable memory.
+     *
+     * @return the number of objects still waiting for reclamation.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API size_t reclaim();
+
+    /**
+     * Wait until all memory retired so far is freed.
+     *
+     * Must not be called from inside a critical region.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API void synchronize();
+
+    /** @return the number of retired, not yet freed objects. @version 1.9.2 */
+    LUNCHBOX_API size_t getNRetired() const;
+
+private:
+    detail::Epoch* const _impl;
+
+    template< class T > static void _delete( void* object )
+        { delete static_cast< T* >( object ); }
+    template< class T > static void _deleteArray( void* array )
+        { delete [] static_cast< T* >( array ); }
+};
+
+/**
+ * A scoped critical region of an Epoch.
+ *
+ * Example: @include tests/epoch.cpp
+ */
+class ScopedEpoch : public boost::noncopyable
+{
+public:
+    /** Enter a critical region of the given domain. @version 1.9.2 */
+    explicit ScopedEpoch( Epoch& epoch = Epoch::getGlobal( ))
+        : _epoch( epoch ) { _epoch.enter(); }
+
+    /** Leave the critical region. @version 1.9.2 */
+    ~ScopedEpoch() { _epoch.leave(); }
+
+private:
+    Epoch& _epoch;
+};
+}
+
+#endif // LUNCHBOX_EPOCH_H
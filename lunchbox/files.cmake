@@ -13,39 +13,57 @@ set(LUNCHBOX_PUBLIC_HEADERS
   algorithm.h
   any.h
   anySerialization.h
+  arena.h
   array.h
   atomic.h
+  barrier.h
+  biasedReferenced.h
   bitOperation.h
   buffer.h
   buffer.ipp
+  bufferPool.h
   clock.h
   compiler.h
   compressor.h
   compressorResult.h
+  concurrentHashMap.h
+  concurrentHashMap.ipp
   condition.h
   daemon.h
   debug.h
   decompressor.h
   downloader.h
   dso.h
+  epoch.h
   file.h
+  futex.h
   future.h
   futureFunction.h
   hash.h
   indexIterator.h
   init.h
+  latch.h
   launcher.h
   lfQueue.h
   lfQueue.ipp
   lfVector.h
   lfVector.ipp
   lfVectorIterator.h
+  lfmtQueue.h
+  lfmtQueue.ipp
+  localReferenced.h
   lock.h
+  lockProfile.h
   lockable.h
   log.h
+  magazinePool.h
+  magazinePool.ipp
+  mcsLock.h
   memoryMap.h
   monitor.h
   mpi.h
+  mpmcQueue.h
+  mpmcQueue.ipp
   mtQueue.h
   mtQueue.ipp
   nonCopyable.h
@@ -64,15 +82,21 @@ set(LUNCHBOX_PUBLIC_HEADERS
   request.h
   requestHandler.h
   result.h
+  ringBuffer.h
   rng.h
+  rwLock.h
   scopedMutex.h
+  seqLock.h
   serializable.h
   servus.h
+  shardedCounter.h
   sleep.h
   spinLock.h
   stdExt.h
   thread.h
   threadID.h
+  threadPool.h
+  ticketLock.h
   timedLock.h
   tls.h
   types.h
@@ -82,6 +106,9 @@ set(LUNCHBOX_PUBLIC_HEADERS
   uploader.h
   uri.h
   visitorResult.h
+  waitPolicy.h
+  workStealingDeque.h
+  workStealingDeque.ipp
   )
 
 set(LUNCHBOX_COMPRESSORS
@@ -127,7 +154,9 @@ endif()
 set(LUNCHBOX_HEADERS
   avahi/servus.h
   compressorInfo.h
+  detail/cpu.h
   detail/threadID.h
+  detail/waitWord.h
   dnssd/servus.h
   leveldb/persistentMap.h
   none/servus.h
@@ -140,20 +169,32 @@ set(LUNCHBOX_SOURCES
   ${LUNCHBOX_COMPRESSORS}
   ${COMMON_SOURCES}
   any.cpp
+  arena.cpp
   atomic.cpp
+  barrier.cpp
+  biasedReferenced.cpp
+  buffer.cpp
+  bufferPool.cpp
   clock.cpp
   compressor.cpp
   condition.cpp
   condition_w32.ipp
+  cpu.cpp
   debug.cpp
   decompressor.cpp
   downloader.cpp
   dso.cpp
+  epoch.cpp
   file.cpp
+  futex.cpp
   init.cpp
+  latch.cpp
   launcher.cpp
+  localReferenced.cpp
   lock.cpp
+  lockProfile.cpp
   log.cpp
+  mcsLock.cpp
   md5/md5.cc
   memoryMap.cpp
   mpi.cpp
@@ -165,11 +206,14 @@ set(LUNCHBOX_SOURCES
   referenced.cpp
   requestHandler.cpp
   rng.cpp
+  rwLock.cpp
   servus.cpp
+  shardedCounter.cpp
   sleep.cpp
   spinLock.cpp
   thread.cpp
   threadID.cpp
+  threadPool.cpp
   timedLock.cpp
   tls.cpp
   uint128_t.cpp
@@ -0,0 +1,101 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "futex.h"
+
+#include "atomic.h"
+
+#ifdef __linux__
+#  include "time.h"
+#  include <climits>
+#  include <errno.h>
+#  include <linux/futex.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#else
+#  include "condition.h"
+#  include "scopedMutex.h"
+#endif
+
+namespace lunchbox
+{
+namespace
+{
+#ifdef __linux__
+long _futex( int32_t* word, const int op, const int32_t value,
+             const timespec* timeout )
+{
+    return ::syscall( SYS_futex, word, op, value, timeout, 0, 0 );
+}
+#else
+// Emulation: a waiter checks the word while holding the condition of its
+// bucket, and a waker broadcasts while holding it.
+#  define LB_FUTEX_BUCKETS 64
+
+Condition* _getBucket( const int32_t* word )
+{
+    static Condition buckets[ LB_FUTEX_BUCKETS ];
+    const size_t hash = reinterpret_cast< size_t >( word ) >> 2;
+    return &buckets[ ( hash ^ ( hash >> 6 )) % LB_FUTEX_BUCKETS ];
+}
+#endif
+}
+
+bool futexWait( int32_t* word, const int32_t expected, const uint32_t timeout )
+{
+#ifdef __linux__
+    if( timeout == LB_TIMEOUT_INDEFINITE )
+    {
+        _futex( word, FUTEX_WAIT_PRIVATE, expected, 0 );
+        return true;
+    }
+
+    const timespec delta = convertToTimespec( timeout == LB_TIMEOUT_DEFAULT ?
+                                              300000 /* 5 min */ : timeout );
+    if( _futex( word, FUTEX_WAIT_PRIVATE, expected, &delta ) == 0 )
+        return true;
+    return errno != ETIMEDOUT;
+#else
+    Condition& condition = *_getBucket( word );
+    ScopedCondition mutex( condition );
+    if( Atomic< int32_t >::loadAcquire( *word ) != expected )
+        return true;
+    return condition.timedWait( timeout );
+#endif
+}
+
+void futexWakeOne( int32_t* word )
+{
+#ifdef __linux__
+    _futex( word, FUTEX_WAKE_PRIVATE, 1, 0 );
+#else
+    // waiters of other words may share the bucket, can't wake only one
+    futexWakeAll( word );
+#endif
+}
+
+void futexWakeAll( int32_t* word )
+{
+#ifdef __linux__
+    _futex( word, FUTEX_WAKE_PRIVATE, INT_MAX, 0 );
+#else
+    Condition& condition = *_getBucket( word );
+    ScopedCondition mutex( condition );
+    condition.broadcast();
+#endif
+}
+}
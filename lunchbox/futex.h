@@ -0,0 +1,66 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_FUTEX_H
+#define LUNCHBOX_FUTEX_H
+
+#include <lunchbox/api.h>
+#include <lunchbox/types.h>
+
+namespace lunchbox
+{
+/**
+ * @name Blocking on a memory word
+ *
+ * Low-level primitives to implement blocking synchronization objects with a
+ * lock-free fast path. The state of the object is kept in a 32 bit word,
+ * modified using atomic operations. A thread which has to wait blocks on the
+ * word, and the thread changing it wakes the blocked threads. Uses futexes on
+ * Linux, and a hashed table of condition variables elsewhere.
+ *
+ * Wakeups may be spurious, the caller has to recheck its condition.
+ */
+//@{
+/**
+ * Block the calling thread while the word has the expected value.
+ *
+ * Returns immediately if the word does not have the expected value. The check
+ * and the blocking are atomic with respect to futexWake().
+ *
+ * @param word the address of the word.
+ * @param expected the value of the word to block on.
+ * @param timeout the timeout in milliseconds, or LB_TIMEOUT_INDEFINITE.
+ * @return false on timeout, true otherwise.
+ * @version 1.9.2
+ */
+LUNCHBOX_API bool futexWait( int32_t* word, int32_t expected,
+                             uint32_t timeout = LB_TIMEOUT_INDEFINITE );
+
+/**
+ * Wake one thread blocked on the given word.
+ * @version 1.9.2
+ */
+LUNCHBOX_API void futexWakeOne( int32_t* word );
+
+/**
+ * Wake all threads blocked on the given word.
+ * @version 1.9.2
+ */
+LUNCHBOX_API void futexWakeAll( int32_t* word );
+//@}
+}
+#endif // LUNCHBOX_FUTEX_H
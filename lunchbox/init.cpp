@@ -20,6 +20,7 @@
 #include "init.h"
 
 #include "atomic.h"
+#include "lockProfile.h"
 #include "rng.h"
 #include "thread.h"
 
@@ -85,6 +86,15 @@ bool exit()
         return true;
     LBASSERT( _initialized == 0 );
 
+    if( LockProfile::isEnabled( ))
+    {
+        const LockStatsVector stats = LockProfile::getStats();
+        LBINFO << "Lock profile, " << stats.size() << " named locks"
+               << std::endl;
+        for( size_t i = 0; i < stats.size(); ++i )
+            LBINFO << "  " << stats[i] << std::endl;
+    }
+
     Log::reset();
     return true;
 }
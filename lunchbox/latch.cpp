@@ -0,0 +1,83 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "latch.h"
+
+#include "debug.h"
+#include "detail/waitWord.h"
+
+namespace lunchbox
+{
+Latch::Latch( const uint32_t count )
+    : _count( int32_t( count ))
+    , _open( count == 0 )
+    , _nWaiting( 0 )
+    , _policy( detail::getDefaultWaitPolicy( ))
+{
+    memoryBarrier();
+}
+
+Latch::Latch( const uint32_t count, const WaitPolicy& policy )
+    : _count( int32_t( count ))
+    , _open( count == 0 )
+    , _nWaiting( 0 )
+    , _policy( policy )
+{
+    memoryBarrier();
+}
+
+Latch::~Latch()
+{
+    LBASSERTINFO( _nWaiting == 0, "Latch destroyed with blocked threads" );
+}
+
+void Latch::countDown( const uint32_t n )
+{
+    const int32_t count = Atomic< int32_t >::getAndSub( _count, int32_t( n ),
+                                                        ORDER_ACQ_REL );
+    LBASSERTINFO( count >= int32_t( n ), "Latch counted down below zero" );
+    if( count != int32_t( n ))
+        return;
+
+    Atomic< int32_t >::store( _open, 1, ORDER_SEQ_CST );
+    detail::wakeWord( _open, _nWaiting );
+}
+
+void Latch::countDownAndWait()
+{
+    countDown();
+    wait();
+}
+
+void Latch::wait() const
+{
+    if( !isOpen( ))
+        detail::waitWord( _open, 0, _nWaiting, _policy, _stats );
+}
+
+bool Latch::isOpen() const
+{
+    return Atomic< int32_t >::load( _open, ORDER_ACQUIRE ) != 0;
+}
+
+uint32_t Latch::getCount() const
+{
+    const int32_t count = Atomic< int32_t >::load( _count, ORDER_RELAXED );
+    return count > 0 ? uint32_t( count ) : 0;
+}
+
+}
@@ -0,0 +1,100 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_LATCH_H
+#define LUNCHBOX_LATCH_H
+
+#include <lunchbox/api.h>
+#include <lunchbox/types.h>
+#include <lunchbox/waitPolicy.h> // member
+#include <boost/noncopyable.hpp>
+
+namespace lunchbox
+{
+/**
+ * A single-use countdown latch.
+ *
+ * The latch is constructed with a count, which threads decrement using
+ * countDown(). Threads calling wait() block until the count reaches zero. Once
+ * open, the latch stays open. Counting down does not take a lock and only makes
+ * a system call for the final count if threads are blocked.
+ *
+ * Example: @include tests/barrier.cpp
+ * @sa Barrier
+ */
+class Latch : public boost::noncopyable
+{
+public:
+    /**
+     * Construct a new latch with the default wait policy.
+     *
+     * The default policy spins briefly before blocking on multi-core machines,
+     * and blocks immediately otherwise.
+     *
+     * @param count the number of countDown() calls to open the latch.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API explicit Latch( uint32_t count );
+
+    /**
+     * Construct a new latch.
+     *
+     * @param count the number of countDown() calls to open the latch.
+     * @param policy how threads wait for the latch to open.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API Latch( uint32_t count, const WaitPolicy& policy );
+
+    /** Destruct the latch. @version 1.9.2 */
+    LUNCHBOX_API ~Latch();
+
+    /** Decrement the count, opening the latch at zero. @version 1.9.2 */
+    LUNCHBOX_API void countDown( uint32_t n = 1 );
+
+    /** Decrement the count and wait for the latch to open. @version 1.9.2 */
+    LUNCHBOX_API void countDownAndWait();
+
+    /** Wait for the latch to open. @version 1.9.2 */
+    LUNCHBOX_API void wait() const;
+
+    /** @return true if the latch is open. @version 1.9.2 */
+    LUNCHBOX_API bool isOpen() const;
+
+    /** @return the remaining count. @version 1.9.2 */
+    LUNCHBOX_API uint32_t getCount() const;
+
+    /** @name Wait policy and statistics. */
+    //@{
+    /** Set how threads wait, not thread-safe. @version 1.9.2 */
+    void setWaitPolicy( const WaitPolicy& policy ) { _policy = policy; }
+
+    /** @return the policy used by waiting threads. @version 1.9.2 */
+    const WaitPolicy& getWaitPolicy() const { return _policy; }
+
+    /** @return the phases in which waits were satisfied. @version 1.9.2 */
+    WaitStats getWaitStats() const { return _stats.snapshot(); }
+    //@}
+
+private:
+    int32_t _count;
+    mutable int32_t _open; // set once the count reaches zero, waited on
+    mutable int32_t _nWaiting; // number of blocked threads
+    WaitPolicy _policy;
+    mutable WaitStats _stats;
+};
+}
+#endif // LUNCHBOX_LATCH_H
@@ -18,14 +18,17 @@
 #ifndef LUNCHBOX_LFQUEUE_H
 #define LUNCHBOX_LFQUEUE_H
 
-#include <lunchbox/atomic.h> // member
-#include <lunchbox/debug.h>  // used in inline method
-#include <lunchbox/thread.h> // thread-safety checks
+#include <lunchbox/atomic.h>       // member
+#include <lunchbox/bitOperation.h> // used inline
+#include <lunchbox/debug.h>        // used in inline method
+#include <lunchbox/thread.h>       // thread-safety checks
 
 #include <vector>
 
 namespace lunchbox
 {
+namespace detail { template< bool padded > class LFQueuePositions; }
+
 /**
  * A thread-safe, lock-free queue with non-blocking access.
  *
@@ -37,20 +40,29 @@ namespace lunchbox
  * * Fixed maximum size (writes may fail)
  * * Not copyable
  *
+ * The padded layout places the read and write positions on separate cache
+ * lines, keeps a cached copy of the opposite position per thread and uses
+ * acquire/release ordering instead of full memory barriers. Its capacity is
+ * rounded up to a power of two minus one, which replaces the wrap-around test
+ * by a mask. It is faster when the reader and writer run on different cores,
+ * at the expense of two additional cache lines per queue.
+ *
+ * Popped elements are moved out of the queue if supported by the compiler.
+ *
  * Example: @include tests/lfQueue.cpp
  */
-template< typename T > class LFQueue : public boost::noncopyable
+template< typename T, bool padded = false >
+class LFQueue : public boost::noncopyable
 {
 public:
     /** Construct a new queue. @version 1.0 */
-    explicit LFQueue( const int32_t size )
-        : _data( size + 1 ), _readPos( 0 ), _writePos( 0 ) {}
+    explicit LFQueue( const int32_t size ) : _data( _getRingSize( size )) {}
 
     /** Destruct this queue. @version 1.0 */
     ~LFQueue() {}
 
     /** @return true if the queue is empty, false otherwise. @version 1.0 */
-    bool isEmpty() const { return _readPos == _writePos; }
+    bool isEmpty() const { return _pos.loadRead() == _pos.loadWrite(); }
 
     /** Reset (empty) the queue. @version 1.0 */
     void clear();
@@ -92,6 +104,78 @@ public:
      */
     bool push( const T& element );
 
+#ifdef LB_MOVE_SEMANTICS
+    /**
+     * Move a new element to the back of the queue.
+     *
+     * The element is left untouched if the queue is full.
+     * @param element the element to add.
+     * @return true if the element was placed, false if the queue is full
+     * @version 1.9.2
+     */
+    bool push( T&& element );
+
+    /**
+     * Construct a new element at the back of the queue.
+     *
+     * The element is constructed only if the queue is not full.
+     * @param args the arguments passed to the constructor of the element.
+     * @return true if the element was placed, false if the queue is full
+     * @version 1.9.2
+     */
+    template< class... Args > bool emplace( Args&&... args );
+#endif
+
+    /**
+     * Push a range of elements to the back of the queue.
+     *
+     * The write position is published once for all elements, i.e., the reader
+     * sees either none or all of the pushed elements.
+     *
+     * @param elements the first element to add.
+     * @param n the number of elements to add.
+     * @return the number of elements placed, which is smaller than n if the
+     *         queue is full.
+     * @version 1.9.2
+     */
+    size_t push( const T* elements, const size_t n );
+
+    /**
+     * Retrieve and pop up to the given number of front elements.
+     *
+     * The read position is published once for all elements.
+     *
+     * @param result the output array, receiving at most max elements.
+     * @param max the maximum number of elements to retrieve.
+     * @return the number of elements placed in result.
+     * @version 1.9.2
+     */
+    size_t pop( T* result, const size_t max );
+
+    /**
+     * Reserve contiguous storage for in-place writes by the writer thread.
+     *
+     * The returned slots may be written directly and are made available to the
+     * reader using commitWrite(). Since the queue is a ring buffer, fewer
+     * contiguous slots than free slots may be available at the end of the
+     * storage.
+     *
+     * @param n the number of contiguous slots to reserve.
+     * @return a pointer to n writable elements, or 0 if n contiguous slots are
+     *         not available.
+     * @version 1.9.2
+     */
+    T* reserveWrite( const size_t n );
+
+    /**
+     * Publish elements written in place after reserveWrite().
+     *
+     * @param n the number of elements to publish, at most the number of slots
+     *          returned by the last reserveWrite().
+     * @version 1.9.2
+     */
+    void commitWrite( const size_t n );
+
     /**
      * @return the maximum number of elements held by the queue.
      * @version 1.0
@@ -100,8 +184,12 @@ public:
 
 private:
     std::vector< T > _data;
-    a_int32_t _readPos;
-    a_int32_t _writePos;
+    detail::LFQueuePositions< padded > _pos;
+
+    static size_t _getRingSize( const int32_t size );
+    int32_t _wrap( const int32_t pos ) const;
+    int32_t _getFree( const size_t wanted );
+    int32_t _getUsed( const size_t wanted );
 
     LB_TS_VAR( _reader );
     LB_TS_VAR( _writer );
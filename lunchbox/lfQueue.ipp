@@ -1,5 +1,5 @@
 
-/* Copyright (c) 2010-2013, Stefan Eilemann <eile@equalizergraphics.com>
+/* Copyright (c) 2010-2014, Stefan Eilemann <eile@equalizergraphics.com>
  *
  * This library is free software; you can redistribute it and/or modify it under
  * the terms of the GNU Lesser General Public License version 2.1 as published
@@ -17,51 +17,258 @@
 
 namespace lunchbox
 {
-template< typename T > void LFQueue< T >::clear()
+namespace detail
+{
+/** Neighbouring read and write positions with full memory barriers. */
+template<> class LFQueuePositions< false >
+{
+public:
+    LFQueuePositions() : _read( 0 ), _write( 0 ) {}
+
+    int32_t loadRead() const { return _read; }
+    int32_t loadWrite() const { return _write; }
+
+    // reader side
+    int32_t getRead() const { return _read; }
+    int32_t getWriteCache() const { return _write; }
+    int32_t updateWriteCache() const { return _write; }
+    void setRead( const int32_t pos ) { _read = pos; }
+
+    // writer side
+    int32_t getWrite() const { return _write; }
+    int32_t getReadCache() const { return _read; }
+    int32_t updateReadCache() const { return _read; }
+    void setWrite( const int32_t pos ) { _write = pos; }
+
+    void reset() { _read = 0; _write = 0; }
+
+private:
+    a_int32_t _read;
+    a_int32_t _write;
+};
+
+/**
+ * Read and write positions on separate cache lines, each with a cached copy of
+ * the opposite position, using acquire/release ordering.
+ */
+template<> class LFQueuePositions< true >
+{
+public:
+    LFQueuePositions() { reset(); }
+
+    int32_t loadRead() const { return Atomic< int32_t >::loadAcquire( _read ); }
+    int32_t loadWrite() const
+        { return Atomic< int32_t >::loadAcquire( _write ); }
+
+    // reader side
+    int32_t getRead() const { return _read; }
+    int32_t getWriteCache() const { return _writeCache; }
+    int32_t updateWriteCache()
+        { _writeCache = loadWrite(); return _writeCache; }
+    void setRead( const int32_t pos )
+        { Atomic< int32_t >::storeRelease( _read, pos ); }
+
+    // writer side
+    int32_t getWrite() const { return _write; }
+    int32_t getReadCache() const { return _readCache; }
+    int32_t updateReadCache() { _readCache = loadRead(); return _readCache; }
+    void setWrite( const int32_t pos )
+        { Atomic< int32_t >::storeRelease( _write, pos ); }
+
+    void reset()
+    {
+        _read = _writeCache = 0;
+        _write = _readCache = 0;
+        memoryBarrier();
+    }
+
+private:
+    char _pad0[ LB_CACHELINE_SIZE ];
+    int32_t _read;
+    int32_t _writeCache;
+    char _pad1[ LB_CACHELINE_SIZE ];
+    int32_t _write;
+    int32_t _readCache;
+    char _pad2[ LB_CACHELINE_SIZE ];
+};
+}
+
+template< typename T, bool padded >
+size_t LFQueue< T, padded >::_getRingSize( const int32_t size )
+{
+    const uint32_t ringSize = uint32_t( size ) + 1;
+    if( !padded || ( ringSize & ( ringSize - 1 )) == 0 )
+        return ringSize;
+    return size_t( 1 ) << ( getIndexOfLastBit( ringSize ) + 1 );
+}
+
+template< typename T, bool padded >
+int32_t LFQueue< T, padded >::_wrap( const int32_t pos ) const
+{
+    const int32_t size = int32_t( _data.size( ));
+    if( padded )
+        return pos & ( size - 1 );
+    return pos >= size ? pos - size : pos;
+}
+
+template< typename T, bool padded >
+int32_t LFQueue< T, padded >::_getFree( const size_t wanted )
+{
+    const int32_t size = int32_t( _data.size( )) - 1;
+    const int32_t writePos = _pos.getWrite();
+    const int32_t free = _wrap( _pos.getReadCache() - writePos + size );
+    if( size_t( free ) >= wanted )
+        return free;
+    return _wrap( _pos.updateReadCache() - writePos + size );
+}
+
+template< typename T, bool padded >
+int32_t LFQueue< T, padded >::_getUsed( const size_t wanted )
+{
+    const int32_t size = int32_t( _data.size( ));
+    const int32_t readPos = _pos.getRead();
+    const int32_t used = _wrap( _pos.getWriteCache() - readPos + size );
+    if( size_t( used ) >= wanted )
+        return used;
+    return _wrap( _pos.updateWriteCache() - readPos + size );
+}
+
+template< typename T, bool padded > void LFQueue< T, padded >::clear()
 {
     LB_TS_SCOPED( _reader );
-    _readPos = 0;
-    _writePos = 0;
+    _pos.reset();
 }
 
-template< typename T > void LFQueue< T >::resize( const int32_t size )
+template< typename T, bool padded >
+void LFQueue< T, padded >::resize( const int32_t size )
 {
     LBASSERT( isEmpty( ));
-    _readPos = 0;
-    _writePos = 0;
-    _data.resize( size + 1 );
+    _pos.reset();
+    _data.resize( _getRingSize( size ));
 }
 
-template< typename T > bool LFQueue< T >::pop( T& result )
+template< typename T, bool padded >
+bool LFQueue< T, padded >::pop( T& result )
 {
     LB_TS_SCOPED( _reader );
-    if( _readPos == _writePos )
+    if( _getUsed( 1 ) == 0 )
         return false;
 
-    result = _data[ _readPos ];
-    _readPos = (_readPos + 1) % _data.size();
+    const int32_t readPos = _pos.getRead();
+    result = LB_MOVE( _data[ readPos ] );
+    _pos.setRead( _wrap( readPos + 1 ));
     return true;
 }
 
-template< typename T > bool LFQueue< T >::getFront( T& result )
+template< typename T, bool padded >
+bool LFQueue< T, padded >::getFront( T& result )
 {
     LB_TS_SCOPED( _reader );
-    if( _readPos == _writePos )
+    if( _getUsed( 1 ) == 0 )
+        return false;
+
+    result = _data[ _pos.getRead() ];
+    return true;
+}
+
+template< typename T, bool padded >
+bool LFQueue< T, padded >::push( const T& element )
+{
+    LB_TS_SCOPED( _writer );
+    if( _getFree( 1 ) == 0 )
+        return false;
+
+    const int32_t writePos = _pos.getWrite();
+    _data[ writePos ] = element;
+    _pos.setWrite( _wrap( writePos + 1 ));
+    return true;
+}
+
+#ifdef LB_MOVE_SEMANTICS
+template< typename T, bool padded >
+bool LFQueue< T, padded >::push( T&& element )
+{
+    LB_TS_SCOPED( _writer );
+    if( _getFree( 1 ) == 0 )
         return false;
 
-    result = _data[ _readPos ];
+    const int32_t writePos = _pos.getWrite();
+    _data[ writePos ] = std::move( element );
+    _pos.setWrite( _wrap( writePos + 1 ));
     return true;
 }
 
-template< typename T > bool LFQueue< T >::push( const T& element )
+template< typename T, bool padded > template< class... Args >
+bool LFQueue< T, padded >::emplace( Args&&... args )
 {
     LB_TS_SCOPED( _writer );
-    int32_t nextPos = (_writePos + 1) % _data.size();
-    if( nextPos == _readPos )
+    if( _getFree( 1 ) == 0 )
         return false;
 
-    _data[ _writePos ] = element;
-    _writePos = nextPos;
+    const int32_t writePos = _pos.getWrite();
+    _data[ writePos ] = T( std::forward< Args >( args )... );
+    _pos.setWrite( _wrap( writePos + 1 ));
     return true;
 }
+#endif
+
+template< typename T, bool padded >
+size_t LFQueue< T, padded >::push( const T* elements, const size_t n )
+{
+    LB_TS_SCOPED( _writer );
+    const int32_t size = int32_t( _data.size( ));
+    const size_t free = _getFree( n );
+    const size_t num = LB_MIN( n, free );
+    int32_t writePos = _pos.getWrite();
+
+    for( size_t i = 0; i < num; ++i )
+    {
+        _data[ writePos ] = elements[ i ];
+        if( ++writePos == size )
+            writePos = 0;
+    }
+    _pos.setWrite( writePos );
+    return num;
+}
+
+template< typename T, bool padded >
+size_t LFQueue< T, padded >::pop( T* result, const size_t max )
+{
+    LB_TS_SCOPED( _reader );
+    const int32_t size = int32_t( _data.size( ));
+    const size_t used = _getUsed( max );
+    const size_t num = LB_MIN( max, used );
+    int32_t readPos = _pos.getRead();
+
+    for( size_t i = 0; i < num; ++i )
+    {
+        result[ i ] = LB_MOVE( _data[ readPos ] );
+        if( ++readPos == size )
+            readPos = 0;
+    }
+    _pos.setRead( readPos );
+    return num;
+}
+
+template< typename T, bool padded >
+T* LFQueue< T, padded >::reserveWrite( const size_t n )
+{
+    LB_TS_SCOPED( _writer );
+    const int32_t writePos = _pos.getWrite();
+    const int32_t free = _getFree( n );
+    const int32_t contiguous = LB_MIN( free,
+                                       int32_t( _data.size( )) - writePos );
+
+    if( n == 0 || n > size_t( contiguous ))
+        return 0;
+    return &_data[ writePos ];
+}
+
+template< typename T, bool padded >
+void LFQueue< T, padded >::commitWrite( const size_t n )
+{
+    LB_TS_SCOPED( _writer );
+    LBASSERT( n <= getCapacity( ));
+    _pos.setWrite( _wrap( _pos.getWrite() + int32_t( n )));
+}
 }
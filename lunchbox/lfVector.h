@@ -23,10 +23,12 @@
 
 #include <lunchbox/bitOperation.h> // used inline
 #include <lunchbox/debug.h> // used inline
+#include <lunchbox/epoch.h> // used inline
 #include <lunchbox/os.h> // bzero()
 #include <lunchbox/scopedMutex.h> // member
 #include <lunchbox/serializable.h>
 #include <lunchbox/spinLock.h> // member
+#include <lunchbox/thread.h> // used inline
 #include <algorithm> // used inline
 #include <stdexcept>
 
@@ -35,10 +37,20 @@ namespace lunchbox
 /**
  * STL-like vector implementation providing certain thread-safety guarantees.
  *
- * All operations not modifying the vector size are lock-free and wait-free. All
- * operations modifying the vector size are serialized using a spin lock. The
- * interaction of operations is documented in the corresponding modify
- * operation.
+ * All operations not modifying the vector size are lock-free and wait-free.
+ * Appending elements using push_back() and emplace_back() is lock-free: writers
+ * claim an index using an atomic increment, allocate missing slots with a
+ * compare-and-swap and publish each element with a ready flag. The size is
+ * advanced over all contiguous published elements. All other operations
+ * modifying the vector size are serialized using a spin lock, and wait for
+ * in-flight appends to finish. The interaction of operations is documented in
+ * the corresponding modify operation.
+ *
+ * Storage released by shrinking operations is retired to the global Epoch
+ * instead of being freed directly. References and pointers to elements obtained
+ * within a ScopedEpoch stay valid until the critical region is left, even if
+ * the elements are removed concurrently. The values of concurrently removed
+ * elements are undefined.
  *
  * Undocumented methods behave like the STL implementation. The number of slots
  * (default 32) sets the maximum elements the vector may hold to
@@ -135,7 +147,11 @@ public:
      * Completely thread-save with read operations. Existing end() iterators
      * will keep pointing to the old end of the vector. The size is updated
      * after the element is inserted, so size() followed by a read is
-     * thread-safe.
+     * thread-safe. Lock-free with other push_back() and emplace_back()
+     * operations, unless lock is false. Concurrent appends are not ordered, and
+     * the size is updated once all previously claimed elements are inserted.
+     * If copying the item throws, a default-constructed element is appended
+     * before the exception is rethrown.
      *
      * @param item the element to insert.
      * @param lock true for internal lock, false if locked with getWriteLock()
@@ -144,6 +160,31 @@ public:
      */
     void push_back( const T& item, bool lock = true );
 
+#ifdef LB_MOVE_SEMANTICS
+    /**
+     * Move an element to the end of the vector.
+     *
+     * @param item the element to move into the vector.
+     * @param lock true for internal lock, false if locked with getWriteLock()
+     * @throw std::runtime_error if the vector is full
+     * @sa push_back( const T&, bool )
+     * @version 1.9.2
+     */
+    void push_back( T&& item, bool lock = true );
+
+    /**
+     * Construct an element at the end of the vector, lock-free.
+     *
+     * The vector is not modified if the constructor throws.
+     *
+     * @param args the arguments passed to the constructor of the element.
+     * @throw std::runtime_error if the vector is full
+     * @sa push_back( const T&, bool )
+     * @version 1.9.2
+     */
+    template< class... Args > void emplace_back( Args&&... args );
+#endif
+
     /**
      * Remove the last element (STL version).
      *
@@ -201,9 +242,9 @@ public:
     /**
      * Resize the vector.
      *
-     * Thread-safe with other write operations. Shrinking is not thread-safe
-     * with concurrent reads on the removed elements and produces undefined
-     * results.
+     * Thread-safe with other write operations. Concurrent reads on the removed
+     * elements produce undefined values, and are memory-safe within a
+     * ScopedEpoch.
      *
      * @throw std::runtime_error if the vector is full
      * @version 1.7.2
@@ -213,8 +254,10 @@ public:
     /**
      * Clear the vector and all storage.
      *
-     * Thread-safe with other write operations. By nature not thread-safe with
-     * read operations.
+     * Thread-safe with other write operations. Concurrent reads on the removed
+     * elements produce undefined values, and are memory-safe within a
+     * ScopedEpoch. The storage is freed once all readers have left their
+     * critical region.
      *
      * @version 1.3.2
      */
@@ -227,13 +270,26 @@ private:
     LB_SERIALIZABLE
 
     T* slots_[ nSlots ];
+    char* ready_[ nSlots ]; // per-element publish flags for lock-free append
     size_t size_;
+    a_ssize_t reserved_; // number of elements claimed by appends
+    a_int32_t appenders_; // number of lock-free appends in flight
     mutable SpinLock lock_;
 
     template< int32_t fromSlots >
     void assign_( const LFVector< T, fromSlots >& from );
 
     void push_back_unlocked_( const T& item );
+    T& alloc_back_unlocked_();
+
+    ScopedWrite lockWrite_() const;
+    size_t claim_();
+    T& alloc_( const size_t i );
+    void abort_( const size_t i );
+    void publish_( const size_t i );
+    char* getReady_( const size_t i );
+    void deleteSlot_( const int32_t slot );
+    void retireSlot_( const int32_t slot );
 
     void trim_();
 };
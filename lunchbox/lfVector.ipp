@@ -27,16 +27,24 @@ namespace lunchbox
 template< class T, int32_t nSlots >
 LFVector< T, nSlots >::LFVector()
     : size_( 0 )
+    , reserved_( 0 )
+    , appenders_( 0 )
+    , lock_( "lunchbox::LFVector" )
 {
     setZero( slots_, nSlots * sizeof( T* ));
+    setZero( ready_, nSlots * sizeof( char* ));
 }
 
 template< class T, int32_t nSlots >
 LFVector< T, nSlots >::LFVector( const size_t n )
     : size_( n )
+    , reserved_( n )
+    , appenders_( 0 )
+    , lock_( "lunchbox::LFVector" )
 {
     LBASSERT( n != 0 );
     setZero( slots_, nSlots * sizeof( T* ));
+    setZero( ready_, nSlots * sizeof( char* ));
     const int32_t s = getIndexOfLastBit( uint64_t( n ));
     for( int32_t i = 0; i <= s; ++i )
         slots_[ i ] = new T[ 1<<i ];
@@ -45,9 +53,13 @@ LFVector< T, nSlots >::LFVector( const size_t n )
 template< class T, int32_t nSlots >
 LFVector< T, nSlots >::LFVector( const size_t n, const T& t )
     : size_( 0 )
+    , reserved_( 0 )
+    , appenders_( 0 )
+    , lock_( "lunchbox::LFVector" )
 {
     LBASSERT( n != 0 );
     setZero( slots_, nSlots * sizeof( T* ));
+    setZero( ready_, nSlots * sizeof( char* ));
     const int32_t s = getIndexOfLastBit( uint64_t( n ));
     for( int32_t i = 0; i <= s; ++i )
     {
@@ -60,12 +72,15 @@ LFVector< T, nSlots >::LFVector( const size_t n, const T& t )
         }
     }
     LBASSERTINFO( size_ == n, size_ << " != " << n );
+    reserved_ = ssize_t( size_ );
 }
 
 template< class T, int32_t nSlots >
 LFVector< T, nSlots >::LFVector( const LFVector& from )
     : size_( 0 )
-    , lock_()
+    , reserved_( 0 )
+    , appenders_( 0 )
+    , lock_( "lunchbox::LFVector" )
 {
     assign_( from );
 }
@@ -74,7 +89,9 @@ template< class T, int32_t nSlots >
 template< int32_t fromSlots >
 LFVector< T, nSlots >::LFVector( const LFVector< T, fromSlots >& from )
     : size_( 0 )
-    , lock_()
+    , reserved_( 0 )
+    , appenders_( 0 )
+    , lock_( "lunchbox::LFVector" )
 {
     assign_( from );
 }
@@ -82,8 +99,8 @@ LFVector< T, nSlots >::LFVector( const LFVector< T, fromSlots >& from )
 template< class T, int32_t nSlots >
 LFVector< T, nSlots >::~LFVector()
 {
-    for( size_t i=0; i < nSlots; ++i )
-        delete [] slots_[i];
+    for( int32_t i = 0; i < nSlots; ++i )
+        deleteSlot_( i );
 }
 
 template< class T, int32_t nSlots > LFVector< T, nSlots >&
@@ -92,8 +109,8 @@ LFVector< T, nSlots >::operator = ( const LFVector< T, nSlots >& from )
     if( &from == this )
         return *this;
 
-    ScopedWrite mutex1( lock_ ); // DEADLOCK when doing a=b and b=a
-    ScopedWrite mutex2( from.lock_ ); // consider trySet/yield approach
+    ScopedWrite mutex1( lockWrite_( )); // DEADLOCK when doing a=b and b=a
+    ScopedWrite mutex2( from.lockWrite_( )); // consider trySet/yield approach
     size_ = 0;
     for( int32_t i = 0; i < nSlots; ++i )
     {
@@ -110,13 +127,11 @@ LFVector< T, nSlots >::operator = ( const LFVector< T, nSlots >& from )
             }
         }
         else if( slots_[ i ] ) // done copying, free unneeded slots
-        {
-            delete [] slots_[ i ];
-            slots_[ i ] = 0;
-        }
+            retireSlot_( i );
     }
 
     LBASSERTINFO( size_ == from.size_, size_ << " != " << from.size_ );
+    reserved_ = ssize_t( size_ );
     return *this;
 }
 
@@ -199,7 +214,7 @@ T& LFVector< T, nSlots >::back()
 template< class T, int32_t nSlots >
 void LFVector< T, nSlots >::expand( const size_t newSize, const T& item )
 {
-    ScopedWrite mutex( lock_ );
+    ScopedWrite mutex( lockWrite_( ));
     while( newSize > size( ))
         push_back_unlocked_( item );
 }
@@ -207,14 +222,71 @@ void LFVector< T, nSlots >::expand( const size_t newSize, const T& item )
 template< class T, int32_t nSlots >
 void LFVector< T, nSlots >::push_back( const T& item, bool lock )
 {
-    ScopedWrite mutex( lock ? &lock_ : 0 );
-    push_back_unlocked_( item );
+    if( !lock ) // write lock is held by caller
+    {
+        push_back_unlocked_( item );
+        return;
+    }
+
+    const size_t i = claim_();
+    try
+    {
+        alloc_( i ) = item;
+    }
+    catch( ... )
+    {
+        abort_( i );
+        throw;
+    }
+    publish_( i );
+}
+
+#ifdef LB_MOVE_SEMANTICS
+template< class T, int32_t nSlots >
+void LFVector< T, nSlots >::push_back( T&& item, bool lock )
+{
+    if( !lock ) // write lock is held by caller
+    {
+        alloc_back_unlocked_() = std::move( item );
+        reserved_ = ssize_t( ++size_ );
+        return;
+    }
+
+    const size_t i = claim_();
+    try
+    {
+        alloc_( i ) = std::move( item );
+    }
+    catch( ... )
+    {
+        abort_( i );
+        throw;
+    }
+    publish_( i );
+}
+
+template< class T, int32_t nSlots > template< class... Args >
+void LFVector< T, nSlots >::emplace_back( Args&&... args )
+{
+    T item( std::forward< Args >( args )... ); // may throw before the claim
+    const size_t i = claim_();
+    try
+    {
+        alloc_( i ) = std::move( item );
+    }
+    catch( ... )
+    {
+        abort_( i );
+        throw;
+    }
+    publish_( i );
 }
+#endif
 
 template< class T, int32_t nSlots >
 void LFVector< T, nSlots >::pop_back()
 {
-    ScopedWrite mutex( lock_ );
+    ScopedWrite mutex( lockWrite_( ));
     if( size_ == 0 )
         return;
     --size_;
@@ -225,11 +297,11 @@ void LFVector< T, nSlots >::pop_back()
 template< class T, int32_t nSlots >
 bool LFVector< T, nSlots >::pop_back( T& element )
 {
-    ScopedWrite mutex( lock_ );
+    ScopedWrite mutex( lockWrite_( ));
     if( size_ == 0 )
         return false;
 
-    element = back();
+    element = LB_MOVE( back( ));
     --size_;
     (*this)[size_] = T(); // not correct for all T? Needed to reset RefPtr
     trim_();
@@ -243,7 +315,7 @@ LFVector< T, nSlots >::erase( typename LFVector< T, nSlots >::iterator pos )
     if( pos.container_ != this || pos.i_ >= size_ )
         return end();
 
-    ScopedWrite mutex( lock_ );
+    ScopedWrite mutex( lockWrite_( ));
     --size_;
 #pragma warning (push)
 #pragma warning (disable: 4996) // unchecked iterators
@@ -257,7 +329,7 @@ LFVector< T, nSlots >::erase( typename LFVector< T, nSlots >::iterator pos )
 template< class T, int32_t nSlots > typename LFVector< T, nSlots >::iterator
 LFVector< T, nSlots >::erase( const T& element )
 {
-    ScopedWrite mutex( lock_ );
+    ScopedWrite mutex( lockWrite_( ));
     for( size_t i = size_; i != 0 ; --i )
     {
         if( (*this)[i-1] == element )
@@ -279,7 +351,7 @@ LFVector< T, nSlots >::erase( const T& element )
 template< class T, int32_t nSlots >
 void LFVector< T, nSlots >::resize( const size_t newSize, const T& value )
 {
-    ScopedWrite mutex( lock_ );
+    ScopedWrite mutex( lockWrite_( ));
     while( size_ > newSize )
     {
         --size_;
@@ -294,23 +366,21 @@ void LFVector< T, nSlots >::resize( const size_t newSize, const T& value )
 template< class T, int32_t nSlots >
 void LFVector< T, nSlots >::clear()
 {
-    ScopedWrite mutex( lock_ );
+    ScopedWrite mutex( lockWrite_( ));
     while( size_ > 0 )
     {
         --size_;
         (*this)[size_] = T(); // Needed to reset RefPtr
     }
+    reserved_ = 0;
     for( int32_t i = 0; i < nSlots; ++i )
-    {
-        delete [] slots_[ i ];
-        slots_[ i ] = 0;
-    }
+        retireSlot_( i );
 }
 
 template< class T, int32_t nSlots > typename LFVector< T, nSlots >::ScopedWrite
 LFVector< T, nSlots >::getWriteLock()
 {
-    return ScopedWrite( lock_ );
+    return lockWrite_();
 }
 
 template< class T, int32_t nSlots >
@@ -318,14 +388,16 @@ template< int32_t fromSlots >
 void LFVector< T, nSlots >::assign_( const LFVector< T, fromSlots >& from )
 {
     setZero( slots_, nSlots * sizeof( T* ));
+    setZero( ready_, nSlots * sizeof( char* ));
 
-    ScopedWrite mutex( from.lock_ );
+    ScopedWrite mutex( from.lockWrite_( ));
     for( int32_t i = 0; i < nSlots; ++i )
     {
         if( i >= fromSlots || !from.slots_[i] ) // done copying
         {
             LBASSERTINFO( size_ == from.size_,
                           size_ << " != " << from.size_ );
+            reserved_ = ssize_t( size_ );
             return;
         }
 
@@ -341,6 +413,13 @@ void LFVector< T, nSlots >::assign_( const LFVector< T, fromSlots >& from )
 
 template< class T, int32_t nSlots >
 void LFVector< T, nSlots >::push_back_unlocked_( const T& item )
+{
+    alloc_back_unlocked_() = item;
+    reserved_ = ssize_t( ++size_ );
+}
+
+template< class T, int32_t nSlots >
+T& LFVector< T, nSlots >::alloc_back_unlocked_()
 {
     const size_t i = size_ + 1;
     const int32_t slot = getIndexOfLastBit( i );
@@ -356,19 +435,185 @@ void LFVector< T, nSlots >::push_back_unlocked_( const T& item )
         slots_[ slot ] = new T[ sz ];
 
     const ssize_t index = i ^ sz;
-    slots_[ slot ][ index ] = item;
-    ++size_;
+    return slots_[ slot ][ index ];
+}
+
+template< class T, int32_t nSlots > typename LFVector< T, nSlots >::ScopedWrite
+LFVector< T, nSlots >::lockWrite_() const
+{
+    ScopedWrite mutex( lock_ );
+    // Full barrier between the lock and the appenders_ load, pairs with the
+    // increment in claim_()
+    memoryBarrier();
+    while( appenders_ > 0 ) // wait for in-flight lock-free appends
+        Thread::yield();
+    return mutex;
+}
+
+template< class T, int32_t nSlots > size_t LFVector< T, nSlots >::claim_()
+{
+    while( true )
+    {
+        // Full barrier on increment pairs with the lock in lockWrite_()
+        ++appenders_;
+        if( !lock_.isSetWrite( ))
+            break;
+
+        --appenders_; // back off during exclusive write operations
+        while( lock_.isSetWrite( ))
+            Thread::yield();
+    }
+
+    // Allocate the storage before claiming the index. A failed allocation
+    // leaves nothing to publish, which would stall all later appends.
+    while( true )
+    {
+        const ssize_t i = reserved_;
+        try
+        {
+            alloc_( i );
+            getReady_( i );
+        }
+        catch( ... )
+        {
+            --appenders_;
+            throw;
+        }
+        if( reserved_.compareAndSwap( i, i + 1 ))
+            return size_t( i );
+    }
+}
+
+template< class T, int32_t nSlots >
+T& LFVector< T, nSlots >::alloc_( const size_t i )
+{
+    const size_t j = i + 1;
+    const int32_t slot = getIndexOfLastBit( j );
+    if( slot < 0 || slot >= nSlots )
+    {
+        LBASSERTINFO( slot >= 0 && slot < nSlots, slot );
+        LBTHROW( std::runtime_error( "LFVector full" ));
+    }
+
+    const size_t sz = ( size_t( 1 ) << slot );
+    T* data = Atomic< T* >::loadAcquire( slots_[ slot ] );
+    if( !data )
+    {
+        T* newData = new T[ sz ];
+        if( Atomic< void* >::compareAndSwap(
+                reinterpret_cast< void** >( &slots_[ slot ] ), 0, newData ))
+        {
+            data = newData;
+        }
+        else // allocated concurrently
+        {
+            delete [] newData;
+            data = Atomic< T* >::loadAcquire( slots_[ slot ] );
+        }
+    }
+    return data[ j ^ sz ];
+}
+
+template< class T, int32_t nSlots >
+void LFVector< T, nSlots >::abort_( const size_t i )
+{
+    // A claimed element has to be published, otherwise size_ never advances
+    // past it and lockWrite_() waits forever for the appender.
+    try
+    {
+        alloc_( i ) = T();
+    }
+    catch( ... ) {} // element value stays unspecified
+    publish_( i );
+}
+
+template< class T, int32_t nSlots >
+void LFVector< T, nSlots >::publish_( const size_t i )
+{
+    // Fast path if all previous elements are published: advance size_ without
+    // using the flag. Otherwise flag the element for the thread advancing
+    // size_ up to it.
+    ssize_t* size = reinterpret_cast< ssize_t* >( &size_ );
+    if( !Atomic< ssize_t >::compareAndSwap( size, ssize_t( i ), ssize_t( i+1 )))
+    {
+        Atomic< char >::storeRelease( *getReady_( i ), 1 );
+        memoryBarrier(); // flag before size_ load, pairs with CAS below
+    }
+
+    // Advance size_ over all contiguous published elements. Flags below size_
+    // are unused and reset, so that they are clear if the vector shrinks.
+    while( true )
+    {
+        const ssize_t current = Atomic< ssize_t >::loadAcquire( *size );
+        if( current >= reserved_ )
+            break;
+
+        char* ready = getReady_( current );
+        if( !ready || !Atomic< char >::loadAcquire( *ready ))
+            break;
+
+        if( Atomic< ssize_t >::compareAndSwap( size, current, current + 1 ))
+            Atomic< char >::storeRelease( *ready, 0 );
+    }
+    --appenders_;
+}
+
+template< class T, int32_t nSlots >
+char* LFVector< T, nSlots >::getReady_( const size_t i )
+{
+    const size_t j = i + 1;
+    const int32_t slot = getIndexOfLastBit( j );
+    if( slot < 0 || slot >= nSlots )
+        return 0;
+
+    const size_t sz = ( size_t( 1 ) << slot );
+    char* flags = Atomic< char* >::loadAcquire( ready_[ slot ] );
+    if( !flags )
+    {
+        char* newFlags = new char[ sz ]();
+        if( Atomic< void* >::compareAndSwap(
+                reinterpret_cast< void** >( &ready_[ slot ] ), 0, newFlags ))
+        {
+            flags = newFlags;
+        }
+        else // allocated concurrently
+        {
+            delete [] newFlags;
+            flags = Atomic< char* >::loadAcquire( ready_[ slot ] );
+        }
+    }
+    return flags + ( j ^ sz );
+}
+
+template< class T, int32_t nSlots >
+void LFVector< T, nSlots >::deleteSlot_( const int32_t slot )
+{
+    delete [] slots_[ slot ];
+    slots_[ slot ] = 0;
+    delete [] ready_[ slot ];
+    ready_[ slot ] = 0;
+}
+
+template< class T, int32_t nSlots >
+void LFVector< T, nSlots >::retireSlot_( const int32_t slot )
+{
+    // Concurrent readers may still access the elements, free them once all
+    // readers have left their critical region. The ready flags are only used
+    // by appends, which are excluded by the write lock.
+    if( slots_[ slot ] )
+        Epoch::getGlobal().retireArray( slots_[ slot ] );
+    slots_[ slot ] = 0;
+    delete [] ready_[ slot ];
+    ready_[ slot ] = 0;
 }
 
 template< class T, int32_t nSlots >
 void LFVector< T, nSlots >::trim_()
 {
+    reserved_ = ssize_t( size_ ); // called after shrinking
     const int32_t nextSlot = getIndexOfLastBit( size_+1 ) + 1;
     if( nextSlot < nSlots && slots_[ nextSlot ] )
-    {
-        delete [] slots_[ nextSlot ]; // delete next slot (keep a spare)
-        slots_[ nextSlot ] = 0;
-    }
+        retireSlot_( nextSlot ); // free next slot (keep a spare)
 }
 
 template< class T, int32_t nSlots > inline typename
@@ -0,0 +1,231 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_LFMTQUEUE_H
+#define LUNCHBOX_LFMTQUEUE_H
+
+#include <lunchbox/atomic.h>       // member
+#include <lunchbox/bitOperation.h> // used inline
+#include <lunchbox/clock.h>        // used inline
+#include <lunchbox/debug.h>        // used in inline method
+#include <lunchbox/futex.h>        // used inline
+#include <boost/noncopyable.hpp>
+
+#include <limits.h>
+#include <vector>
+
+namespace lunchbox
+{
+/**
+ * A thread-safe queue with a lock-free fast path and blocking read access.
+ *
+ * A variant of MTQueue for many producers and consumers. The elements are
+ * stored in a ring buffer as in MPMCQueue, and pushing or popping an element
+ * does not take a lock. Blocked threads wait on a futex word, and flag it
+ * before sleeping. An update only issues a wakeup if the word is flagged, so
+ * the common case without waiting threads does not enter the kernel.
+ *
+ * waitSize(), timedPopRange() and popBarrier() have the same semantics as in
+ * MTQueue.
+ *
+ * Current implementation constraints:
+ * * Fixed maximum size, rounded up to a power of two. push() blocks while the
+ *   queue is full.
+ * * Elements have to be default-constructible and assignable
+ * * Popped elements are moved out of the queue if supported by the compiler
+ * * No access to queued elements, no insertion at the front
+ * * Not copyable
+ *
+ * Example: @include tests/lfmtQueue.cpp
+ */
+template< typename T > class LFMTQueue : public boost::noncopyable
+{
+public:
+    class Group;
+    typedef T value_type;
+
+    /** Construct a new queue of at least the given size. @version 1.9.2 */
+    explicit LFMTQueue( const size_t maxSize );
+
+    /** Destruct this queue. @version 1.9.2 */
+    ~LFMTQueue() {}
+
+    /**
+     * @return true if the queue is empty, false otherwise. The result is a
+     *         snapshot when used concurrently.
+     * @version 1.9.2
+     */
+    bool isEmpty() const { return _countReadable( _readPos, 1 ) == 0; }
+
+    /**
+     * @return the number of elements in the queue. The result is a snapshot
+     *         when used concurrently.
+     * @version 1.9.2
+     */
+    size_t getSize() const;
+
+    /** @return the maximum size of the queue. @version 1.9.2 */
+    size_t getMaxSize() const { return _cells.size(); }
+
+    /**
+     * Wait for the size to be at least the number of given elements.
+     *
+     * @return the current size when the condition was fulfilled.
+     * @version 1.9.2
+     */
+    size_t waitSize( const size_t minSize ) const;
+
+    /**
+     * Retrieve and pop the front element from the queue, may block.
+     * @version 1.9.2
+     */
+    T pop();
+
+    /**
+     * Retrieve and pop the front element from the queue.
+     *
+     * @param timeout the timeout in milliseconds, or LB_TIMEOUT_INDEFINITE.
+     * @param element the element returned
+     * @return true if an element was popped, false on timeout.
+     * @version 1.9.2
+     */
+    bool timedPop( const uint32_t timeout, T& element );
+
+    /**
+     * Retrieve a number of items from the front of the queue.
+     *
+     * Between minimum and maximum number of items are returned in a vector. If
+     * the queue has less than minimum number of elements on timeout, the result
+     * vector is empty. The method returns as soon as there are at least minimum
+     * elements available, i.e., it does not wait for the maximum to be reached.
+     *
+     * Note that this method might block up to 'minimum * timeout' milliseconds,
+     * that is, the timeout defines the time to wait for an update on the queue.
+     *
+     * @param timeout the timeout to wait for an update
+     * @param minimum the minimum number of items to retrieve
+     * @param maximum the maximum number of items to retrieve
+     * @return an empty vector on timeout, otherwise the result vector
+     *         containing between minimum and maximum elements.
+     * @version 1.9.2
+     */
+    std::vector< T > timedPopRange( const uint32_t timeout,
+                                    const size_t minimum = 1,
+                                    const size_t maximum = ULONG_MAX );
+
+    /**
+     * Retrieve and pop the front element from the queue if it is not empty.
+     *
+     * @param result the front value or unmodified.
+     * @return true if an element was placed in result, false if the queue
+     *         is empty.
+     * @version 1.9.2
+     */
+    bool tryPop( T& result );
+
+    /**
+     * Retrieve the front element, or abort if the barrier is reached
+     *
+     * Used for worker threads recursively processing data, pushing it back the
+     * queue. Either returns an item from the queue, or aborts if num
+     * participants are waiting in the queue.
+     *
+     * @param result the result element, unmodified on false return value.
+     * @param barrier the group's barrier handle.
+     * @return true if an element was retrieved, false if the barrier height
+     *         was reached.
+     * @version 1.9.2
+     */
+    bool popBarrier( T& result, Group& barrier );
+
+    /**
+     * Push a new element to the back of the queue, may block.
+     * @version 1.9.2
+     */
+    void push( const T& element );
+
+    /**
+     * Push a new element to the back of the queue if it is not full.
+     *
+     * @return true if the element was placed, false if the queue is full
+     * @version 1.9.2
+     */
+    bool tryPush( const T& element );
+
+#ifdef LB_MOVE_SEMANTICS
+    /** Move a new element to the back of the queue. @version 1.9.2 */
+    void push( T&& element );
+
+    /**
+     * Construct a new element at the back of the queue, may block.
+     *
+     * @param args the arguments passed to the constructor of the element.
+     * @version 1.9.2
+     */
+    template< class... Args > void emplace( Args&&... args );
+#endif
+
+    /** @name STL compatibility. @version 1.9.2 */
+    //@{
+    void push_back( const T& element ) { push( element ); }
+#ifdef LB_MOVE_SEMANTICS
+    void push_back( T&& element ) { push( std::move( element )); }
+    template< class... Args > void emplace_back( Args&&... args )
+        { emplace( std::forward< Args >( args )... ); }
+#endif
+    bool empty() const { return isEmpty(); }
+    //@}
+
+private:
+    struct Cell
+    {
+        Cell() : sequence( 0 ) {}
+        ssize_t sequence;
+        T data;
+    };
+
+    std::vector< Cell > _cells;
+    const ssize_t _mask;
+
+    char _pad0[ LB_CACHELINE_SIZE ];
+    a_ssize_t _writePos;
+    char _pad1[ LB_CACHELINE_SIZE ];
+    a_ssize_t _readPos;
+    char _pad2[ LB_CACHELINE_SIZE ];
+
+    // Blocked readers wait on _pushes, blocked writers on _pops. The words are
+    // only changed and woken if a sleeping thread has set the _sleeping flag.
+    mutable int32_t _pushes;
+    char _pad3[ LB_CACHELINE_SIZE ];
+    int32_t _pops;
+
+    static const int32_t _sleeping = 1;
+
+    static size_t _getRingSize( const size_t size );
+    size_t _countReadable( const ssize_t pos, const size_t maximum ) const;
+    Cell* _claimWrite( ssize_t& pos, const bool block );
+    void _commitWrite( Cell* cell, const ssize_t pos );
+    bool _popRange( const size_t minimum, const size_t maximum,
+                    std::vector< T >& result );
+    static int32_t _prepareWait( int32_t& word );
+    static void _wake( int32_t& word );
+};
+}
+
+#include "lfmtQueue.ipp" // template implementation
+
+#endif // LUNCHBOX_LFMTQUEUE_H
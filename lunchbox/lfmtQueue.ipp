@@ -0,0 +1,392 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+namespace lunchbox
+{
+/** Group descriptor for popBarrier(). @version 1.9.2 */
+template< typename T > class LFMTQueue< T >::Group
+{
+    friend class LFMTQueue< T >;
+    size_t height_;
+
+    // Bits 0-14: waiting members, bit 15: barrier reached, bits 16-31: number
+    // of members leaving the barrier, detects leaving members on completion.
+    int32_t state_;
+
+    static const int32_t count_ = 0x7fff;
+    static const int32_t done_ = 0x8000;
+    static const int32_t leave_ = 0x10000 - 1;
+
+public:
+    /**
+     * Construct a new group of the given size. Can only be used once.
+     * @version 1.9.2
+     */
+    explicit Group( const size_t height ) : height_( height ), state_( 0 )
+        { LBASSERT( height < size_t( count_ )); }
+
+    /** Update the height. @version 1.9.2  */
+    void setHeight( const size_t height ) { height_ = height; }
+};
+
+template< typename T >
+LFMTQueue< T >::LFMTQueue( const size_t maxSize )
+    : _cells( _getRingSize( maxSize ))
+    , _mask( _cells.size() - 1 )
+    , _writePos( 0 )
+    , _readPos( 0 )
+    , _pushes( 0 )
+    , _pops( 0 )
+{
+    for( size_t i = 0; i < _cells.size(); ++i )
+        _cells[ i ].sequence = i;
+    memoryBarrier();
+}
+
+template< typename T >
+size_t LFMTQueue< T >::_getRingSize( const size_t size )
+{
+    LBASSERT( size > 0 );
+    if( size <= 1 )
+        return 2;
+    if(( size & ( size - 1 )) == 0 )
+        return size;
+    return size_t( 1 ) << ( getIndexOfLastBit( uint64_t( size )) + 1 );
+}
+
+template< typename T > size_t LFMTQueue< T >::getSize() const
+{
+    const ssize_t readPos = _readPos;
+    const ssize_t writePos = _writePos;
+    return writePos > readPos ? writePos - readPos : 0;
+}
+
+template< typename T >
+size_t LFMTQueue< T >::_countReadable( const ssize_t pos,
+                                       const size_t maximum ) const
+{
+    const size_t end = LB_MIN( maximum, _cells.size( ));
+    size_t i = 0;
+    for( ; i < end; ++i )
+    {
+        const Cell& cell = _cells[ ( pos + i ) & _mask ];
+        const ssize_t sequence = Atomic< ssize_t >::loadAcquire(
+                                                                cell.sequence );
+        if( sequence != ssize_t( pos + i + 1 ))
+            break;
+    }
+    return i;
+}
+
+template< typename T >
+size_t LFMTQueue< T >::waitSize( const size_t minSize ) const
+{
+    LBASSERT( minSize <= getMaxSize( ));
+    while( _countReadable( _readPos, minSize ) < minSize )
+    {
+        const int32_t pushes = _prepareWait( _pushes );
+        if( _countReadable( _readPos, minSize ) >= minSize )
+            break;
+        futexWait( &_pushes, pushes );
+    }
+    return LB_MAX( getSize(), minSize );
+}
+
+template< typename T >
+int32_t LFMTQueue< T >::_prepareWait( int32_t& word )
+{
+    // The caller has to recheck its condition after setting the flag. The full
+    // barrier of the CAS pairs with the one in _wake() to not miss an update.
+    for( ;; )
+    {
+        const int32_t value = Atomic< int32_t >::loadAcquire( word );
+        if(( value & _sleeping ) ||
+           Atomic< int32_t >::compareAndSwap( &word, value, value | _sleeping ))
+        {
+            return value | _sleeping;
+        }
+    }
+}
+
+template< typename T > void LFMTQueue< T >::_wake( int32_t& word )
+{
+    memoryBarrier();
+    int32_t value = Atomic< int32_t >::load( word, ORDER_RELAXED );
+    while( value & _sleeping )
+    {
+        // new value without the flag, sleepers set it again before sleeping
+        const int32_t update = ( value + 2 ) & ~_sleeping;
+        if( Atomic< int32_t >::compareAndSwap( &word, value, update ))
+        {
+            futexWakeAll( &word );
+            return;
+        }
+        value = Atomic< int32_t >::load( word, ORDER_RELAXED );
+    }
+}
+
+template< typename T > typename LFMTQueue< T >::Cell*
+LFMTQueue< T >::_claimWrite( ssize_t& pos, const bool block )
+{
+    int32_t pops = 0;
+    bool prepared = false;
+    for( ;; )
+    {
+        pos = _writePos;
+        for( ;; )
+        {
+            Cell* cell = &_cells[ pos & _mask ];
+            const ssize_t sequence = Atomic< ssize_t >::loadAcquire(
+                                                               cell->sequence );
+            const ssize_t diff = sequence - pos;
+
+            if( diff == 0 ) // slot is free, claim it
+            {
+                if( _writePos.compareAndSwap( pos, pos + 1 ))
+                    return cell;
+                pos = _writePos;
+            }
+            else if( diff < 0 ) // slot not yet read: full
+                break;
+            else // another writer claimed it
+                pos = _writePos;
+        }
+
+        if( !block )
+            return 0;
+
+        // full: flag the sleeping writer, recheck and sleep on the next round
+        if( prepared )
+            futexWait( &_pops, pops );
+        else
+            pops = _prepareWait( _pops );
+        prepared = !prepared;
+    }
+}
+
+template< typename T >
+void LFMTQueue< T >::_commitWrite( Cell* cell, const ssize_t pos )
+{
+    Atomic< ssize_t >::storeRelease( cell->sequence, pos + 1 );
+    _wake( _pushes );
+}
+
+template< typename T > void LFMTQueue< T >::push( const T& element )
+{
+    ssize_t pos;
+    Cell* cell = _claimWrite( pos, true );
+    cell->data = element;
+    _commitWrite( cell, pos );
+}
+
+template< typename T > bool LFMTQueue< T >::tryPush( const T& element )
+{
+    ssize_t pos;
+    Cell* cell = _claimWrite( pos, false );
+    if( !cell )
+        return false;
+
+    cell->data = element;
+    _commitWrite( cell, pos );
+    return true;
+}
+
+#ifdef LB_MOVE_SEMANTICS
+template< typename T > void LFMTQueue< T >::push( T&& element )
+{
+    ssize_t pos;
+    Cell* cell = _claimWrite( pos, true );
+    cell->data = std::move( element );
+    _commitWrite( cell, pos );
+}
+
+template< typename T > template< class... Args >
+void LFMTQueue< T >::emplace( Args&&... args )
+{
+    ssize_t pos;
+    Cell* cell = _claimWrite( pos, true );
+    cell->data = T( std::forward< Args >( args )... );
+    _commitWrite( cell, pos );
+}
+#endif
+
+template< typename T > bool LFMTQueue< T >::tryPop( T& result )
+{
+    ssize_t pos = _readPos;
+    Cell* cell;
+    for( ;; )
+    {
+        cell = &_cells[ pos & _mask ];
+        const ssize_t sequence = Atomic< ssize_t >::loadAcquire(
+                                                               cell->sequence );
+        const ssize_t diff = sequence - ( pos + 1 );
+
+        if( diff == 0 ) // slot is written, claim it
+        {
+            if( _readPos.compareAndSwap( pos, pos + 1 ))
+                break;
+            pos = _readPos;
+        }
+        else if( diff < 0 ) // slot not yet written: empty
+            return false;
+        else // another reader claimed it
+            pos = _readPos;
+    }
+
+    result = LB_MOVE( cell->data );
+    Atomic< ssize_t >::storeRelease( cell->sequence, pos + _mask + 1 );
+    _wake( _pops );
+    return true;
+}
+
+template< typename T > T LFMTQueue< T >::pop()
+{
+    T element;
+    timedPop( LB_TIMEOUT_INDEFINITE, element );
+    return element;
+}
+
+template< typename T >
+bool LFMTQueue< T >::timedPop( const uint32_t timeout, T& result )
+{
+    static const size_t spinCount = 64; // waking is cheap, don't spin long
+    for( size_t i = 0; i < spinCount; ++i )
+    {
+        if( tryPop( result ))
+            return true;
+        spinPause();
+    }
+
+    const bool indefinite = ( timeout == LB_TIMEOUT_INDEFINITE );
+    const int64_t time = timeout == LB_TIMEOUT_DEFAULT ? 300000 /* 5 min */ :
+                                                         timeout;
+    Clock clock;
+    for( ;; )
+    {
+        const int32_t pushes = _prepareWait( _pushes );
+        if( tryPop( result ))
+            return true;
+
+        if( indefinite )
+        {
+            futexWait( &_pushes, pushes );
+            continue;
+        }
+
+        const int64_t elapsed = clock.getTime64();
+        if( elapsed >= time ||
+            !futexWait( &_pushes, pushes, uint32_t( time - elapsed )))
+        {
+            return tryPop( result );
+        }
+    }
+}
+
+template< typename T >
+bool LFMTQueue< T >::_popRange( const size_t minimum, const size_t maximum,
+                                std::vector< T >& result )
+{
+    ssize_t pos = _readPos;
+    size_t size;
+    for( ;; )
+    {
+        size = _countReadable( pos, maximum );
+        if( size < minimum )
+            return false;
+        if( _readPos.compareAndSwap( pos, pos + size ))
+            break;
+        pos = _readPos;
+    }
+
+    result.reserve( size );
+    for( size_t i = 0; i < size; ++i )
+    {
+        Cell& cell = _cells[ ( pos + i ) & _mask ];
+        result.push_back( LB_MOVE( cell.data ));
+        Atomic< ssize_t >::storeRelease( cell.sequence, pos + i + _mask + 1 );
+    }
+    _wake( _pops );
+    return true;
+}
+
+template< typename T > std::vector< T >
+LFMTQueue< T >::timedPopRange( const uint32_t timeout, const size_t minimum,
+                               const size_t maximum )
+{
+    LBASSERT( minimum <= getMaxSize( ));
+    std::vector< T > result;
+    while( !_popRange( minimum, maximum, result ))
+    {
+        const int32_t pushes = _prepareWait( _pushes );
+        if( _popRange( minimum, maximum, result ))
+            break;
+        if( !futexWait( &_pushes, pushes, timeout ))
+        {
+            _popRange( minimum, maximum, result );
+            break;
+        }
+    }
+    return result;
+}
+
+template< typename T >
+bool LFMTQueue< T >::popBarrier( T& element, Group& barrier )
+{
+    LBASSERT( barrier.height_ > 0 );
+
+    // A member is waiting while it does not hold an element. A member leaves
+    // the barrier before popping, so that the barrier is only reached if all
+    // members wait at the same time on an empty queue.
+    int32_t state = Atomic< int32_t >::getAndAdd( barrier.state_, 1 ) + 1;
+    for( ;; )
+    {
+        if( !isEmpty( ))
+        {
+            Atomic< int32_t >::getAndAdd( barrier.state_, Group::leave_ );
+            if( tryPop( element ))
+                return true;
+            state = Atomic< int32_t >::getAndAdd( barrier.state_, 1 ) + 1;
+        }
+
+        if( state & Group::done_ )
+            return false;
+
+        if( size_t( state & Group::count_ ) >= barrier.height_ )
+        {
+            // fails if a member left meanwhile, which will recheck on return
+            if( isEmpty() &&
+                Atomic< int32_t >::compareAndSwap( &barrier.state_, state,
+                                                   state | Group::done_ ))
+            {
+                _wake( _pushes );
+                return false;
+            }
+        }
+        else
+        {
+            const int32_t pushes = _prepareWait( _pushes );
+            state = Atomic< int32_t >::loadAcquire( barrier.state_ );
+            if( isEmpty() && !( state & Group::done_ ) &&
+                size_t( state & Group::count_ ) < barrier.height_ )
+            {
+                futexWait( &_pushes, pushes );
+            }
+        }
+        state = Atomic< int32_t >::loadAcquire( barrier.state_ );
+    }
+}
+}
@@ -0,0 +1,125 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_LOCALREFERENCED_H
+#define LUNCHBOX_LOCALREFERENCED_H
+
+#include <lunchbox/api.h>    // for LUNCHBOX_API
+#include <lunchbox/debug.h>  // for LBASSERT
+#include <lunchbox/thread.h> // thread-safety checks
+
+#include <iostream>
+
+namespace lunchbox
+{
+/**
+ * Base class for reference-counted objects used by a single thread.
+ *
+ * Implements the same interface as Referenced, and can be used with RefPtr and
+ * boost::intrusive_ptr. The reference count is a plain integer, which avoids
+ * the cost of atomic operations. All references to the object have to be
+ * created and released by one thread, which is checked in debug builds.
+ *
+ * @sa BiasedReferenced for objects mostly, but not only, used by one thread.
+ */
+class LocalReferenced
+{
+public:
+    /** Increase the reference count. @version 1.9.2 */
+    void ref( const void* holder LB_UNUSED = 0 ) const
+    {
+        _checkThread();
+        ++_refCount;
+    }
+
+    /**
+     * Decrease the reference count.
+     *
+     * The object is deleted when the reference count reaches 0.
+     * @return true if the reference count went to 0, false otherwise.
+     * @version 1.9.2
+     */
+    bool unref( const void* holder LB_UNUSED = 0 ) const
+    {
+        _checkThread();
+        LBASSERT( _refCount > 0 );
+        if( --_refCount > 0 )
+            return false;
+
+        const_cast< LocalReferenced* >( this )->notifyFree();
+        return true;
+    }
+
+    /** @return the current reference count. @version 1.9.2 */
+    int32_t getRefCount() const { return _refCount; }
+
+    /** @internal holders are not tracked. */
+    void printHolders( std::ostream& ) const {}
+
+protected:
+    /** Construct a new reference-counted object. @version 1.9.2 */
+    LUNCHBOX_API LocalReferenced();
+
+    /** Construct a new copy of a reference-counted object. @version 1.9.2 */
+    LocalReferenced( const LocalReferenced& )
+        : _refCount( 0 )
+        , _hasBeenDeleted( false )
+    {}
+
+    /** Destruct a reference-counted object. @version 1.9.2 */
+    LUNCHBOX_API virtual ~LocalReferenced();
+
+    /** Assign another object to this object. @version 1.9.2 */
+    // cppcheck-suppress operatorEqVarError
+    LocalReferenced& operator = ( const LocalReferenced& ) { return *this; }
+
+    /** Called when the reference count reaches 0. @version 1.9.2 */
+    LUNCHBOX_API virtual void notifyFree();
+
+private:
+    mutable int32_t _refCount;
+    bool _hasBeenDeleted;
+#ifdef LB_CHECK_THREADSAFETY
+    LB_TS_VAR( _thread );
+#endif
+
+    void _checkThread() const
+    {
+#ifndef NDEBUG
+        LBASSERT( !_hasBeenDeleted );
+#endif
+        LB_TS_THREAD( _thread );
+    }
+};
+}
+
+namespace boost
+{
+/** Allow creation of boost::intrusive_ptr from LocalReferenced. */
+inline void intrusive_ptr_add_ref( lunchbox::LocalReferenced* referenced )
+{
+    referenced->ref();
+}
+
+/** Allow creation of boost::intrusive_ptr from LocalReferenced. */
+inline void intrusive_ptr_release( lunchbox::LocalReferenced* referenced )
+{
+    referenced->unref();
+}
+}
+
+#endif // LUNCHBOX_LOCALREFERENCED_H
@@ -17,6 +17,7 @@
 
 #include "lock.h"
 
+#include "lockProfile.h"
 #include "log.h"
 #include "os.h"
 
@@ -31,72 +32,120 @@ namespace detail
 class Lock
 {
 public:
+    explicit Lock( const char* name )
+        : profile( lunchbox::LockProfile::create( name ))
+    {
 #ifdef _WIN32
-    CRITICAL_SECTION cs; 
+        InitializeCriticalSection( &cs );
 #else
-    pthread_mutex_t mutex;
+        const int error = pthread_mutex_init( &mutex, 0 );
+        if( error )
+        {
+            LBERROR << "Error creating pthread mutex: "
+                    << strerror(error) << std::endl;
+            return;
+        }
 #endif
-};
-}
+    }
 
-Lock::Lock()
-        : _impl ( new detail::Lock )
-{
+    ~Lock()
+    {
 #ifdef _WIN32
-    InitializeCriticalSection( &_impl->cs );
+        DeleteCriticalSection( &cs );
 #else
-    const int error = pthread_mutex_init( &_impl->mutex, 0 );
-    if( error )
+        pthread_mutex_destroy( &mutex );
+#endif
+        delete profile;
+    }
+
+    void set()
     {
-        LBERROR << "Error creating pthread mutex: "
-                << strerror(error) << std::endl;
-        return;
+#ifdef _WIN32
+        EnterCriticalSection( &cs );
+#else
+        pthread_mutex_lock( &mutex );
+#endif
     }
+
+    void unset()
+    {
+#ifdef _WIN32
+        LeaveCriticalSection( &cs );
+#else
+        pthread_mutex_unlock( &mutex );
 #endif
-}
+    }
 
-Lock::~Lock()
-{
+    bool trySet()
+    {
+#ifdef _WIN32
+        return TryEnterCriticalSection( &cs );
+#else
+        return ( pthread_mutex_trylock( &mutex ) == 0 );
+#endif
+    }
+
+    lunchbox::LockProfile* const profile;
 #ifdef _WIN32
-    DeleteCriticalSection( &_impl->cs ); 
+    CRITICAL_SECTION cs;
 #else
-    pthread_mutex_destroy( &_impl->mutex );
+    pthread_mutex_t mutex;
 #endif
+};
+}
+
+Lock::Lock()
+        : _impl ( new detail::Lock( 0 ))
+{}
+
+Lock::Lock( const char* name )
+        : _impl ( new detail::Lock( name ))
+{}
+
+Lock::~Lock()
+{
     delete _impl;
 }
 
 void Lock::set()
 {
-#ifdef _WIN32
-    EnterCriticalSection( &_impl->cs );
-#else
-    pthread_mutex_lock( &_impl->mutex );
-#endif
+    if( !_impl->profile )
+    {
+        _impl->set();
+        return;
+    }
+
+    if( _impl->trySet( ))
+    {
+        _impl->profile->acquired( true );
+        return;
+    }
+    const uint64_t start = LockProfile::getTime();
+    _impl->set();
+    _impl->profile->acquired( true, start );
 }
 
 void Lock::unset()
 {
-#ifdef _WIN32
-    LeaveCriticalSection( &_impl->cs );
-#else
-    pthread_mutex_unlock( &_impl->mutex );
-#endif
+    if( _impl->profile )
+        _impl->profile->released();
+    _impl->unset();
 }
 
 bool Lock::trySet()
 {
-#ifdef _WIN32
-    return TryEnterCriticalSection( &_impl->cs );
-#else
-    return ( pthread_mutex_trylock( &_impl->mutex ) == 0 );
-#endif
+    if( !_impl->trySet( ))
+        return false;
+    if( _impl->profile )
+        _impl->profile->acquired( true );
+    return true;
 }
 
 bool Lock::isSet()
 {
-    if( trySet( ))
+    if( _impl->trySet( ))
     {
-        unset();
+        _impl->unset();
         return false;
     }
     return true;
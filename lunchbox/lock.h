@@ -39,6 +39,15 @@ public:
     /** Construct a new lock. @version 1.0 */
     LUNCHBOX_API Lock();
 
+    /**
+     * Construct a new named lock.
+     *
+     * @param name the name used for lock profiling.
+     * @sa LockProfile
+     * @version 1.9.2
+     */
+    LUNCHBOX_API explicit Lock( const char* name );
+
     /** Destruct the lock. @version 1.0 */
     LUNCHBOX_API ~Lock();
 
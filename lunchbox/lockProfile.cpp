@@ -0,0 +1,220 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "lockProfile.h"
+
+#include "atomic.h"
+#include "clock.h"
+#include "scopedMutex.h"
+#include "spinLock.h"
+
+#include <algorithm>
+#include <map>
+#include <stdlib.h>
+
+namespace lunchbox
+{
+namespace
+{
+int32_t _isEnabledByDefault()
+{
+#ifdef LUNCHBOX_LOCK_PROFILING
+    return 1;
+#else
+    const char* env = getenv( "LB_LOCK_PROFILE" );
+    return env && *env && std::string( env ) != "0";
+#endif
+}
+
+void _add( LockStats& to, const LockStats& from )
+{
+    to.nAcquired += from.nAcquired;
+    to.nContended += from.nContended;
+    to.waitTime += from.waitTime;
+    to.maxWaitTime = std::max( to.maxWaitTime, from.maxWaitTime );
+    to.holdTime += from.holdTime;
+}
+
+bool _hasLongerWait( const LockStats& a, const LockStats& b )
+{
+    return a.waitTime > b.waitTime;
+}
+}
+
+namespace detail
+{
+class LockProfile
+{
+public:
+    explicit LockProfile( const char* name ) : acquiredTime( 0 )
+        { stats.name = name; }
+
+    lunchbox::SpinLock lock; // protects stats, never profiled itself
+    LockStats stats;
+    uint64_t acquiredTime; // only used by the exclusive owner
+};
+
+/** The registry of all profiles and of the statistics of destroyed locks. */
+class LockProfiles
+{
+public:
+    LockProfiles() : enabled( _isEnabledByDefault( )) {}
+
+    static LockProfiles& getInstance()
+    {
+        // never destroyed, locks in static objects may be destroyed later
+        static LockProfiles* instance = new LockProfiles;
+        return *instance;
+    }
+
+    int32_t enabled;
+    lunchbox::SpinLock lock; // protects profiles and retired
+    std::vector< LockProfile* > profiles;
+    std::map< std::string, LockStats > retired;
+};
+}
+
+bool LockProfile::isEnabled()
+{
+    return Atomic< int32_t >::loadAcquire(
+        detail::LockProfiles::getInstance().enabled ) != 0;
+}
+
+void LockProfile::setEnabled( const bool enabled )
+{
+    Atomic< int32_t >::storeRelease(
+        detail::LockProfiles::getInstance().enabled, enabled ? 1 : 0 );
+}
+
+LockStatsVector LockProfile::getStats()
+{
+    detail::LockProfiles& registry = detail::LockProfiles::getInstance();
+    std::map< std::string, LockStats > merged;
+    {
+        ScopedFastWrite mutex( registry.lock );
+        merged = registry.retired;
+        for( size_t i = 0; i < registry.profiles.size(); ++i )
+        {
+            detail::LockProfile* profile = registry.profiles[i];
+            ScopedFastWrite profileMutex( profile->lock );
+            LockStats& stats = merged[ profile->stats.name ];
+            stats.name = profile->stats.name;
+            _add( stats, profile->stats );
+        }
+    }
+
+    LockStatsVector result;
+    for( std::map< std::string, LockStats >::const_iterator i = merged.begin();
+         i != merged.end(); ++i )
+    {
+        result.push_back( i->second );
+    }
+    std::stable_sort( result.begin(), result.end(), _hasLongerWait );
+    return result;
+}
+
+void LockProfile::resetStats()
+{
+    detail::LockProfiles& registry = detail::LockProfiles::getInstance();
+    ScopedFastWrite mutex( registry.lock );
+    registry.retired.clear();
+    for( size_t i = 0; i < registry.profiles.size(); ++i )
+    {
+        detail::LockProfile* profile = registry.profiles[i];
+        ScopedFastWrite profileMutex( profile->lock );
+        const std::string name = profile->stats.name;
+        profile->stats = LockStats();
+        profile->stats.name = name;
+    }
+}
+
+LockProfile* LockProfile::create( const char* name )
+{
+    if( !name || !isEnabled( ))
+        return 0;
+    return new LockProfile( name );
+}
+
+uint64_t LockProfile::getTime()
+{
+    static const Clock clock;
+    return uint64_t( clock.getTimed() * 1000000. );
+}
+
+LockProfile::LockProfile( const char* name )
+    : _impl( new detail::LockProfile( name ))
+{
+    detail::LockProfiles& registry = detail::LockProfiles::getInstance();
+    ScopedFastWrite mutex( registry.lock );
+    registry.profiles.push_back( _impl );
+}
+
+LockProfile::~LockProfile()
+{
+    detail::LockProfiles& registry = detail::LockProfiles::getInstance();
+    {
+        ScopedFastWrite mutex( registry.lock );
+        std::vector< detail::LockProfile* >& profiles = registry.profiles;
+        profiles.erase( std::find( profiles.begin(), profiles.end(), _impl ));
+
+        LockStats& stats = registry.retired[ _impl->stats.name ];
+        stats.name = _impl->stats.name;
+        _add( stats, _impl->stats );
+    }
+    delete _impl;
+}
+
+void LockProfile::acquired( const bool exclusive )
+{
+    ScopedFastWrite mutex( _impl->lock );
+    ++_impl->stats.nAcquired;
+    if( exclusive )
+        _impl->acquiredTime = getTime();
+}
+
+void LockProfile::acquired( const bool exclusive, const uint64_t waitStart )
+{
+    const uint64_t now = getTime();
+    const uint64_t waitTime = now > waitStart ? now - waitStart : 0;
+
+    ScopedFastWrite mutex( _impl->lock );
+    LockStats& stats = _impl->stats;
+    ++stats.nAcquired;
+    ++stats.nContended;
+    stats.waitTime += waitTime;
+    stats.maxWaitTime = std::max( stats.maxWaitTime, waitTime );
+    if( exclusive )
+        _impl->acquiredTime = now;
+}
+
+void LockProfile::released()
+{
+    const uint64_t now = getTime();
+    ScopedFastWrite mutex( _impl->lock );
+    if( now > _impl->acquiredTime )
+        _impl->stats.holdTime += now - _impl->acquiredTime;
+}
+
+std::ostream& operator << ( std::ostream& os, const LockStats& stats )
+{
+    return os << stats.name << ": " << stats.nAcquired << " acquired, "
+              << stats.nContended << " contended, waited " << stats.waitTime
+              << " ns (max " << stats.maxWaitTime << " ns), held "
+              << stats.holdTime << " ns";
+}
+
+}
@@ -0,0 +1,117 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_LOCKPROFILE_H
+#define LUNCHBOX_LOCKPROFILE_H
+
+#include <lunchbox/api.h>
+#include <lunchbox/types.h>
+#include <boost/noncopyable.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace lunchbox
+{
+namespace detail { class LockProfile; }
+
+/** The accumulated contention statistics of all locks with the same name. */
+struct LockStats
+{
+    LockStats() : nAcquired( 0 ), nContended( 0 ), waitTime( 0 ),
+                  maxWaitTime( 0 ), holdTime( 0 ) {}
+
+    std::string name; //!< The name given to the locks at construction
+    uint64_t nAcquired; //!< Number of acquisitions, including shared ones
+    uint64_t nContended; //!< Number of acquisitions which had to wait
+    uint64_t waitTime; //!< Total time waited for the locks, in nanoseconds
+    uint64_t maxWaitTime; //!< Longest single wait, in nanoseconds
+    uint64_t holdTime; //!< Total time held exclusively, in nanoseconds
+};
+
+/** A list of lock statistics. @version 1.9.2 */
+typedef std::vector< LockStats > LockStatsVector;
+
+/**
+ * The contention profile of a named lock.
+ *
+ * Lock, SpinLock, TimedLock and Condition accept a name at construction. If
+ * lock profiling is enabled, a named lock creates a profile which records each
+ * acquisition, the time spent waiting for the lock and the time it is held
+ * exclusively. Statistics are aggregated by name, and are kept after the
+ * destruction of the locks. Unnamed locks, and all locks when profiling is
+ * disabled, only test a null pointer in addition to their normal operation.
+ *
+ * Profiling is enabled by building Lunchbox with LUNCHBOX_LOCK_PROFILING, by
+ * setting the environment variable LB_LOCK_PROFILE to a non-zero value, or
+ * programmatically using setEnabled(). It only affects locks constructed
+ * afterwards. The statistics of all locks are logged at the info level by
+ * lunchbox::exit().
+ *
+ * Example: @include tests/lockProfile.cpp
+ */
+class LockProfile : public boost::noncopyable
+{
+public:
+    /** @return true if named locks are profiled. @version 1.9.2 */
+    LUNCHBOX_API static bool isEnabled();
+
+    /**
+     * Enable or disable the profiling of subsequently constructed locks.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API static void setEnabled( bool enabled );
+
+    /**
+     * @return the statistics of all profiled locks, sorted by decreasing
+     *         total wait time.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API static LockStatsVector getStats();
+
+    /** Clear the statistics of all profiled locks. @version 1.9.2 */
+    LUNCHBOX_API static void resetStats();
+
+    /** @internal @return a new profile, or 0 if name is 0 or disabled. */
+    LUNCHBOX_API static LockProfile* create( const char* name );
+
+    /** @internal @return the current time in nanoseconds. */
+    LUNCHBOX_API static uint64_t getTime();
+
+    /** @internal */
+    LUNCHBOX_API ~LockProfile();
+
+    /** @internal Record an acquisition without waiting. */
+    LUNCHBOX_API void acquired( bool exclusive );
+
+    /** @internal Record an acquisition after waiting since the given time. */
+    LUNCHBOX_API void acquired( bool exclusive, uint64_t waitStart );
+
+    /** @internal Record the release of an exclusive acquisition. */
+    LUNCHBOX_API void released();
+
+private:
+    explicit LockProfile( const char* name );
+    detail::LockProfile* const _impl;
+};
+
+/** Print the lock statistics to the given output stream. @version 1.9.2 */
+LUNCHBOX_API std::ostream& operator << ( std::ostream& os,
+                                         const LockStats& stats );
+}
+#endif // LUNCHBOX_LOCKPROFILE_H
@@ -45,7 +45,7 @@ static const size_t threadNameLength = 8;
 static unsigned getLogTopics();
 static Clock    _defaultClock;
 static Clock*   _clock = &_defaultClock;
-static Lock     _lock; // The write lock
+static Lock     _lock( "lunchbox::Log" ); // The write lock
 
 namespace detail
 {
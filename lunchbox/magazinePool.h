@@ -0,0 +1,155 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_MAGAZINEPOOL_H
+#define LUNCHBOX_MAGAZINEPOOL_H
+
+#include <lunchbox/debug.h>       // used inline
+#include <lunchbox/scopedMutex.h> // used inline
+#include <lunchbox/spinLock.h>    // member
+#include <lunchbox/tls.h>         // member
+#include <boost/noncopyable.hpp>
+
+#include <vector>
+
+namespace lunchbox
+{
+/**
+ * A thread-safe object allocation pool with per-thread caches.
+ *
+ * Each thread caches up to two magazines of M objects. Most alloc() and
+ * release() calls only access the calling thread's magazines, without locking
+ * or sharing cache lines with other threads. A thread exchanges a full or an
+ * empty magazine with a shared depot when both of its magazines are exhausted,
+ * which amortizes the depot lock over M operations. Objects may be released
+ * by a different thread than the one which allocated them.
+ *
+ * The number of objects cached in the depot is bounded by a high-water mark,
+ * beyond which released objects are deleted. trim() deletes the objects which
+ * were not needed since the last trim, which allows the pool to shrink after a
+ * burst of allocations.
+ *
+ * Compared to Pool< T, true >, which locks on each operation, the pool caches
+ * up to 2 * M objects per thread in addition to the depot.
+ *
+ * Example: @include tests/pool.cpp
+ */
+template< typename T, size_t M = 32 >
+class MagazinePool : public boost::noncopyable
+{
+public:
+    /** Construct a new pool. @version 1.9.2 */
+    MagazinePool();
+
+    /**
+     * Destruct this pool and all cached objects.
+     *
+     * No thread may use the pool concurrently.
+     * @version 1.9.2
+     */
+    virtual ~MagazinePool();
+
+    /** @return a reusable or new item. @version 1.9.2 */
+    T* alloc();
+
+    /** Release an item for reuse. @version 1.9.2 */
+    void release( T* item );
+
+    /**
+     * Delete all items cached in the depot and by the calling thread.
+     *
+     * Items cached by other threads are deleted on their exit or on
+     * destruction of the pool.
+     * @version 1.9.2
+     */
+    void flush();
+
+    /**
+     * Delete the depot items which were not needed since the last trim.
+     *
+     * Call periodically to return memory from idle pools.
+     * @return the number of deleted items.
+     * @version 1.9.2
+     */
+    size_t trim();
+
+    /**
+     * Set the maximum number of items cached in the depot.
+     *
+     * Full magazines released to a depot at its high-water mark are deleted.
+     * Rounded down to a multiple of M, unlimited by default.
+     * @version 1.9.2
+     */
+    void setMaxCached( size_t maxItems );
+
+    /**
+     * @return the maximum number of items cached in the depot.
+     * @version 1.9.2
+     */
+    size_t getMaxCached() const { return _maxMagazines * M; }
+
+    /** @return the number of items cached in the depot. @version 1.9.2 */
+    size_t getNCached() const;
+
+private:
+    struct Magazine
+    {
+        Magazine() : size( 0 ) {}
+
+        bool isEmpty() const { return size == 0; }
+        bool isFull() const { return size == M; }
+        T* pop() { return items[ --size ]; }
+        void push( T* item ) { items[ size++ ] = item; }
+        void clear() { while( size ) delete pop(); }
+
+        T* items[ M ];
+        size_t size;
+    };
+    typedef std::vector< Magazine* > Magazines;
+
+    /** The magazines of one thread */
+    struct Cache
+    {
+        explicit Cache( MagazinePool* p )
+            : pool( p ), loaded( new Magazine ), previous( new Magazine ) {}
+
+        MagazinePool* const pool;
+        Magazine* loaded;
+        Magazine* previous;
+    };
+    typedef std::vector< Cache* > Caches;
+
+    TLS _cache;
+
+    mutable SpinLock _lock; // protects the depot:
+    Magazines _full;
+    Magazines _empty;
+    Caches _caches;
+    size_t _maxMagazines;
+    size_t _minFull; // low-water mark of _full since the last trim
+
+    Cache& _getCache();
+    void _exchangeEmpty( Cache& cache );
+    bool _exchangeFull( Cache& cache );
+    void _applyMaxCached();
+    static void _exitThread( void* cache );
+};
+}
+
+#include "magazinePool.ipp" // template implementation
+
+#endif // LUNCHBOX_MAGAZINEPOOL_H
@@ -0,0 +1,261 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <limits>
+
+namespace lunchbox
+{
+template< typename T, size_t M > MagazinePool< T, M >::MagazinePool()
+    : _cache( &MagazinePool< T, M >::_exitThread )
+    , _lock( "lunchbox::MagazinePool" )
+    , _maxMagazines( std::numeric_limits< size_t >::max() / M )
+    , _minFull( 0 )
+{}
+
+template< typename T, size_t M > MagazinePool< T, M >::~MagazinePool()
+{
+    _cache.set( 0 );
+    for( typename Caches::const_iterator i = _caches.begin();
+         i != _caches.end(); ++i )
+    {
+        Cache* cache = *i;
+        cache->loaded->clear();
+        cache->previous->clear();
+        delete cache->loaded;
+        delete cache->previous;
+        delete cache;
+    }
+    _caches.clear();
+    flush();
+}
+
+template< typename T, size_t M > T* MagazinePool< T, M >::alloc()
+{
+    Cache& cache = _getCache();
+    if( cache.loaded->isEmpty( ))
+    {
+        if( !cache.previous->isEmpty( ))
+            std::swap( cache.loaded, cache.previous );
+        else if( !_exchangeFull( cache ))
+            return new T;
+    }
+    return cache.loaded->pop();
+}
+
+template< typename T, size_t M >
+void MagazinePool< T, M >::release( T* item )
+{
+    Cache& cache = _getCache();
+    if( cache.loaded->isFull( ))
+    {
+        if( cache.previous->isFull( ))
+            _exchangeEmpty( cache );
+        else
+            std::swap( cache.loaded, cache.previous );
+    }
+    cache.loaded->push( item );
+}
+
+template< typename T, size_t M > void MagazinePool< T, M >::flush()
+{
+    Cache* cache = static_cast< Cache* >( _cache.get( ));
+    if( cache )
+    {
+        cache->loaded->clear();
+        cache->previous->clear();
+    }
+
+    Magazines full;
+    Magazines empty;
+    {
+        ScopedFastWrite mutex( _lock );
+        _full.swap( full );
+        _empty.swap( empty );
+        _minFull = 0;
+    }
+    for( typename Magazines::const_iterator i = full.begin();
+         i != full.end(); ++i )
+    {
+        (*i)->clear();
+        delete *i;
+    }
+    for( typename Magazines::const_iterator i = empty.begin();
+         i != empty.end(); ++i )
+    {
+        delete *i;
+    }
+}
+
+template< typename T, size_t M > size_t MagazinePool< T, M >::trim()
+{
+    Magazines unused;
+    Magazines empty;
+    {
+        ScopedFastWrite mutex( _lock );
+        if( _minFull > 0 ) // the oldest magazines are the least recently used
+        {
+            const typename Magazines::iterator end = _full.begin() + _minFull;
+            Magazines( _full.begin(), end ).swap( unused );
+            _full.erase( _full.begin(), end );
+        }
+        _empty.swap( empty );
+        _minFull = _full.size();
+    }
+
+    size_t nItems = 0;
+    for( typename Magazines::const_iterator i = unused.begin();
+         i != unused.end(); ++i )
+    {
+        nItems += (*i)->size;
+        (*i)->clear();
+        delete *i;
+    }
+    for( typename Magazines::const_iterator i = empty.begin();
+         i != empty.end(); ++i )
+    {
+        delete *i;
+    }
+    return nItems;
+}
+
+template< typename T, size_t M >
+void MagazinePool< T, M >::setMaxCached( const size_t maxItems )
+{
+    {
+        ScopedFastWrite mutex( _lock );
+        _maxMagazines = maxItems / M;
+    }
+    _applyMaxCached();
+}
+
+template< typename T, size_t M > size_t MagazinePool< T, M >::getNCached() const
+{
+    ScopedFastRead mutex( _lock );
+    size_t nItems = 0;
+    for( typename Magazines::const_iterator i = _full.begin();
+         i != _full.end(); ++i )
+    {
+        nItems += (*i)->size;
+    }
+    return nItems;
+}
+
+template< typename T, size_t M >
+typename MagazinePool< T, M >::Cache& MagazinePool< T, M >::_getCache()
+{
+    Cache* cache = static_cast< Cache* >( _cache.get( ));
+    if( LB_UNLIKELY( cache == 0 ))
+    {
+        cache = new Cache( this );
+        _cache.set( cache );
+        ScopedFastWrite mutex( _lock );
+        _caches.push_back( cache );
+    }
+    return *cache;
+}
+
+template< typename T, size_t M >
+void MagazinePool< T, M >::_exchangeEmpty( Cache& cache )
+{
+    // both magazines are full: store the previous one in the depot
+    Magazine* full = cache.previous;
+    Magazine* empty = 0;
+    bool stored = false;
+    {
+        ScopedFastWrite mutex( _lock );
+        if( _full.size() < _maxMagazines )
+        {
+            _full.push_back( full );
+            stored = true;
+            if( !_empty.empty( ))
+            {
+                empty = _empty.back();
+                _empty.pop_back();
+            }
+        }
+    }
+
+    if( !stored ) // depot at its high-water mark, reuse the magazine
+    {
+        full->clear();
+        empty = full;
+    }
+    else if( !empty )
+        empty = new Magazine;
+
+    cache.previous = cache.loaded;
+    cache.loaded = empty;
+}
+
+template< typename T, size_t M >
+bool MagazinePool< T, M >::_exchangeFull( Cache& cache )
+{
+    // both magazines are empty: replace the previous one from the depot
+    ScopedFastWrite mutex( _lock );
+    if( _full.empty( ))
+        return false;
+
+    _empty.push_back( cache.previous );
+    cache.previous = cache.loaded;
+    cache.loaded = _full.back();
+    _full.pop_back();
+    _minFull = std::min( _minFull, _full.size( ));
+    return true;
+}
+
+template< typename T, size_t M > void MagazinePool< T, M >::_applyMaxCached()
+{
+    Magazines excess;
+    {
+        ScopedFastWrite mutex( _lock );
+        if( _full.size() <= _maxMagazines )
+            return;
+        Magazines( _full.begin() + _maxMagazines, _full.end( )).swap( excess );
+        _full.resize( _maxMagazines );
+        _minFull = std::min( _minFull, _full.size( ));
+    }
+    for( typename Magazines::const_iterator i = excess.begin();
+         i != excess.end(); ++i )
+    {
+        (*i)->clear();
+        delete *i;
+    }
+}
+
+template< typename T, size_t M >
+void MagazinePool< T, M >::_exitThread( void* data )
+{
+    Cache* cache = static_cast< Cache* >( data );
+    MagazinePool* pool = cache->pool;
+    Magazine* magazines[] = { cache->loaded, cache->previous };
+    {
+        ScopedFastWrite mutex( pool->_lock );
+        pool->_caches.erase( std::find( pool->_caches.begin(),
+                                        pool->_caches.end(), cache ));
+        for( size_t i = 0; i < 2; ++i )
+        {
+            if( magazines[i]->isEmpty( ))
+                pool->_empty.push_back( magazines[i] );
+            else
+                pool->_full.push_back( magazines[i] );
+        }
+    }
+    delete cache;
+    pool->_applyMaxCached();
+}
+}
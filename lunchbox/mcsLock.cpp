@@ -0,0 +1,173 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "mcsLock.h"
+
+#include "perThread.h"
+#include "thread.h"
+
+// Pause rounds before a waiting thread yields
+#define LB_MCSLOCK_SPINS 1024
+
+namespace lunchbox
+{
+namespace detail
+{
+/** A queue entry, owned by one thread while it waits for or holds a lock. */
+struct MCSNode
+{
+    MCSNode() : next( 0 ), waiting( 0 ), free( 0 ) {}
+
+    MCSNode* next; // the successor in the lock queue
+    int32_t waiting; // cleared by the predecessor on release
+    MCSNode* free; // the next unused node of the thread
+    char pad[ LB_CACHELINE_SIZE ]; // each thread spins on its own node
+};
+
+/** The unused nodes of one thread. */
+struct MCSNodes
+{
+    MCSNodes() : free( 0 ) {}
+    MCSNode* free;
+};
+
+void deleteMCSNodes( MCSNodes* nodes )
+{
+    while( nodes->free )
+    {
+        MCSNode* node = nodes->free;
+        nodes->free = node->free;
+        delete node;
+    }
+    delete nodes;
+}
+}
+
+namespace
+{
+lunchbox::PerThread< detail::MCSNodes, detail::deleteMCSNodes > _nodes;
+
+detail::MCSNode* _getNode()
+{
+    detail::MCSNodes* nodes = _nodes.get();
+    if( !nodes )
+    {
+        nodes = new detail::MCSNodes;
+        _nodes = nodes;
+    }
+
+    detail::MCSNode* node = nodes->free;
+    if( !node )
+        return new detail::MCSNode;
+
+    nodes->free = node->free;
+    node->next = 0;
+    return node;
+}
+
+void _releaseNode( detail::MCSNode* node )
+{
+    detail::MCSNodes* nodes = _nodes.get();
+    if( !nodes )
+    {
+        nodes = new detail::MCSNodes;
+        _nodes = nodes;
+    }
+    node->free = nodes->free;
+    nodes->free = node;
+}
+}
+
+MCSLock::~MCSLock()
+{
+    if( _tail ) // destroyed while set, recycle the owner's node
+        unset();
+}
+
+void MCSLock::set()
+{
+    detail::MCSNode* node = _getNode();
+    node->waiting = 1;
+
+    void** tail = reinterpret_cast< void** >( &_tail );
+    detail::MCSNode* predecessor = 0;
+    do
+        predecessor = Atomic< detail::MCSNode* >::loadAcquire( _tail );
+    while( !Atomic< void* >::compareAndSwap( tail, predecessor, node ));
+
+    if( predecessor )
+    {
+        Atomic< detail::MCSNode* >::storeRelease( predecessor->next, node );
+        for( uint32_t i = 0; Atomic< int32_t >::loadAcquire( node->waiting );
+             ++i )
+        {
+            if( i < LB_MCSLOCK_SPINS )
+                spinPause();
+            else
+                Thread::yield();
+        }
+    }
+    _owner = node;
+}
+
+void MCSLock::unset()
+{
+    LBASSERT( isSet( ));
+    detail::MCSNode* node = _owner;
+    detail::MCSNode* next = Atomic< detail::MCSNode* >::loadAcquire(
+        node->next );
+    if( !next )
+    {
+        void** tail = reinterpret_cast< void** >( &_tail );
+        if( Atomic< void* >::compareAndSwap( tail, node, 0 ))
+        {
+            _releaseNode( node );
+            return;
+        }
+
+        // a thread is enqueueing, wait for it to link itself
+        for( uint32_t i = 0;
+             !( next = Atomic< detail::MCSNode* >::loadAcquire( node->next ));
+             ++i )
+        {
+            if( i < LB_MCSLOCK_SPINS )
+                spinPause();
+            else
+                Thread::yield();
+        }
+    }
+
+    Atomic< int32_t >::storeRelease( next->waiting, 0 );
+    _releaseNode( node );
+}
+
+bool MCSLock::trySet()
+{
+    if( Atomic< detail::MCSNode* >::loadAcquire( _tail ))
+        return false;
+
+    detail::MCSNode* node = _getNode();
+    void** tail = reinterpret_cast< void** >( &_tail );
+    if( !Atomic< void* >::compareAndSwap( tail, 0, node ))
+    {
+        _releaseNode( node );
+        return false;
+    }
+    _owner = node;
+    return true;
+}
+}
@@ -0,0 +1,86 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_MCSLOCK_H
+#define LUNCHBOX_MCSLOCK_H
+
+#include <lunchbox/api.h>
+#include <lunchbox/atomic.h>         // used in inline method
+#include <lunchbox/debug.h>          // used in inline method
+#include <boost/noncopyable.hpp>
+
+namespace lunchbox
+{
+namespace detail { struct MCSNode; }
+
+/**
+ * A fair queue lock after Mellor-Crummey and Scott.
+ *
+ * Waiting threads form a linked queue of per-thread nodes. Each thread spins on
+ * a flag in its own node, which its predecessor clears when releasing the lock.
+ * The lock is granted in request order, and a release only invalidates the
+ * cache line of the next waiting thread. This makes the lock scale best of all
+ * spin locks under high contention on many cores, at the cost of a slower
+ * uncontended path than SpinLock or TicketLock.
+ *
+ * The nodes are taken from a thread-local cache. A thread may hold any number
+ * of MCSLocks at the same time. Waiting threads yield their time slice after
+ * spinning for a while. Like for TicketLock, the throughput drops sharply if
+ * more threads than cores wait on the lock.
+ *
+ * @sa ScopedMutex, TicketLock
+ *
+ * Example: @include tests/lock.cpp
+ */
+class MCSLock : public boost::noncopyable
+{
+public:
+    /** Construct a new lock. @version 1.9.2 */
+    MCSLock() : _tail( 0 ), _owner( 0 ) {}
+
+    /** Destruct the lock. @version 1.9.2 */
+    LUNCHBOX_API ~MCSLock();
+
+    /** Acquire the lock. @version 1.9.2 */
+    LUNCHBOX_API void set();
+
+    /** Release the lock. @version 1.9.2 */
+    LUNCHBOX_API void unset();
+
+    /**
+     * Attempt to acquire the lock.
+     *
+     * @return true if the lock was set, false if it was not set.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API bool trySet();
+
+    /**
+     * Test if the lock is set.
+     *
+     * @return true if the lock is set, false if it is not set.
+     * @version 1.9.2
+     */
+    bool isSet()
+        { return Atomic< detail::MCSNode* >::loadAcquire( _tail ) != 0; }
+
+private:
+    detail::MCSNode* _tail; // the last thread in the queue
+    detail::MCSNode* _owner; // the node of the owner, used in unset
+};
+}
+#endif // LUNCHBOX_MCSLOCK_H
@@ -19,9 +19,15 @@
 #ifndef LUNCHBOX_MONITOR_H
 #define LUNCHBOX_MONITOR_H
 
-#include <lunchbox/condition.h>   // member
-#include <lunchbox/scopedMutex.h> // used inline
+#include <lunchbox/atomic.h>      // used inline
+#include <lunchbox/clock.h>       // used inline
+#include <lunchbox/futex.h>       // used inline
+#include <lunchbox/scopedMutex.h>
+#include <lunchbox/seqLock.h>     // member
+#include <lunchbox/thread.h>      // used inline
 #include <lunchbox/types.h>
+#include <lunchbox/waitPolicy.h>  // member
+#include <boost/type_traits/has_trivial_copy.hpp>
 
 #include <errno.h>
 #include <string.h>
@@ -37,6 +43,15 @@ namespace lunchbox
  * caller is blocked until the condition is fulfilled. The concept is similar to
  * a pthread condition, with more usage convenience.
  *
+ * The value is protected by a SeqLock. Reads of trivially copyable values
+ * wider than eight bytes are optimistic and do not contend with each other.
+ * Values of other types are copied while holding off writers, since copying
+ * them during a concurrent modification is undefined. Updates only wake
+ * threads if any are blocked. Blocked threads wait on an update counter using
+ * futexWait(), so neither side makes a system call unless a thread has to
+ * block. Waiting threads may spin and yield before blocking, configured by a
+ * WaitPolicy.
+ *
  * Example: @include tests/monitor.cpp
  */
 template< class T > class Monitor
@@ -46,13 +61,16 @@ template< class T > class Monitor
 
 public:
     /** Construct a new monitor with a default value of 0. @version 1.0 */
-    Monitor() : _value( T( 0 )) {}
+    Monitor() : _value( T( 0 )), _updates( 0 ), _nWaiting( 0 ) {}
 
     /** Construct a new monitor with a given default value. @version 1.0 */
-    explicit Monitor( const T& value ) : _value( value ) {}
+    explicit Monitor( const T& value )
+        : _value( value ), _updates( 0 ), _nWaiting( 0 ) {}
 
     /** Ctor initializing with the given monitor value. @version 1.1.5 */
-    Monitor( const Monitor< T >& from ) : _value( from._value ) {}
+    Monitor( const Monitor< T >& from )
+        : _value( from._get( )), _policy( from._policy ), _updates( 0 )
+        , _nWaiting( 0 ) {}
 
     /** Destructs the monitor. @version 1.0 */
     ~Monitor() {}
@@ -62,18 +80,16 @@ public:
     /** Increment the monitored value, prefix only. @version 1.0 */
     Monitor& operator++ ()
         {
-            ScopedCondition mutex( _cond );
-            ++_value;
-            _cond.broadcast();
+            ++_value.beginWrite();
+            _endWrite();
             return *this;
         }
 
     /** Decrement the monitored value, prefix only. @version 1.0 */
     Monitor& operator-- ()
         {
-            ScopedCondition mutex( _cond );
-            --_value;
-            _cond.broadcast();
+            --_value.beginWrite();
+            _endWrite();
             return *this;
         }
 
@@ -87,37 +103,54 @@ public:
     /** Assign a new value. @version 1.1.5 */
     const Monitor& operator = ( const Monitor< T >& from )
         {
-            set( from._value );
+            set( from._get( ));
             return *this;
         }
 
     /** Perform an or operation on the value. @version 1.0 */
     Monitor& operator |= ( const T& value )
         {
-            ScopedCondition mutex( _cond );
-            _value |= value;
-            _cond.broadcast();
+            _value.beginWrite() |= value;
+            _endWrite();
             return *this;
         }
 
     /** Perform an and operation on the value. @version 1.7 */
     Monitor& operator &= ( const T& value )
         {
-            ScopedCondition mutex( _cond );
-            _value &= value;
-            _cond.broadcast();
+            _value.beginWrite() &= value;
+            _endWrite();
             return *this;
         }
 
     /** Set a new value. @version 1.0 */
     void set( const T& value )
         {
-            ScopedCondition mutex( _cond );
-            _value = value;
-            _cond.broadcast();
+            _value.beginWrite() = value;
+            _endWrite();
         }
     //@}
 
+    /** @name Waiting policy. */
+    //@{
+    /**
+     * Set how threads wait for the value.
+     *
+     * Not thread-safe with respect to waiting threads.
+     * @version 1.9.2
+     */
+    void setWaitPolicy( const WaitPolicy& policy ) { _policy = policy; }
+
+    /** @return the policy used by waiting threads. @version 1.9.2 */
+    const WaitPolicy& getWaitPolicy() const { return _policy; }
+
+    /** @return the phases in which waits were satisfied. @version 1.9.2 */
+    WaitStats getWaitStats() const { return _stats.snapshot(); }
+
+    /** Reset the wait statistics, not thread-safe. @version 1.9.2 */
+    void resetWaitStats() { _stats = WaitStats(); }
+    //@}
+
     /** @name Monitor the value. */
     //@{
     /**
@@ -127,11 +160,11 @@ public:
      */
     const T& waitEQ( const T& value ) const
         {
-            if( sizeof( T ) <= 8 && _value == value )
+            if( _get() == value )
                 return value;
-            ScopedCondition mutex( _cond );
-            while( _value != value )
-                _cond.wait();
+            Waiter waiter( *this );
+            while( waiter.get() != value )
+                waiter.wait();
             return value;
         }
 
@@ -142,16 +175,17 @@ public:
      */
     const T waitNE( const T& value ) const
         {
-            if( sizeof( T ) <= 8 ) // issue #1
+            const T initial = _get();
+            if( initial != value )
+                return initial;
+            Waiter waiter( *this );
+            T current = waiter.get();
+            while( current == value )
             {
-                const T current = _value;
-                if( current != value )
-                    return current;
+                waiter.wait();
+                current = waiter.get();
             }
-            ScopedCondition mutex( _cond );
-            while( _value == value )
-                _cond.wait();
-            return _value;
+            return current;
         }
 
     /**
@@ -161,16 +195,17 @@ public:
      */
     const T waitNE( const T& v1, const T& v2 ) const
         {
-            if( sizeof( T ) <= 8 ) // issue #1
+            const T initial = _get();
+            if( initial != v1 && initial != v2 )
+                return initial;
+            Waiter waiter( *this );
+            T current = waiter.get();
+            while( current == v1 || current == v2 )
             {
-                const T current = _value;
-                if( current != v1 && current != v2 )
-                    return current;
+                waiter.wait();
+                current = waiter.get();
             }
-            ScopedCondition mutex( _cond );
-            while( _value == v1 || _value == v2 )
-                _cond.wait();
-            return _value;
+            return current;
         }
 
     /**
@@ -180,16 +215,17 @@ public:
      */
     const T waitGE( const T& value ) const
         {
-            if( sizeof( T ) <= 8 ) // issue #1
+            const T initial = _get();
+            if( initial >= value )
+                return initial;
+            Waiter waiter( *this );
+            T current = waiter.get();
+            while( current < value )
             {
-                const T current = _value;
-                if( current >= value )
-                    return current;
+                waiter.wait();
+                current = waiter.get();
             }
-            ScopedCondition mutex( _cond );
-            while( _value < value )
-                _cond.wait();
-            return _value;
+            return current;
         }
     /**
      * Block until the monitor has a value less or equal to the given value.
@@ -198,16 +234,17 @@ public:
      */
     const T waitLE( const T& value ) const
         {
-            if( sizeof( T ) <= 8 ) // issue #1
+            const T initial = _get();
+            if( initial <= value )
+                return initial;
+            Waiter waiter( *this );
+            T current = waiter.get();
+            while( current > value )
             {
-                const T current = _value;
-                if( current <= value )
-                    return current;
+                waiter.wait();
+                current = waiter.get();
             }
-            ScopedCondition mutex( _cond );
-            while( _value > value )
-                _cond.wait();
-            return _value;
+            return current;
         }
 
     /** @name Monitor the value with a timeout. */
@@ -221,16 +258,14 @@ public:
      */
     bool timedWaitEQ( const T& value, const uint32_t timeout ) const
         {
-            if( sizeof( T ) <= 8 && _value == value )
+            if( _get() == value )
                 return true;
 
-            ScopedCondition mutex( _cond );
-            while( _value != value )
+            Waiter waiter( *this, timeout );
+            while( waiter.get() != value )
             {
-                if( !_cond.timedWait( timeout ) )
-                {
+                if( !waiter.wait( ))
                     return false;
-                }
             }
             return true;
         }
@@ -244,16 +279,14 @@ public:
      */
     bool timedWaitGE( const T& value, const uint32_t timeout ) const
         {
-            if( sizeof( T ) <= 8 && _value >= value )
+            if( _get() >= value )
                 return true;
 
-            ScopedCondition mutex( _cond );
-            while( _value < value )
+            Waiter waiter( *this, timeout );
+            while( waiter.get() < value )
             {
-                if ( !_cond.timedWait( timeout ) )
-                {
+                if( !waiter.wait( ))
                     return false;
-                }
             }
             return true;
         }
@@ -267,16 +300,14 @@ public:
      */
     bool timedWaitNE( const T& value, const uint32_t timeout ) const
         {
-            if( sizeof( T ) <= 8 && _value != value )
+            if( _get() != value )
                 return true;
 
-            ScopedCondition mutex( _cond );
-            while( _value == value )
+            Waiter waiter( *this, timeout );
+            while( waiter.get() == value )
             {
-                if( !_cond.timedWait( timeout ) )
-                {
+                if( !waiter.wait( ))
                     return false;
-                }
             }
             return true;
         }
@@ -285,107 +316,220 @@ public:
     /** @name Comparison Operators. @version 1.0 */
     //@{
     bool operator == ( const T& value ) const
-        {
-            ScopedCondition mutex( sizeof(T)>8 ? &_cond : 0 ); // issue #1
-            return _value == value;
-        }
+        { return _get() == value; }
     bool operator != ( const T& value ) const
-        {
-            ScopedCondition mutex( sizeof(T)>8 ? &_cond : 0 ); // issue #1
-            return _value != value;
-        }
+        { return _get() != value; }
     bool operator < ( const T& value ) const
-        {
-            ScopedCondition mutex( sizeof(T)>8 ? &_cond : 0 ); // issue #1
-            return _value < value;
-        }
+        { return _get() < value; }
     bool operator > ( const T& value ) const
-        {
-            ScopedCondition mutex( sizeof(T)>8 ? &_cond : 0 ); // issue #1
-            return _value > value;
-        }
+        { return _get() > value; }
     bool operator <= ( const T& value ) const
-        {
-            ScopedCondition mutex( sizeof(T)>8 ? &_cond : 0 ); // issue #1
-            return _value <= value;
-        }
+        { return _get() <= value; }
     bool operator >= ( const T& value ) const
-        {
-            ScopedCondition mutex( sizeof(T)>8 ? &_cond : 0 ); // issue #1
-            return _value >= value;
-        }
+        { return _get() >= value; }
 
     bool operator == ( const Monitor<T>& rhs ) const
-        {
-            ScopedCondition mutex( sizeof(T)>8 ? &_cond : 0 ); // issue #1
-            return _value == rhs._value;
-        }
+        { return _get() == rhs._get(); }
     bool operator != ( const Monitor<T>& rhs ) const
-        {
-            ScopedCondition mutex( sizeof(T)>8 ? &_cond : 0 ); // issue #1
-            return _value != rhs._value;
-        }
+        { return _get() != rhs._get(); }
     bool operator < ( const Monitor<T>& rhs ) const
-        {
-            ScopedCondition mutex( sizeof(T)>8 ? &_cond : 0 ); // issue #1
-            return _value < rhs._value;
-        }
+        { return _get() < rhs._get(); }
     bool operator > ( const Monitor<T>& rhs ) const
-        {
-            ScopedCondition mutex( sizeof(T)>8 ? &_cond : 0 ); // issue #1
-            return _value > rhs._value;
-        }
+        { return _get() > rhs._get(); }
     bool operator <= ( const Monitor<T>& rhs ) const
-        {
-            ScopedCondition mutex( sizeof(T)>8 ? &_cond : 0 ); // issue #1
-            return _value <= rhs._value;
-        }
+        { return _get() <= rhs._get(); }
     bool operator >= ( const Monitor<T>& rhs ) const
-        {
-            ScopedCondition mutex( sizeof(T)>8 ? &_cond : 0 ); // issue #1
-            return _value >= rhs._value;
-        }
+        { return _get() >= rhs._get(); }
     /** @return a bool conversion of the result. @version 1.9.1 */
     operator bool_t()
-        {
-            ScopedCondition mutex( sizeof(T)>8 ? &_cond : 0 ); // issue #1
-            return _value ? &Monitor< T >::bool_true : 0;
-        }
+        { return _get() ? &Monitor< T >::bool_true : 0; }
     //@}
 
     /** @name Data Access. */
     //@{
     /** @return the current value. @version 1.0 */
-    const T& operator->() const { return _value; }
+    const T& operator->() const { return _value.getUnsynchronized(); }
 
-    /** @return the current value. @version 1.0 */
-    const T& get() const { return _value; }
+    /**
+     * @return the current value, not synchronized with concurrent updates of
+     *         values wider than eight bytes or not trivially copyable.
+     * @version 1.0
+     */
+    const T& get() const { return _value.getUnsynchronized(); }
 
     /** @return the current plus the given value. @version 1.0 */
     T operator + ( const T& value ) const
-        {
-            ScopedCondition mutex( sizeof(T)>8 ? &_cond : 0 ); // issue #1
-            return _value + value;
-        }
+        { return _get() + value; }
 
     /** @return the current or'ed with the given value. @version 1.0 */
     T operator | ( const T& value ) const
-        {
-            ScopedCondition mutex( sizeof(T)>8 ? &_cond : 0 ); // issue #1
-            return static_cast< T >( _value | value );
-        }
+        { return static_cast< T >( _get() | value ); }
 
     /** @return the current and the given value. @version 1.0 */
     T operator & ( const T& value ) const
-        {
-            ScopedCondition mutex( sizeof(T)>8 ? &_cond : 0 ); // issue #1
-            return static_cast< T >( _value & value );
-        }
+        { return static_cast< T >( _get() & value ); }
     //@}
 
 private:
-    T _value;
-    mutable Condition _cond;
+    SeqLock< T > _value;
+    WaitPolicy _policy;
+    mutable WaitStats _stats;
+    mutable int32_t _updates; // incremented by each update, waited on
+    mutable int32_t _nWaiting; // number of threads about to block
+
+    /** @return a consistent copy of the value. */
+    T _get() const { return _get( boost::has_trivial_copy< T >( )); }
+
+    T _get( const boost::true_type& ) const
+        {
+            // machine words are read atomically
+            return sizeof( T ) > 8 ? _value.get() : _value.getUnsynchronized();
+        }
+
+    T _get( const boost::false_type& ) const { return _value.getLocked(); }
+
+    /** Publish the updated value and wake all waiting threads. */
+    void _endWrite()
+        {
+            // Full barrier, orders the update before the waiter check. Pairs
+            // with a Waiter registering before reading the update counter.
+            Atomic< int32_t >::incAndGet( _updates );
+            _value.endWrite();
+            if( Atomic< int32_t >::loadAcquire( _nWaiting ) > 0 )
+                futexWakeAll( &_updates );
+        }
+
+    /**
+     * A thread waiting for an update, with optional timeout. Spins, yields and
+     * finally blocks according to the wait policy.
+     */
+    class Waiter
+    {
+    public:
+        explicit Waiter( const Monitor< T >& owner,
+                         const uint32_t timeout = LB_TIMEOUT_INDEFINITE )
+            : _monitor( owner )
+            , _clock( timeout == LB_TIMEOUT_INDEFINITE ? 0 : new Clock )
+            , _timeout( timeout == LB_TIMEOUT_DEFAULT ? 300000 /* 5 min */ :
+                                                        timeout )
+            , _updates( 0 )
+            , _round( 0 )
+            , _phase( PHASE_NONE )
+            , _registered( false )
+        {}
+
+        ~Waiter()
+        {
+            delete _clock;
+            if( _registered )
+                Atomic< int32_t >::decAndGet( _monitor._nWaiting );
+
+            WaitStats& stats = _monitor._stats;
+            switch( _phase )
+            {
+            case PHASE_NONE: // satisfied before waiting
+                break;
+            case PHASE_SPIN:
+                Atomic< ssize_t >::getAndAdd( stats.spun, 1, ORDER_RELAXED );
+                break;
+            case PHASE_YIELD:
+                Atomic< ssize_t >::getAndAdd( stats.yielded, 1,
+                                              ORDER_RELAXED );
+                break;
+            case PHASE_BLOCK:
+                Atomic< ssize_t >::getAndAdd( stats.blocked, 1,
+                                              ORDER_RELAXED );
+                break;
+            case PHASE_TIMEOUT:
+                Atomic< ssize_t >::getAndAdd( stats.timedOut, 1,
+                                              ORDER_RELAXED );
+                break;
+            }
+        }
+
+        /** @return the current value, remembering the update counter. */
+        T get()
+        {
+            _updates = Atomic< int32_t >::loadAcquire( _monitor._updates );
+            return _monitor._get();
+        }
+
+        /**
+         * Wait for an update, the caller has to get() the value again.
+         * @return false on timeout.
+         */
+        bool wait()
+        {
+            const WaitPolicy& policy = _monitor._policy;
+            if( _round < policy.nSpins )
+            {
+                ++_round;
+                _phase = PHASE_SPIN;
+                spinPause();
+                return true;
+            }
+
+            const int64_t elapsed = _clock ? _clock->getTime64() : 0;
+            if( elapsed >= int64_t( _timeout ))
+            {
+                _phase = PHASE_TIMEOUT;
+                return false;
+            }
+
+            if( _round < policy.nSpins + policy.nYields )
+            {
+                ++_round;
+                _phase = PHASE_YIELD;
+                Thread::yield();
+                return true;
+            }
+
+            if( !_registered )
+            {
+                // Updates wake blocked threads from now on, but an update
+                // might have been missed before: get() the value once more.
+                // Does not wait, a wait satisfied by the recheck is counted
+                // in the phase of the previous wait.
+                _registered = true;
+                Atomic< int32_t >::incAndGet( _monitor._nWaiting );
+                return true;
+            }
+
+            ++_round;
+            _phase = PHASE_BLOCK;
+            if( _timeout == LB_TIMEOUT_INDEFINITE )
+            {
+                futexWait( &_monitor._updates, _updates );
+                return true;
+            }
+            if( futexWait( &_monitor._updates, _updates,
+                           uint32_t( _timeout - elapsed )))
+            {
+                return true;
+            }
+            _phase = PHASE_TIMEOUT;
+            return false;
+        }
+
+    private:
+        /** The phase of the last wait, counted in the WaitStats. */
+        enum Phase
+        {
+            PHASE_NONE,
+            PHASE_SPIN,
+            PHASE_YIELD,
+            PHASE_BLOCK,
+            PHASE_TIMEOUT
+        };
+
+        const Monitor< T >& _monitor;
+        const Clock* const _clock; // only for timed waits
+        const uint32_t _timeout;
+        int32_t _updates;
+        uint32_t _round;
+        Phase _phase;
+        bool _registered;
+    };
 };
 
 typedef Monitor< bool >     Monitorb; //!< A boolean monitor variable
@@ -402,19 +546,19 @@ inline std::ostream& operator << ( std::ostream& os,
 
 template<> inline Monitor< bool >& Monitor< bool >::operator++ ()
 {
-    ScopedCondition mutex( _cond );
-    assert( !_value );
-    _value = !_value;
-    _cond.broadcast();
+    bool& value = _value.beginWrite();
+    assert( !value );
+    value = !value;
+    _endWrite();
     return *this;
 }
 
 template<> inline Monitor< bool >& Monitor< bool >::operator-- ()
 {
-    ScopedCondition mutex( _cond );
-    assert( !_value );
-    _value = !_value;
-    _cond.broadcast();
+    bool& value = _value.beginWrite();
+    assert( !value );
+    value = !value;
+    _endWrite();
     return *this;
 }
 
@@ -423,9 +567,8 @@ Monitor< bool >& Monitor< bool >::operator |= ( const bool& value )
 {
     if( value )
     {
-        ScopedCondition mutex( _cond );
-        _value = value;
-        _cond.broadcast();
+        _value.beginWrite() = value;
+        _endWrite();
     }
     return *this;
 }
@@ -434,7 +577,8 @@ Monitor< bool >& Monitor< bool >::operator |= ( const bool& value )
 #include <lunchbox/uint128_t.h>
 namespace lunchbox
 {
-template<> inline Monitor< uint128_t >::Monitor() {}
+template<> inline Monitor< uint128_t >::Monitor()
+    : _value(), _updates( 0 ), _nWaiting( 0 ) {}
 }
 
 #endif //LUNCHBOX_MONITOR_H
@@ -0,0 +1,167 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_MPMCQUEUE_H
+#define LUNCHBOX_MPMCQUEUE_H
+
+#include <lunchbox/atomic.h>       // member
+#include <lunchbox/bitOperation.h> // used inline
+#include <lunchbox/clock.h>        // used inline
+#include <lunchbox/condition.h>    // member
+#include <lunchbox/debug.h>        // used in inline method
+
+#include <vector>
+
+namespace lunchbox
+{
+/**
+ * A thread-safe, lock-free queue for multiple readers and writers.
+ *
+ * Each slot of the ring buffer carries a sequence number, which tells readers
+ * and writers if the slot is ready for them. Readers and writers claim a slot
+ * by a compare-and-swap on the read or write position, which are placed on
+ * separate cache lines.
+ *
+ * Current implementation constraints:
+ * * Fixed maximum size, rounded up to a power of two (writes may fail)
+ * * Elements have to be default-constructible and assignable
+ * * Popped elements are moved out of the queue if supported by the compiler
+ * * Not copyable
+ *
+ * The blocking pop() and timedPop() spin briefly on the queue before they
+ * park on a condition variable. Writers only take the condition lock if a
+ * reader is parked.
+ *
+ * Example: @include tests/mpmcQueue.cpp
+ */
+template< typename T > class MPMCQueue : public boost::noncopyable
+{
+public:
+    typedef T value_type;
+
+    /** Construct a new queue of at least the given size. @version 1.9.2 */
+    explicit MPMCQueue( const size_t size );
+
+    /** Destruct this queue. @version 1.9.2 */
+    ~MPMCQueue() {}
+
+    /**
+     * @return true if the queue is empty, false otherwise. The result is a
+     *         snapshot when used concurrently.
+     * @version 1.9.2
+     */
+    bool isEmpty() const { return _readPos == _writePos; }
+
+    /**
+     * @return the number of elements in the queue. The result is a snapshot
+     *         when used concurrently.
+     * @version 1.9.2
+     */
+    size_t getSize() const;
+
+    /**
+     * Retrieve and pop the front element from the queue.
+     *
+     * @param result the front value or unmodified
+     * @return true if an element was placed in result, false if the queue
+     *         is empty.
+     * @version 1.9.2
+     */
+    bool pop( T& result );
+
+    /**
+     * Retrieve and pop the front element from the queue, may block.
+     * @version 1.9.2
+     */
+    T pop();
+
+    /**
+     * Retrieve and pop the front element from the queue, may block.
+     *
+     * @param timeout the timeout in milliseconds to wait for an update of
+     *                the queue, or LB_TIMEOUT_INDEFINITE.
+     * @param result the element returned
+     * @return true if an element was popped, false on timeout.
+     * @version 1.9.2
+     */
+    bool timedPop( const uint32_t timeout, T& result );
+
+    /**
+     * Push a new element to the back of the queue.
+     *
+     * @param element the element to add.
+     * @return true if the element was placed, false if the queue is full
+     * @version 1.9.2
+     */
+    bool push( const T& element );
+
+#ifdef LB_MOVE_SEMANTICS
+    /**
+     * Move a new element to the back of the queue.
+     *
+     * The element is left untouched if the queue is full.
+     * @param element the element to add.
+     * @return true if the element was placed, false if the queue is full
+     * @version 1.9.2
+     */
+    bool push( T&& element );
+
+    /**
+     * Construct a new element at the back of the queue.
+     *
+     * @param args the arguments passed to the constructor of the element.
+     * @return true if the element was placed, false if the queue is full
+     * @version 1.9.2
+     */
+    template< class... Args > bool emplace( Args&&... args );
+#endif
+
+    /**
+     * @return the maximum number of elements held by the queue.
+     * @version 1.9.2
+     */
+    size_t getCapacity() const { return _cells.size(); }
+
+private:
+    struct Cell
+    {
+        Cell() : sequence( 0 ) {}
+        ssize_t sequence;
+        T data;
+    };
+
+    std::vector< Cell > _cells;
+    const ssize_t _mask;
+
+    char _pad0[ LB_CACHELINE_SIZE ];
+    a_ssize_t _writePos;
+    char _pad1[ LB_CACHELINE_SIZE ];
+    a_ssize_t _readPos;
+    char _pad2[ LB_CACHELINE_SIZE ];
+
+    a_int32_t _waiting;
+    Condition _condition;
+
+    static size_t _getRingSize( const size_t size );
+    Cell* _claimWrite( ssize_t& pos );
+    void _commitWrite( Cell* cell, const ssize_t pos );
+};
+}
+
+#include "mpmcQueue.ipp" // template implementation
+
+#endif // LUNCHBOX_MPMCQUEUE_H
@@ -0,0 +1,201 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+namespace lunchbox
+{
+template< typename T >
+MPMCQueue< T >::MPMCQueue( const size_t size )
+    : _cells( _getRingSize( size ))
+    , _mask( _cells.size() - 1 )
+    , _writePos( 0 )
+    , _readPos( 0 )
+    , _waiting( 0 )
+    , _condition( "lunchbox::MPMCQueue" )
+{
+    for( size_t i = 0; i < _cells.size(); ++i )
+        _cells[ i ].sequence = i;
+    memoryBarrier();
+}
+
+template< typename T >
+size_t MPMCQueue< T >::_getRingSize( const size_t size )
+{
+    LBASSERT( size > 0 );
+    if( size <= 1 )
+        return 2;
+    if(( size & ( size - 1 )) == 0 )
+        return size;
+    return size_t( 1 ) << ( getIndexOfLastBit( uint64_t( size )) + 1 );
+}
+
+template< typename T > size_t MPMCQueue< T >::getSize() const
+{
+    const ssize_t readPos = _readPos;
+    const ssize_t writePos = _writePos;
+    return writePos > readPos ? writePos - readPos : 0;
+}
+
+template< typename T >
+typename MPMCQueue< T >::Cell* MPMCQueue< T >::_claimWrite( ssize_t& pos )
+{
+    pos = _writePos;
+    while( true )
+    {
+        Cell* cell = &_cells[ pos & _mask ];
+        const ssize_t sequence = Atomic< ssize_t >::loadAcquire(
+                                                               cell->sequence );
+        const ssize_t diff = sequence - pos;
+
+        if( diff == 0 ) // slot is free, claim it
+        {
+            if( _writePos.compareAndSwap( pos, pos + 1 ))
+                return cell;
+            pos = _writePos;
+        }
+        else if( diff < 0 ) // slot not yet read: full
+            return 0;
+        else // another writer claimed it
+            pos = _writePos;
+    }
+}
+
+template< typename T >
+void MPMCQueue< T >::_commitWrite( Cell* cell, const ssize_t pos )
+{
+    Atomic< ssize_t >::storeRelease( cell->sequence, pos + 1 );
+
+    // Full barrier between the sequence store and the _waiting load pairs with
+    // the one in timedPop() to not miss a waiter parking concurrently.
+    memoryBarrier();
+    if( _waiting > 0 )
+    {
+        _condition.lock();
+        _condition.signal();
+        _condition.unlock();
+    }
+}
+
+template< typename T > bool MPMCQueue< T >::push( const T& element )
+{
+    ssize_t pos;
+    Cell* cell = _claimWrite( pos );
+    if( !cell )
+        return false;
+
+    cell->data = element;
+    _commitWrite( cell, pos );
+    return true;
+}
+
+#ifdef LB_MOVE_SEMANTICS
+template< typename T > bool MPMCQueue< T >::push( T&& element )
+{
+    ssize_t pos;
+    Cell* cell = _claimWrite( pos );
+    if( !cell )
+        return false;
+
+    cell->data = std::move( element );
+    _commitWrite( cell, pos );
+    return true;
+}
+
+template< typename T > template< class... Args >
+bool MPMCQueue< T >::emplace( Args&&... args )
+{
+    ssize_t pos;
+    Cell* cell = _claimWrite( pos );
+    if( !cell )
+        return false;
+
+    cell->data = T( std::forward< Args >( args )... );
+    _commitWrite( cell, pos );
+    return true;
+}
+#endif
+
+template< typename T > bool MPMCQueue< T >::pop( T& result )
+{
+    ssize_t pos = _readPos;
+    Cell* cell;
+    while( true )
+    {
+        cell = &_cells[ pos & _mask ];
+        const ssize_t sequence = Atomic< ssize_t >::loadAcquire(
+                                                               cell->sequence );
+        const ssize_t diff = sequence - ( pos + 1 );
+
+        if( diff == 0 ) // slot is written, claim it
+        {
+            if( _readPos.compareAndSwap( pos, pos + 1 ))
+                break;
+            pos = _readPos;
+        }
+        else if( diff < 0 ) // slot not yet written: empty
+            return false;
+        else // another reader claimed it
+            pos = _readPos;
+    }
+
+    result = LB_MOVE( cell->data );
+    Atomic< ssize_t >::storeRelease( cell->sequence, pos + _mask + 1 );
+    return true;
+}
+
+template< typename T > T MPMCQueue< T >::pop()
+{
+    T element;
+    timedPop( LB_TIMEOUT_INDEFINITE, element );
+    return element;
+}
+
+template< typename T >
+bool MPMCQueue< T >::timedPop( const uint32_t timeout, T& result )
+{
+    static const size_t spinCount = 1024;
+    for( size_t i = 0; i < spinCount; ++i )
+    {
+        if( pop( result ))
+            return true;
+        spinPause();
+    }
+
+    // wakeups continue the wait with the remaining time
+    const bool indefinite = ( timeout == LB_TIMEOUT_INDEFINITE );
+    const int64_t time = timeout == LB_TIMEOUT_DEFAULT ? 300000 /* 5 min */ :
+                                                         timeout;
+    const Clock clock;
+    bool popped = true;
+
+    ++_waiting;
+    _condition.lock();
+    while( !pop( result ))
+    {
+        const int64_t elapsed = indefinite ? 0 : clock.getTime64();
+        if( elapsed >= time ||
+            !_condition.timedWait( indefinite ? LB_TIMEOUT_INDEFINITE :
+                                                uint32_t( time - elapsed )))
+        {
+            popped = false;
+            break;
+        }
+    }
+    _condition.unlock();
+    --_waiting;
+    return popped;
+}
+}
@@ -1,5 +1,5 @@
 
-/* Copyright (c) 2005-2013, Stefan Eilemann <eile@equalizergraphics.com>
+/* Copyright (c) 2005-2014, Stefan Eilemann <eile@equalizergraphics.com>
  *                    2012, Daniel Nachbaur <danielnachbaur@gmail.com>
  *
  * This library is free software; you can redistribute it and/or modify it under
@@ -19,10 +19,12 @@
 #ifndef LUNCHBOX_MTQUEUE_H
 #define LUNCHBOX_MTQUEUE_H
 
+#include <lunchbox/compiler.h>
 #include <lunchbox/condition.h>
 #include <lunchbox/debug.h>
 
 #include <algorithm>
+#include <iterator>
 #include <limits.h>
 #include <queue>
 #include <string.h>
@@ -34,6 +36,10 @@ namespace lunchbox
  *
  * Typically used to communicate between two execution threads.
  *
+ * Modifications only signal the condition variable if a thread is blocked on
+ * the queue, which avoids futile wakeups when consumers are busy. Popped
+ * elements are moved out of the queue if supported by the compiler.
+ *
  * S is deprecated by the ctor param maxSize, and defines the initial maximum
  * capacity of the Queue<T>.  When the capacity is reached, pushing new values
  * blocks until items have been consumed.
@@ -49,10 +55,12 @@ public:
     typedef T value_type;
 
     /** Construct a new queue. @version 1.0 */
-    explicit MTQueue( const size_t maxSize = S ) : _maxSize( maxSize ) {}
+    explicit MTQueue( const size_t maxSize = S )
+        : _cond( "lunchbox::MTQueue" ), _maxSize( maxSize ), _waiters( 0 ) {}
 
     /** Construct a copy of a queue. @version 1.0 */
-    MTQueue( const MTQueue< T, S >& from )  { *this = from; }
+    MTQueue( const MTQueue< T, S >& from )
+        : _cond( "lunchbox::MTQueue" ), _waiters( 0 ) { *this = from; }
 
     /** Destruct this Queue. @version 1.0 */
     ~MTQueue() {}
@@ -200,9 +208,38 @@ public:
     /** Push a vector of elements to the front of the queue. @version 1.0 */
     void pushFront( const std::vector< T >& elements );
 
+#ifdef LB_MOVE_SEMANTICS
+    /** Move a new element to the back of the queue. @version 1.9.2 */
+    void push( T&& element );
+
+    /**
+     * Move a vector of elements to the back of the queue.
+     *
+     * The given vector is empty afterwards.
+     * @version 1.9.2
+     */
+    void push( std::vector< T >&& elements );
+
+    /** Move a new element to the front of the queue. @version 1.9.2 */
+    void pushFront( T&& element );
+
+    /**
+     * Construct a new element in place at the back of the queue.
+     *
+     * @param args the arguments passed to the constructor of the element.
+     * @version 1.9.2
+     */
+    template< class... Args > void emplace( Args&&... args );
+#endif
+
     /** @name STL compatibility. @version 1.7.1 */
     //@{
     void push_back( const T& element ) { push( element ); }
+#ifdef LB_MOVE_SEMANTICS
+    void push_back( T&& element ) { push( std::move( element )); }
+    template< class... Args > void emplace_back( Args&&... args )
+        { emplace( std::forward< Args >( args )... ); }
+#endif
     bool empty() const { return isEmpty(); }
     //@}
 
@@ -210,6 +247,12 @@ private:
     std::deque< T > _queue;
     mutable Condition _cond;
     size_t _maxSize;
+    mutable size_t _waiters; // threads blocked in _cond, protected by _cond
+
+    void _wait() const;
+    bool _timedWait( const unsigned timeout ) const;
+    void _signal() const;
+    void _broadcast() const;
 };
 }
 
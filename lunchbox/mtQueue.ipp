@@ -1,5 +1,5 @@
 
-/* Copyright (c) 2005-2012, Stefan Eilemann <eile@equalizergraphics.com>
+/* Copyright (c) 2005-2014, Stefan Eilemann <eile@equalizergraphics.com>
  *                    2012, Daniel Nachbaur <danielnachbaur@gmail.com>
  *
  * This library is free software; you can redistribute it and/or modify it under
@@ -31,7 +31,7 @@ MTQueue< T, S >& MTQueue< T, S >::operator = ( const MTQueue< T, S >& from )
         _cond.lock();
         _maxSize = maxSize;
         _queue.swap( copy );
-        _cond.signal();
+        _signal();
         _cond.unlock();
     }
     return *this;
@@ -42,7 +42,7 @@ const T& MTQueue< T, S >::operator[]( const size_t index ) const
 {
     _cond.lock();
     while( _queue.size() <= index )
-        _cond.wait();
+        _wait();
 
     LBASSERT( _queue.size() > index );
     const T& element = _queue[index];
@@ -55,9 +55,9 @@ void MTQueue< T, S >::setMaxSize( const size_t maxSize )
 {
     _cond.lock();
     while( _queue.size() > maxSize )
-        _cond.wait();
+        _wait();
     _maxSize = maxSize;
-    _cond.signal();
+    _signal();
     _cond.unlock();
 }
 
@@ -67,7 +67,7 @@ size_t MTQueue< T, S >::waitSize( const size_t minSize ) const
     LBASSERT( minSize <= _maxSize );
     _cond.lock();
     while( _queue.size() < minSize )
-        _cond.wait();
+        _wait();
     const size_t size = _queue.size();
     _cond.unlock();
     return size;
@@ -78,7 +78,7 @@ void MTQueue< T, S >::clear()
 {
     _cond.lock();
     _queue.clear();
-    _cond.signal();
+    _signal();
     _cond.unlock();
 }
 
@@ -87,12 +87,12 @@ T MTQueue< T, S >::pop()
 {
     _cond.lock();
     while( _queue.empty( ))
-        _cond.wait();
+        _wait();
 
     LBASSERT( !_queue.empty( ));
-    T element = _queue.front();
+    T element = LB_MOVE( _queue.front( ));
     _queue.pop_front();
-    _cond.signal();
+    _signal();
     _cond.unlock();
     return element;
 }
@@ -103,16 +103,16 @@ bool MTQueue< T, S >::timedPop( const unsigned timeout, T& element )
     _cond.lock();
     while( _queue.empty( ))
     {
-        if( !_cond.timedWait( timeout ))
+        if( !_timedWait( timeout ))
         {
             _cond.unlock();
             return false;
         }
     }
     LBASSERT( !_queue.empty( ));
-    element = _queue.front();
+    element = LB_MOVE( _queue.front( ));
     _queue.pop_front();
-    _cond.signal();
+    _signal();
     _cond.unlock();
     return true;
 }
@@ -126,7 +126,7 @@ MTQueue< T, S >::timedPopRange( const unsigned timeout, const size_t minimum,
     _cond.lock();
     while( _queue.size() < minimum )
     {
-        if( !_cond.timedWait( timeout ))
+        if( !_timedWait( timeout ))
         {
             _cond.unlock();
             return result;
@@ -136,7 +136,8 @@ MTQueue< T, S >::timedPopRange( const unsigned timeout, const size_t minimum,
     const size_t size = LB_MIN( maximum, _queue.size( ));
 
     result.reserve( size );
-    result.insert( result.end(), _queue.begin(), _queue.begin() + size );
+    for( size_t i = 0; i < size; ++i )
+        result.push_back( LB_MOVE( _queue[ i ] ));
     _queue.erase( _queue.begin(), _queue.begin() + size );
 
     _cond.unlock();
@@ -153,9 +154,9 @@ bool MTQueue< T, S >::tryPop( T& result )
         return false;
     }
 
-    result = _queue.front();
+    result = LB_MOVE( _queue.front( ));
     _queue.pop_front();
-    _cond.signal();
+    _signal();
     _cond.unlock();
     return true;
 }
@@ -170,10 +171,10 @@ void MTQueue< T, S >::tryPop( const size_t num, std::vector< T >& result )
         result.reserve( result.size() + size );
         for( size_t i = 0; i < size; ++i )
         {
-            result.push_back( _queue.front( ));
+            result.push_back( LB_MOVE( _queue.front( )));
             _queue.pop_front();
         }
-        _cond.signal();
+        _signal();
     }
     _cond.unlock();
 }
@@ -204,20 +205,20 @@ bool MTQueue< T, S >::popBarrier( T& element, Group& barrier )
     _cond.lock();
     ++barrier.waiting_;
     while( _queue.empty() && barrier.waiting_ < barrier.height_ )
-        _cond.wait();
+        _wait();
 
     if( _queue.empty( ))
     {
         LBASSERT( barrier.waiting_ == barrier.height_ );
-        _cond.broadcast();
+        _broadcast();
         _cond.unlock();
         return false;
     }
 
-    element = _queue.front();
+    element = LB_MOVE( _queue.front( ));
     _queue.pop_front();
     --barrier.waiting_;
-    _cond.signal();
+    _signal();
     _cond.unlock();
     return true;
 
@@ -258,9 +259,9 @@ void MTQueue< T, S >::push( const T& element )
 {
     _cond.lock();
     while( _queue.size() >= _maxSize )
-        _cond.wait();
+        _wait();
     _queue.push_back( element );
-    _cond.signal();
+    _signal();
     _cond.unlock();
 }
 
@@ -270,9 +271,9 @@ void MTQueue< T, S >::push( const std::vector< T >& elements )
     _cond.lock();
     LBASSERT( elements.size() <= _maxSize );
     while( (_maxSize - _queue.size( )) < elements.size( ))
-        _cond.wait();
+        _wait();
     _queue.insert( _queue.end(), elements.begin(), elements.end( ));
-    _cond.signal();
+    _signal();
     _cond.unlock();
 }
 
@@ -281,9 +282,9 @@ void MTQueue< T, S >::pushFront( const T& element )
 {
     _cond.lock();
     while( _queue.size() >= _maxSize )
-        _cond.wait();
+        _wait();
     _queue.push_front( element );
-    _cond.signal();
+    _signal();
     _cond.unlock();
 }
 
@@ -293,9 +294,86 @@ void MTQueue< T, S >::pushFront( const std::vector< T >& elements )
     _cond.lock();
     LBASSERT( elements.size() <= _maxSize );
     while( (_maxSize - _queue.size( )) < elements.size( ))
-        _cond.wait();
+        _wait();
     _queue.insert(_queue.begin(), elements.begin(), elements.end());
-    _cond.signal();
+    _signal();
+    _cond.unlock();
+}
+
+#ifdef LB_MOVE_SEMANTICS
+template< typename T, size_t S >
+void MTQueue< T, S >::push( T&& element )
+{
+    _cond.lock();
+    while( _queue.size() >= _maxSize )
+        _wait();
+    _queue.push_back( std::move( element ));
+    _signal();
+    _cond.unlock();
+}
+
+template< typename T, size_t S >
+void MTQueue< T, S >::push( std::vector< T >&& elements )
+{
+    _cond.lock();
+    LBASSERT( elements.size() <= _maxSize );
+    while( (_maxSize - _queue.size( )) < elements.size( ))
+        _wait();
+    _queue.insert( _queue.end(), std::make_move_iterator( elements.begin( )),
+                   std::make_move_iterator( elements.end( )));
+    _signal();
     _cond.unlock();
+    elements.clear();
+}
+
+template< typename T, size_t S >
+void MTQueue< T, S >::pushFront( T&& element )
+{
+    _cond.lock();
+    while( _queue.size() >= _maxSize )
+        _wait();
+    _queue.push_front( std::move( element ));
+    _signal();
+    _cond.unlock();
+}
+
+template< typename T, size_t S > template< class... Args >
+void MTQueue< T, S >::emplace( Args&&... args )
+{
+    _cond.lock();
+    while( _queue.size() >= _maxSize )
+        _wait();
+    _queue.emplace_back( std::forward< Args >( args )... );
+    _signal();
+    _cond.unlock();
+}
+#endif
+
+template< typename T, size_t S > void MTQueue< T, S >::_wait() const
+{
+    ++_waiters;
+    _cond.wait();
+    --_waiters;
+}
+
+template< typename T, size_t S >
+bool MTQueue< T, S >::_timedWait( const unsigned timeout ) const
+{
+    ++_waiters;
+    const bool signalled = _cond.timedWait( timeout );
+    --_waiters;
+    return signalled;
+}
+
+template< typename T, size_t S > void MTQueue< T, S >::_signal() const
+{
+    if( _waiters > 0 )
+        _cond.signal();
+}
+
+template< typename T, size_t S > void MTQueue< T, S >::_broadcast() const
+{
+    if( _waiters > 0 )
+        _cond.broadcast();
 }
 }
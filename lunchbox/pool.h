@@ -24,13 +24,18 @@
 
 namespace lunchbox
 {
-/** An object allocation pool. */
+/**
+ * An object allocation pool.
+ *
+ * A locked pool serializes all operations on a single lock. Use MagazinePool
+ * for objects recycled concurrently by many threads.
+ */
 template< typename T, bool locked = false >
 class Pool : public boost::noncopyable
 {
 public:
     /** Construct a new pool. @version 1.0 */
-    Pool() : _lock( locked ? new SpinLock : 0 ) {}
+    Pool() : _lock( locked ? new SpinLock( "lunchbox::Pool" ) : 0 ) {}
 
     /** Destruct this pool. @version 1.0 */
     virtual ~Pool() { flush(); delete _lock; }
@@ -51,7 +51,7 @@ public:
 #ifndef NDEBUG
         LBASSERT( !_hasBeenDeleted );
 #endif
-        ++_refCount;
+        Atomic< int32_t >::getAndAdd( _refCount, 1, ORDER_RELAXED );
 
 #ifdef LUNCHBOX_REFERENCED_DEBUG
         if( holder )
@@ -80,8 +80,9 @@ public:
 #ifndef NDEBUG
         LBASSERT( !_hasBeenDeleted );
 #endif
-        LBASSERT( _refCount > 0 );
-        const bool last = (--_refCount==0);
+        LBASSERT( getRefCount() > 0 );
+        const bool last = Atomic< int32_t >::getAndSub( _refCount, 1,
+                                                        ORDER_RELEASE ) == 1;
 
 #ifdef LUNCHBOX_REFERENCED_DEBUG
         if( holder )
@@ -95,12 +96,17 @@ public:
 #endif
 
         if( last )
+        {
+            // see all writes of other holders before destruction
+            memoryBarrier( ORDER_ACQUIRE );
             const_cast< Referenced* >( this )->notifyFree();
+        }
         return last;
     }
 
     /** @return the current reference count. @version 1.0 */
-    int32_t getRefCount() const { return _refCount; }
+    int32_t getRefCount() const
+        { return Atomic< int32_t >::load( _refCount, ORDER_RELAXED ); }
 
     /** @internal print holders of this if debugging is enabled. */
 #ifdef LUNCHBOX_REFERENCED_DEBUG
@@ -144,7 +150,7 @@ protected:
     LUNCHBOX_API virtual void notifyFree();
 
 private:
-    mutable a_int32_t _refCount;
+    mutable int32_t _refCount;
     bool _hasBeenDeleted;
 
 #ifdef LUNCHBOX_REFERENCED_DEBUG
@@ -33,7 +33,7 @@ namespace
 {
 struct Record
 {
-    Record() { lock.set(); }
+    Record() : lock( "lunchbox::RequestHandler::Record" ) { lock.set(); }
     ~Record(){}
 
     TimedLock lock;
@@ -60,7 +60,7 @@ namespace detail
 class RequestHandler
 {
 public:
-    RequestHandler() : requestID( 1 ) {}
+    RequestHandler() : lock( "lunchbox::RequestHandler" ), requestID( 1 ) {}
 
     uint32_t registerRequest( void* data )
     {
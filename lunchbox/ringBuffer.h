@@ -0,0 +1,264 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_RINGBUFFER_H
+#define LUNCHBOX_RINGBUFFER_H
+
+#include <lunchbox/atomic.h>       // used inline
+#include <lunchbox/debug.h>        // used in inline method
+#include <lunchbox/thread.h>       // thread-safety checks
+
+#include <boost/noncopyable.hpp>
+#include <cstring>
+
+namespace lunchbox
+{
+/**
+ * A lock-free ring buffer of variable-length byte records.
+ *
+ * Producers reserve() a contiguous record of the requested size, write it in
+ * place and commit() it. The consumer peek()s at the oldest committed record,
+ * reads it in place and release()s it. No memory is allocated after
+ * construction.
+ *
+ * Each record is prefixed by an eight byte header holding its size and state,
+ * and is aligned to eight bytes. A record which does not fit before the end of
+ * the buffer is placed at the start, and the remaining space is filled with a
+ * padding record skipped by the consumer. The consumer clears released records,
+ * so that the header of the next record reads as not committed until its
+ * producer commits it.
+ *
+ * Current implementation constraints:
+ * * Any number of producer threads, one consumer thread
+ * * Records are consumed in reservation order, a record reserved but not yet
+ *   committed blocks the consumption of all following records
+ * * Fixed capacity, rounded up to a power of two (reserve may fail)
+ * * Not copyable
+ *
+ * Example: @include tests/ringBuffer.cpp
+ */
+class RingBuffer : public boost::noncopyable
+{
+public:
+    /** A contiguous range of bytes within the buffer. @version 1.9.2 */
+    template< class T > struct Span
+    {
+        Span() : data( 0 ), size( 0 ) {}
+        Span( T* data_, const size_t size_ ) : data( data_ ), size( size_ ) {}
+
+        /** @return true if the span is empty. @version 1.9.2 */
+        bool isEmpty() const { return data == 0; }
+
+        T* data; //!< The first byte
+        size_t size; //!< The number of bytes
+    };
+
+    typedef Span< uint8_t > WriteSpan; //!< A reserved record @version 1.9.2
+    typedef Span< const uint8_t > ReadSpan; //!< A committed record
+
+    /**
+     * Construct a new ring buffer.
+     *
+     * @param size the capacity in bytes, rounded up to the next power of two.
+     * @version 1.9.2
+     */
+    explicit RingBuffer( size_t size );
+
+    /** Destruct this ring buffer. @version 1.9.2 */
+    ~RingBuffer() { delete [] _data; }
+
+    /** @return the capacity in bytes. @version 1.9.2 */
+    size_t getSize() const { return _mask + 1; }
+
+    /**
+     * @return true if no record is reserved or committed. The result is a
+     *         snapshot when used concurrently.
+     * @version 1.9.2
+     */
+    bool isEmpty() const
+        { return Atomic< ssize_t >::loadAcquire( _tail ) ==
+                 Atomic< ssize_t >::loadAcquire( _head ); }
+
+    /**
+     * Reserve a new record at the end of the buffer. Thread-safe.
+     *
+     * The record has to be committed for the consumer to see it and all
+     * following records.
+     *
+     * @param size the size of the record in bytes.
+     * @return the writable record, or an empty span if the buffer is full.
+     * @version 1.9.2
+     */
+    WriteSpan reserve( size_t size );
+
+    /**
+     * Publish a reserved record to the consumer. Thread-safe.
+     *
+     * @param record the record returned by reserve().
+     * @version 1.9.2
+     */
+    void commit( const WriteSpan& record );
+
+    /**
+     * Retrieve the oldest committed record. Consumer thread only.
+     *
+     * @return the readable record, valid until release(), or an empty span
+     *         if no record is committed.
+     * @version 1.9.2
+     */
+    ReadSpan peek();
+
+    /**
+     * Remove the record returned by the last peek(). Consumer thread only.
+     * @version 1.9.2
+     */
+    void release();
+
+private:
+    struct Header
+    {
+        uint32_t size;
+        uint32_t state;
+    };
+    enum State
+    {
+        STATE_FREE = 0, // cleared by consumer, reserved but not committed
+        STATE_COMMITTED,
+        STATE_PADDING
+    };
+
+    uint8_t* const _data;
+    const size_t _mask;
+    char _pad0[ LB_CACHELINE_SIZE ];
+    ssize_t _tail; // reserved up to, written by producers
+    char _pad1[ LB_CACHELINE_SIZE ];
+    ssize_t _head; // released up to, written by consumer
+    char _pad2[ LB_CACHELINE_SIZE ];
+
+    static size_t _getRingSize( size_t size );
+    static size_t _getRecordSize( const size_t size )
+        { return ( sizeof( Header ) + size + 7 ) & ~size_t( 7 ); }
+
+    Header* _getHeader( const ssize_t position )
+        { return reinterpret_cast< Header* >( _data + ( position & _mask )); }
+
+    LB_TS_VAR( _reader );
+};
+}
+
+// Implementation
+
+namespace lunchbox
+{
+inline size_t RingBuffer::_getRingSize( const size_t size )
+{
+    size_t ringSize = 64;
+    while( ringSize < size )
+        ringSize <<= 1;
+    return ringSize;
+}
+
+inline RingBuffer::RingBuffer( const size_t size )
+    : _data( new uint8_t[ _getRingSize( size ) ]( ))
+    , _mask( _getRingSize( size ) - 1 )
+    , _tail( 0 )
+    , _head( 0 )
+{
+    memoryBarrier();
+}
+
+inline RingBuffer::WriteSpan RingBuffer::reserve( const size_t size )
+{
+    const size_t recordSize = _getRecordSize( size );
+    LBASSERTINFO( recordSize <= getSize(), "Record exceeds capacity" );
+
+    while( true )
+    {
+        // the CAS validates the tail, the head orders the reuse of space
+        const ssize_t tail = Atomic< ssize_t >::load( _tail, ORDER_RELAXED );
+        const size_t offset = size_t( tail ) & _mask;
+        const size_t padding = offset + recordSize > getSize() ?
+                               getSize() - offset : 0;
+
+        const ssize_t head = Atomic< ssize_t >::loadAcquire( _head );
+        if( size_t( tail - head ) + padding + recordSize > getSize( ))
+            return WriteSpan(); // full
+
+        if( !Atomic< ssize_t >::compareAndSwap( &_tail, tail,
+                                    tail + ssize_t( padding + recordSize ),
+                                    ORDER_RELAXED ))
+        {
+            continue; // concurrent reservation
+        }
+
+        ssize_t position = tail;
+        if( padding > 0 ) // wrap around, skip the remaining space
+        {
+            Header* header = _getHeader( position );
+            header->size = uint32_t( padding - sizeof( Header ));
+            Atomic< uint32_t >::storeRelease( header->state, STATE_PADDING );
+            position += ssize_t( padding );
+        }
+
+        Header* header = _getHeader( position );
+        header->size = uint32_t( size );
+        return WriteSpan( reinterpret_cast< uint8_t* >( header + 1 ), size );
+    }
+}
+
+inline void RingBuffer::commit( const WriteSpan& record )
+{
+    LBASSERT( !record.isEmpty( ));
+    Header* header = reinterpret_cast< Header* >( record.data ) - 1;
+    LBASSERT( header->size == record.size );
+    Atomic< uint32_t >::storeRelease( header->state, STATE_COMMITTED );
+}
+
+inline RingBuffer::ReadSpan RingBuffer::peek()
+{
+    LB_TS_THREAD( _reader );
+    while( true )
+    {
+        Header* header = _getHeader( _head );
+        switch( Atomic< uint32_t >::loadAcquire( header->state ))
+        {
+        case STATE_COMMITTED:
+            return ReadSpan( reinterpret_cast< const uint8_t* >( header + 1 ),
+                             header->size );
+        case STATE_PADDING:
+            release();
+            break;
+        default:
+            return ReadSpan();
+        }
+    }
+}
+
+inline void RingBuffer::release()
+{
+    LB_TS_THREAD( _reader );
+    Header* header = _getHeader( _head );
+    LBASSERT( header->state != STATE_FREE );
+
+    // Clear the record, its space may hold the header of a later record
+    const size_t recordSize = _getRecordSize( header->size );
+    ::memset( header, 0, recordSize );
+    Atomic< ssize_t >::storeRelease( _head, _head + ssize_t( recordSize ));
+}
+}
+
+#endif // LUNCHBOX_RINGBUFFER_H
@@ -0,0 +1,186 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "rwLock.h"
+
+#include "atomic.h"
+#include "debug.h"
+#include "thread.h"
+#include "detail/cpu.h"
+
+// Pause rounds before a waiting thread yields
+#define LB_RWLOCK_SPINS 64
+// Upper limit for the number of reader slots
+#define LB_RWLOCK_MAX_SLOTS 64
+
+namespace lunchbox
+{
+namespace
+{
+void _wait( const size_t round )
+{
+    if( round < LB_RWLOCK_SPINS )
+        spinPause();
+    else
+        Thread::yield();
+}
+}
+
+namespace detail
+{
+class RWLock
+{
+public:
+    struct Slot
+    {
+        int32_t readers;
+        char pad[ LB_CACHELINE_SIZE - sizeof( int32_t ) ];
+    };
+
+    RWLock()
+        : nSlots( detail::getNSlots( LB_RWLOCK_MAX_SLOTS ))
+        , writer( 0 )
+        , slots( new Slot[ nSlots ] )
+    {
+        for( size_t i = 0; i < nSlots; ++i )
+            slots[i].readers = 0;
+        memoryBarrier();
+    }
+
+    ~RWLock() { delete [] slots; }
+
+    Slot& getSlot() { return slots[ getThreadIndex() & ( nSlots - 1 ) ]; }
+
+    /** @return true if a reader holds or attempts to acquire the lock. */
+    bool hasReaders() const
+    {
+        for( size_t i = 0; i < nSlots; ++i )
+            if( Atomic< int32_t >::loadAcquire( slots[i].readers ) > 0 )
+                return true;
+        return false;
+    }
+
+    bool trySetRead( Slot& slot )
+    {
+        // Full barrier, orders the registration before the writer check.
+        // Pairs with the writer setting its flag before checking the slots.
+        Atomic< int32_t >::incAndGet( slot.readers );
+        if( Atomic< int32_t >::loadAcquire( writer ) == 0 )
+            return true;
+
+        Atomic< int32_t >::decAndGet( slot.readers ); // writer preference
+        return false;
+    }
+
+    const size_t nSlots;
+    char pad0[ LB_CACHELINE_SIZE ];
+    int32_t writer; // set while a writer holds or waits for the lock
+    char pad1[ LB_CACHELINE_SIZE ];
+    Slot* const slots;
+};
+}
+
+RWLock::RWLock()
+    : _impl( new detail::RWLock )
+{}
+
+RWLock::~RWLock()
+{
+    delete _impl;
+}
+
+void RWLock::set()
+{
+    for( size_t i = 0;
+         Atomic< int32_t >::loadAcquire( _impl->writer ) != 0 ||
+             !Atomic< int32_t >::compareAndSwap( &_impl->writer, 0, 1 );
+         ++i )
+    {
+        _wait( i );
+    }
+
+    // Blocks new readers, wait for the current ones to leave
+    for( size_t i = 0; _impl->hasReaders(); ++i )
+        _wait( i );
+}
+
+void RWLock::unset()
+{
+    LBASSERT( isSetWrite( ));
+    Atomic< int32_t >::storeRelease( _impl->writer, 0 );
+}
+
+bool RWLock::trySet()
+{
+    if( Atomic< int32_t >::loadAcquire( _impl->writer ) != 0 ||
+        !Atomic< int32_t >::compareAndSwap( &_impl->writer, 0, 1 ))
+    {
+        return false;
+    }
+
+    if( !_impl->hasReaders( ))
+        return true;
+
+    Atomic< int32_t >::storeRelease( _impl->writer, 0 );
+    return false;
+}
+
+void RWLock::setRead()
+{
+    detail::RWLock::Slot& slot = _impl->getSlot();
+    while( !_impl->trySetRead( slot ))
+    {
+        for( size_t i = 0; Atomic< int32_t >::loadAcquire( _impl->writer );
+             ++i )
+        {
+            _wait( i );
+        }
+    }
+}
+
+void RWLock::unsetRead()
+{
+    detail::RWLock::Slot& slot = _impl->getSlot();
+    LBASSERT( slot.readers > 0 );
+    Atomic< int32_t >::decAndGet( slot.readers );
+}
+
+bool RWLock::trySetRead()
+{
+    return _impl->trySetRead( _impl->getSlot( ));
+}
+
+bool RWLock::isSet()
+{
+    return isSetWrite() || isSetRead();
+}
+
+bool RWLock::isSetWrite()
+{
+    return Atomic< int32_t >::loadAcquire( _impl->writer ) != 0;
+}
+
+bool RWLock::isSetRead()
+{
+    return _impl->hasReaders();
+}
+
+size_t RWLock::getNSlots() const
+{
+    return _impl->nSlots;
+}
+}
@@ -0,0 +1,119 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_RWLOCK_H
+#define LUNCHBOX_RWLOCK_H
+
+#include <lunchbox/api.h>
+#include <lunchbox/types.h>
+#include <boost/noncopyable.hpp>
+
+namespace lunchbox
+{
+namespace detail { class RWLock; }
+
+/**
+ * A scalable, writer-preferring read-write spin lock for read-mostly data.
+ *
+ * Readers register in one of several reader slots, each on its own cache line.
+ * Threads are assigned to slots round-robin, and the number of slots is based
+ * on the number of cores. Readers on different slots therefore do not share
+ * any written cache line, and read locking scales with the number of cores.
+ * Write locking is more expensive than for SpinLock, since a writer has to
+ * check all reader slots.
+ *
+ * A waiting writer blocks new readers, so a steady stream of readers can't
+ * starve it. Readers hence starve under a steady stream of writers. Waiting
+ * threads spin briefly and then yield. Read locks are not recursive: a thread
+ * holding a read lock may deadlock when acquiring it again while a writer
+ * waits.
+ *
+ * Use with ScopedMutex< RWLock, ReadOp > and ScopedMutex< RWLock, WriteOp >.
+ *
+ * @sa SpinLock
+ *
+ * Example: @include tests/rwLock.cpp
+ */
+class RWLock : public boost::noncopyable
+{
+public:
+    /** Construct a new lock. @version 1.9.2 */
+    LUNCHBOX_API RWLock();
+
+    /** Destruct the lock. @version 1.9.2 */
+    LUNCHBOX_API ~RWLock();
+
+    /** Acquire the lock exclusively. @version 1.9.2 */
+    LUNCHBOX_API void set();
+
+    /** Release an exclusive lock. @version 1.9.2 */
+    LUNCHBOX_API void unset();
+
+    /**
+     * Attempt to acquire the lock exclusively.
+     *
+     * @return true if the lock was set, false if it was not set.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API bool trySet();
+
+    /** Acquire the lock shared with other readers. @version 1.9.2 */
+    LUNCHBOX_API void setRead();
+
+    /** Release a shared read lock. @version 1.9.2 */
+    LUNCHBOX_API void unsetRead();
+
+    /**
+     * Attempt to acquire the lock shared with other readers.
+     *
+     * @return true if the lock was set, false if it was not set.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API bool trySetRead();
+
+    /**
+     * Test if the lock is set.
+     *
+     * @return true if the lock is set, false if it is not set.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API bool isSet();
+
+    /**
+     * Test if the lock is set exclusively, or a writer waits for it.
+     *
+     * @return true if the lock is set, false if it is not set.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API bool isSetWrite();
+
+    /**
+     * Test if the lock is set shared.
+     *
+     * @return true if the lock is set, false if it is not set.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API bool isSetRead();
+
+    /** @return the number of reader slots. @version 1.9.2 */
+    LUNCHBOX_API size_t getNSlots() const;
+
+private:
+    detail::RWLock* const _impl;
+};
+}
+#endif // LUNCHBOX_RWLOCK_H
@@ -0,0 +1,155 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_SEQLOCK_H
+#define LUNCHBOX_SEQLOCK_H
+
+#include <lunchbox/atomic.h>      // used inline
+#include <lunchbox/debug.h>       // used inline
+#include <lunchbox/scopedMutex.h> // used inline
+#include <lunchbox/spinLock.h>    // member
+#include <boost/noncopyable.hpp>
+
+namespace lunchbox
+{
+/**
+ * A sequence lock protecting a small value.
+ *
+ * Readers copy the value optimistically without writing to shared memory, and
+ * retry if a writer modified the value meanwhile. Readers therefore never
+ * contend with each other and never block writers. Writers are serialized by
+ * a spin lock and increment a sequence counter before and after modifying the
+ * value.
+ *
+ * Best suited for read-mostly values of a few cache words. The value type has
+ * to be copyable by its copy constructor while being modified concurrently,
+ * e.g., a plain old data type without pointers to owned memory. Other types
+ * have to be read using getLocked().
+ *
+ * Example: @include tests/seqLock.cpp
+ */
+template< class T > class SeqLock : public boost::noncopyable
+{
+public:
+    /** Construct a new sequence lock with a default value. @version 1.9.2 */
+    SeqLock() : _lock( "lunchbox::SeqLock" ), _sequence( 0 ), _value() {}
+
+    /** Construct a new sequence lock with the given value. @version 1.9.2 */
+    explicit SeqLock( const T& value )
+        : _lock( "lunchbox::SeqLock" ), _sequence( 0 ), _value( value ) {}
+
+    /** Destruct the sequence lock. @version 1.9.2 */
+    ~SeqLock() {}
+
+    /**
+     * @return a consistent copy of the value, retrying while it is written.
+     * @version 1.9.2
+     */
+    T get() const
+        {
+            T value( _value );
+            while( !tryGet( value ))
+                spinPause();
+            return value;
+        }
+
+    /**
+     * Attempt to read a consistent copy of the value without retrying.
+     *
+     * @param value the copy of the value, undefined on failure.
+     * @return true if the copy is consistent, false if a writer interfered.
+     * @version 1.9.2
+     */
+    bool tryGet( T& value ) const
+        {
+            const int32_t sequence =
+                Atomic< int32_t >::loadAcquire( _sequence );
+            if( sequence & 1 ) // write in progress
+                return false;
+            value = _value;
+            // order the copy before the reload of the sequence
+            memoryBarrier( ORDER_ACQUIRE );
+            return Atomic< int32_t >::load( _sequence, ORDER_RELAXED ) ==
+                   sequence;
+        }
+
+    /**
+     * @return a copy of the value, read while holding off writers. For value
+     *         types which can not be copied during a modification.
+     * @version 1.9.2
+     */
+    T getLocked() const
+        {
+            ScopedFastWrite mutex( _lock );
+            return _value;
+        }
+
+    /**
+     * @return the value without synchronization, for use by the writer or
+     *         when no writer exists.
+     * @version 1.9.2
+     */
+    const T& getUnsynchronized() const { return _value; }
+
+    /** Set a new value. @version 1.9.2 */
+    void set( const T& value )
+        {
+            beginWrite() = value;
+            endWrite();
+        }
+
+    /**
+     * Start the modification of the value.
+     *
+     * Blocks other writers until endWrite() is called. Readers retry until
+     * then.
+     *
+     * @return the value to modify in place.
+     * @version 1.9.2
+     */
+    T& beginWrite()
+        {
+            _lock.set();
+            // only writer, order the odd sequence before the value stores
+            Atomic< int32_t >::store( _sequence, _sequence + 1, ORDER_RELAXED );
+            memoryBarrier( ORDER_RELEASE );
+            return _value;
+        }
+
+    /** Publish the modified value and release writers. @version 1.9.2 */
+    void endWrite()
+        {
+            LBASSERT( _sequence & 1 );
+            Atomic< int32_t >::storeRelease( _sequence, _sequence + 1 );
+            _lock.unset();
+        }
+
+    /**
+     * @return the number of completed writes times two, plus one while a
+     *         write is in progress.
+     * @version 1.9.2
+     */
+    int32_t getSequence() const
+        { return Atomic< int32_t >::loadAcquire( _sequence ); }
+
+private:
+    mutable SpinLock _lock;
+    int32_t _sequence;
+    T _value;
+};
+}
+#endif // LUNCHBOX_SEQLOCK_H
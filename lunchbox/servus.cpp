@@ -155,7 +155,7 @@ protected:
 #ifdef __APPLE__
 static lunchbox::Lock* lock_( 0 );
 #else
-static lunchbox::Lock lock_;
+static lunchbox::Lock lock_( "lunchbox::Servus" );
 #endif
 
 namespace lunchbox
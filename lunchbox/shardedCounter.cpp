@@ -0,0 +1,54 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "shardedCounter.h"
+
+#include "detail/cpu.h"
+
+// Upper limit for the number of slots
+#define LB_SHARDEDCOUNTER_MAX_SLOTS 64
+
+namespace lunchbox
+{
+ShardedCounter::ShardedCounter( const ssize_t value )
+    : _slots( new Slot[ detail::getNSlots( LB_SHARDEDCOUNTER_MAX_SLOTS )] )
+    , _mask( detail::getNSlots( LB_SHARDEDCOUNTER_MAX_SLOTS ) - 1 )
+{
+    for( size_t i = 0; i < getNSlots(); ++i )
+        _slots[i].value = 0;
+    _slots[0].value = value;
+    memoryBarrier();
+}
+
+ShardedCounter::~ShardedCounter()
+{
+    delete [] _slots;
+}
+
+ssize_t ShardedCounter::get() const
+{
+    ssize_t value = 0;
+    for( size_t i = 0; i < getNSlots(); ++i )
+        value += Atomic< ssize_t >::load( _slots[i].value, ORDER_RELAXED );
+    return value;
+}
+
+size_t ShardedCounter::getThreadIndex()
+{
+    return detail::getThreadIndex();
+}
+}
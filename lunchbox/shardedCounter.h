@@ -0,0 +1,93 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_SHARDEDCOUNTER_H
+#define LUNCHBOX_SHARDEDCOUNTER_H
+
+#include <lunchbox/api.h>
+#include <lunchbox/atomic.h>   // used inline
+#include <lunchbox/compiler.h> // LB_CACHELINE_SIZE
+#include <boost/noncopyable.hpp>
+
+namespace lunchbox
+{
+/**
+ * A counter for frequent concurrent updates and rare reads.
+ *
+ * The counter is split into several slots, each on its own cache line. Threads
+ * are assigned to slots round-robin, and the number of slots is based on the
+ * number of cores. Updates from threads on different slots therefore do not
+ * share any written cache line, and scale with the number of cores. Reading
+ * the value sums all slots, which is more expensive than reading an Atomic.
+ *
+ * Updates are atomic, but the value is not a snapshot: updates concurrent to
+ * get() may or may not be included. Use for statistics, not for decisions
+ * based on exact values or for unique identifiers.
+ *
+ * Example: @include tests/shardedCounter.cpp
+ */
+class ShardedCounter : public boost::noncopyable
+{
+public:
+    /** Construct a new counter with the given value. @version 1.9.2 */
+    LUNCHBOX_API explicit ShardedCounter( ssize_t value = 0 );
+
+    /** Destruct the counter. @version 1.9.2 */
+    LUNCHBOX_API ~ShardedCounter();
+
+    /** Add the given value to the counter. @version 1.9.2 */
+    void add( const ssize_t value )
+        {
+            Slot& slot = _slots[ _mask ? getThreadIndex() & _mask : 0 ];
+            Atomic< ssize_t >::getAndAdd( slot.value, value, ORDER_RELAXED );
+        }
+
+    /** Increment the counter. @version 1.9.2 */
+    ShardedCounter& operator ++ () { add( 1 ); return *this; }
+
+    /** Decrement the counter. @version 1.9.2 */
+    ShardedCounter& operator -- () { add( -1 ); return *this; }
+
+    /** Add the given value to the counter. @version 1.9.2 */
+    ShardedCounter& operator += ( const ssize_t value )
+        { add( value ); return *this; }
+
+    /** Subtract the given value from the counter. @version 1.9.2 */
+    ShardedCounter& operator -= ( const ssize_t value )
+        { add( -value ); return *this; }
+
+    /** @return the sum of all slots. @version 1.9.2 */
+    LUNCHBOX_API ssize_t get() const;
+
+    /** @return the number of slots. @version 1.9.2 */
+    size_t getNSlots() const { return _mask + 1; }
+
+    /** @internal @return the unmasked slot index of the calling thread. */
+    LUNCHBOX_API static size_t getThreadIndex();
+
+private:
+    struct Slot
+    {
+        ssize_t value;
+        char pad[ LB_CACHELINE_SIZE - sizeof( ssize_t ) ];
+    };
+
+    Slot* const _slots;
+    const size_t _mask;
+};
+}
+#endif // LUNCHBOX_SHARDEDCOUNTER_H
@@ -1,5 +1,5 @@
 
-/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch> 
+/* Copyright (c) 2012-2014, Stefan Eilemann <eile@eyescale.ch>
  *
  * This library is free software; you can redistribute it and/or modify it under
  * the terms of the GNU Lesser General Public License version 2.1 as published
@@ -16,145 +16,76 @@
  */
 
 #include "spinLock.h"
-#include <lunchbox/atomic.h>
-#include <lunchbox/thread.h>
+#include "futex.h"
+#include "thread.h"
+#include "detail/cpu.h"
+
+// Backoff rounds with 1, 2, 4, ... pause instructions before yielding
+#define LB_SPINLOCK_SPIN_ROUNDS 10
+// Yield rounds before a parking lock blocks
+#define LB_SPINLOCK_YIELD_ROUNDS 16
 
 namespace lunchbox
 {
 namespace
 {
-static const long _writelocked = -1;
-static const long _unlocked = 0;
-}
-namespace detail
-{
-class SpinLock
+uint32_t _getNSpinRounds()
 {
-public:
-    SpinLock() : _state( _unlocked ) {}
-    ~SpinLock() { _state = _unlocked; }
-
-    inline void set()
-        {
-            while( true )
-            {
-                if( trySet( ))
-                    return;
-                lunchbox::Thread::yield();
-            }
-        }
-
-    inline void unset()
-        {
-            LBASSERT( _state == _writelocked );
-            _state = _unlocked;
-        }
+    // The owner can't release the lock while we spin on its only core
+    return detail::getNCores() > 1 ? LB_SPINLOCK_SPIN_ROUNDS : 0;
+}
 
-    inline bool trySet()
-        {
-            if( !_state.compareAndSwap( _unlocked, _writelocked ))
-                return false;
-            LBASSERTINFO( isSetWrite(), _state );
-            return true;
-        }
+const uint32_t _nSpinRounds = _getNSpinRounds();
+}
 
-    inline void setRead()
+void SpinLock::_wait( const bool write )
+{
+    const int32_t busy = write ? ~PARKED : WRITE_LOCKED;
+    const uint64_t start = _profile ? LockProfile::getTime() : 0;
+    for( uint32_t round = 0; ; ++round )
+    {
+        if( write ? _trySet() : _trySetRead( ))
         {
-            while( true )
-            {
-                if( trySetRead( ))
-                    return;
-                lunchbox::Thread::yield();
-            }
+            if( _profile )
+                _profile->acquired( write, start );
+            return;
         }
 
-    inline void unsetRead()
-        {
-            while( true )
-            {
-                LBASSERT( _state > _unlocked );
-                memoryBarrier();
-                const int32_t expected = _state;
-                if( _state.compareAndSwap( expected, expected-1 ))
-                    return;
-            }
-        }
+        const int32_t state = Atomic< int32_t >::load( _state, ORDER_RELAXED );
+        if(( state & busy ) == 0 )
+            continue; // released meanwhile, retry
 
-    inline bool trySetRead()
+        if( round < _nSpinRounds )
         {
-            memoryBarrier();
-            const int32_t state = _state;
-            // Note: 0 used here since using _unlocked unexplicably gives
-            //       'undefined reference to lunchbox::SpinLock::_unlocked'
-            const int32_t expected = (state==_writelocked) ? 0 : state;
-
-            if( !_state.compareAndSwap( expected, expected+1 ))
-                return false;
-
-            LBASSERTINFO( isSetRead(), _state << ", " << expected );
-            return true;
+            for( uint32_t i = 0; i < ( 1u << round ); ++i )
+                spinPause();
         }
-
-    inline bool isSet() { return ( _state != _unlocked ); }
-    inline bool isSetWrite() { return ( _state == _writelocked ); }
-    inline bool isSetRead() { return ( _state > _unlocked ); }
-
-private:
-    a_int32_t _state;
-};
-}
-
-SpinLock::SpinLock()
-        : _impl( new detail::SpinLock ) {}
-
-SpinLock::~SpinLock()
-{
-    delete _impl;
+        else if( !_park || round < _nSpinRounds + LB_SPINLOCK_YIELD_ROUNDS )
+            Thread::yield();
+        else
+            _sleep( state );
+    }
 }
 
-void SpinLock::set()
+void SpinLock::_sleep( int32_t state )
 {
-    _impl->set();
-}
-
-void SpinLock::unset()
-{
-    _impl->unset();
-}
-
-bool SpinLock::trySet()
-{
-    return _impl->trySet();
-}
-
-void SpinLock::setRead()
-{
-    _impl->setRead();
-}
-
-void SpinLock::unsetRead()
-{
-    _impl->unsetRead();
-}
-
-bool SpinLock::trySetRead()
-{
-    return _impl->trySetRead();
-}
-
-bool SpinLock::isSet()
-{
-    return _impl->isSet();
-}
-
-bool SpinLock::isSetWrite()
-{
-    return _impl->isSetWrite();
+    if(( state & PARKED ) == 0 )
+    {
+        if( !Atomic< int32_t >::compareAndSwap( &_state, state,
+                                                state | PARKED ))
+        {
+            return; // state changed, retry
+        }
+        state |= PARKED;
+    }
+    futexWait( &_state, state ); // returns if the state changed since
 }
 
-bool SpinLock::isSetRead()
+void SpinLock::_wake()
 {
-    return _impl->isSetRead();
+    // New owners wake the parked threads on their release
+    if( Atomic< int32_t >::compareAndSwap( &_state, PARKED, 0 ))
+        futexWakeAll( &_state );
 }
 
 }
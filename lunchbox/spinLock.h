@@ -18,20 +18,33 @@
 #ifndef LUNCHBOX_SPINLOCK_H
 #define LUNCHBOX_SPINLOCK_H
 
-#include <lunchbox/atomic.h>         // member
-#include <lunchbox/thread.h>         // used in inline method
+#include <lunchbox/atomic.h>         // used in inline method
+#include <lunchbox/compiler.h>       // LB_UNLIKELY
+#include <lunchbox/debug.h>          // used in inline method
+#include <lunchbox/lockProfile.h>    // used in inline method
+#include <lunchbox/thread.h>         // source compatibility
+#include <boost/noncopyable.hpp>
 
 namespace lunchbox
 {
-namespace detail { class SpinLock; }
-
 /**
  * A fast lock for uncontended memory access.
  *
- * If Thread::yield() does not work, priority inversion is possible. If used as
- * a read-write lock, readers or writers will starve on high contention.
+ * The lock state is a single word within the object, and the uncontended
+ * operations are inlined. A contended thread spins on reads of the state with
+ * an exponentially growing number of CPU pause instructions, then yields its
+ * time slice. Locks constructed with parking enabled finally block the thread
+ * until the lock is released, which is preferable for locks held for longer
+ * periods or with more threads than cores. Spinning is skipped on single-core
+ * machines.
+ *
+ * If Thread::yield() does not work and parking is not enabled, priority
+ * inversion is possible. If used as a read-write lock, readers or writers will
+ * starve on high contention.
+ *
+ * Named locks record their contention if lock profiling is enabled.
  *
- * @sa ScopedMutex
+ * @sa ScopedMutex, LockProfile
  *
  * Example: @include tests/lock.cpp
  */
@@ -39,16 +52,53 @@ class SpinLock : public boost::noncopyable
 {
 public:
     /** Construct a new lock. @version 1.0 */
-    LUNCHBOX_API SpinLock();
+    SpinLock() : _state( 0 ), _park( false ), _profile( 0 ) {}
+
+    /**
+     * Construct a new lock.
+     *
+     * @param park true to block contended threads after spinning and yielding.
+     * @version 1.9.2
+     */
+    explicit SpinLock( const bool park )
+        : _state( 0 ), _park( park ), _profile( 0 ) {}
+
+    /**
+     * Construct a new named lock.
+     *
+     * @param name the name used for lock profiling.
+     * @param park true to block contended threads after spinning and yielding.
+     * @version 1.9.2
+     */
+    explicit SpinLock( const char* name, const bool park = false )
+        : _state( 0 ), _park( park ), _profile( LockProfile::create( name )) {}
 
     /** Destruct the lock. @version 1.0 */
-    LUNCHBOX_API ~SpinLock();
+    ~SpinLock() { delete _profile; }
 
     /** Acquire the lock exclusively. @version 1.0 */
-    LUNCHBOX_API void set();
+    void set()
+        {
+            if( LB_UNLIKELY( !_trySet( )))
+                _wait( true );
+            else if( LB_UNLIKELY( _profile != 0 ))
+                _profile->acquired( true );
+        }
 
     /** Release an exclusive lock. @version 1.0 */
-    LUNCHBOX_API void unset();
+    void unset()
+        {
+            LBASSERT( isSetWrite( ));
+            if( LB_UNLIKELY( _profile != 0 ))
+                _profile->released();
+            if( !_park )
+                Atomic< int32_t >::storeRelease( _state, 0 );
+            else if( Atomic< int32_t >::getAndSub( _state, WRITE_LOCKED,
+                                                   ORDER_RELEASE ) & PARKED )
+            {
+                _wake();
+            }
+        }
 
     /**
      * Attempt to acquire the lock exclusively.
@@ -56,13 +106,35 @@ public:
      * @return true if the lock was set, false if it was not set.
      * @version 1.0
      */
-    LUNCHBOX_API bool trySet();
+    bool trySet()
+        {
+            if( !_trySet( ))
+                return false;
+            if( LB_UNLIKELY( _profile != 0 ))
+                _profile->acquired( true );
+            return true;
+        }
 
     /** Acquire the lock shared with other readers. @version 1.1.2 */
-    LUNCHBOX_API void setRead();
+    void setRead()
+        {
+            if( LB_UNLIKELY( !_trySetRead( )))
+                _wait( false );
+            else if( LB_UNLIKELY( _profile != 0 ))
+                _profile->acquired( false );
+        }
 
     /** Release a shared read lock. @version 1.1.2 */
-    LUNCHBOX_API void unsetRead();
+    void unsetRead()
+        {
+            LBASSERT( isSetRead( ));
+            if( Atomic< int32_t >::getAndSub( _state, READ_LOCKED,
+                                              ORDER_RELEASE ) ==
+                ( READ_LOCKED | PARKED ))
+            {
+                _wake(); // last reader
+            }
+        }
 
     /**
      * Attempt to acquire the lock shared with other readers.
@@ -70,7 +142,14 @@ public:
      * @return true if the lock was set, false if it was not set.
      * @version 1.1.2
      */
-    LUNCHBOX_API bool trySetRead();
+    bool trySetRead()
+        {
+            if( !_trySetRead( ))
+                return false;
+            if( LB_UNLIKELY( _profile != 0 ))
+                _profile->acquired( false );
+            return true;
+        }
 
     /**
      * Test if the lock is set.
@@ -78,7 +157,8 @@ public:
      * @return true if the lock is set, false if it is not set.
      * @version 1.0
      */
-    LUNCHBOX_API bool isSet();
+    bool isSet()
+        { return ( Atomic< int32_t >::loadAcquire( _state ) & ~PARKED ) != 0; }
 
     /**
      * Test if the lock is set exclusively.
@@ -86,7 +166,11 @@ public:
      * @return true if the lock is set, false if it is not set.
      * @version 1.1.2
      */
-    LUNCHBOX_API bool isSetWrite();
+    bool isSetWrite()
+        {
+            return ( Atomic< int32_t >::loadAcquire( _state ) &
+                     WRITE_LOCKED ) != 0;
+        }
 
     /**
      * Test if the lock is set shared.
@@ -94,10 +178,48 @@ public:
      * @return true if the lock is set, false if it is not set.
      * @version 1.1.2
      */
-    LUNCHBOX_API bool isSetRead();
+    bool isSetRead()
+        { return Atomic< int32_t >::loadAcquire( _state ) >= READ_LOCKED; }
 
 private:
-    detail::SpinLock* const _impl;
+    enum
+    {
+        WRITE_LOCKED = 1,
+        PARKED = 2, // threads block on the state, only set if _park
+        READ_LOCKED = 4 // increment per reader
+    };
+
+    int32_t _state;
+    const bool _park;
+    LockProfile* const _profile;
+
+    bool _trySet()
+        {
+            const int32_t state = Atomic< int32_t >::load( _state,
+                                                           ORDER_RELAXED );
+            return ( state & ~PARKED ) == 0 &&
+                   Atomic< int32_t >::compareAndSwap( &_state, state,
+                                                      state | WRITE_LOCKED,
+                                                      ORDER_ACQUIRE );
+        }
+
+    bool _trySetRead()
+        {
+            const int32_t state = Atomic< int32_t >::load( _state,
+                                                           ORDER_RELAXED );
+            return ( state & WRITE_LOCKED ) == 0 &&
+                   Atomic< int32_t >::compareAndSwap( &_state, state,
+                                                      state + READ_LOCKED,
+                                                      ORDER_ACQUIRE );
+        }
+
+    /** Spin, yield and park until the lock is acquired. */
+    LUNCHBOX_API void _wait( bool write );
+
+    /** Wake all parked threads. */
+    LUNCHBOX_API void _wake();
+
+    void _sleep( int32_t state );
 };
 }
 #endif //LUNCHBOX_SPINLOCK_H
@@ -238,7 +238,7 @@ void Thread::yield()
 void Thread::pinCurrentThread()
 {
 #ifdef LB_WIN32_THREAD_AFFINITY
-    static Lock lock;
+    static Lock lock( "lunchbox::Thread" );
     ScopedMutex<> mutex( lock );
 
     static DWORD_PTR processMask = 0;
@@ -0,0 +1,280 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "threadPool.h"
+
+#include "atomic.h"
+#include "condition.h"
+#include "debug.h"
+#include "mtQueue.h"
+#include "perThread.h"
+#include "thread.h"
+#include "workStealingDeque.h"
+#include "detail/cpu.h"
+
+namespace lunchbox
+{
+namespace detail
+{
+class Worker;
+typedef lunchbox::ThreadPool::Task Task;
+
+class ThreadPool
+{
+public:
+    ThreadPool()
+        : pending( 0 ), idle( 0 ), condition( "lunchbox::ThreadPool" )
+        , running( true ), waiting( 0 ), done( "lunchbox::ThreadPool::done" )
+    {}
+
+    Task* getTask( Worker* self );
+    void notify();
+    bool park();
+    void stop();
+
+    std::vector< Worker* > workers;
+    MTQueue< Task* > injected; // tasks posted from non-worker threads
+    lunchbox::PerThread< Worker, perThreadNoDelete > current;
+
+    a_int32_t pending; // posted but not yet taken tasks
+    a_int32_t idle; // workers parked on condition
+    lunchbox::Condition condition;
+    bool running; // protected by condition
+
+    a_int32_t waiting; // non-worker threads waiting on a future
+    lunchbox::Condition done; // signals waiting threads on task completion
+};
+
+class Worker : public lunchbox::Thread
+{
+public:
+    Worker( ThreadPool& pool, const int32_t affinity, const uint32_t seed )
+        : _pool( pool ), _affinity( affinity ), _seed( seed ) {}
+
+    WorkStealingDeque< Task* > deque;
+
+    /** @return a pseudo-random victim index (xorshift) */
+    size_t getVictim()
+    {
+        _seed ^= _seed << 13;
+        _seed ^= _seed >> 17;
+        _seed ^= _seed << 5;
+        return _seed % _pool.workers.size();
+    }
+
+protected:
+    bool init() final
+    {
+        _pool.current = this;
+        if( _affinity != lunchbox::Thread::NONE )
+            lunchbox::Thread::setAffinity( _affinity );
+        return true;
+    }
+
+    void run() final
+    {
+        while( true )
+        {
+            Task* task = _pool.getTask( this );
+            if( task )
+            {
+                (*task)();
+                delete task;
+            }
+            else if( !_pool.park( ))
+                return;
+        }
+    }
+
+private:
+    ThreadPool& _pool;
+    const int32_t _affinity;
+    uint32_t _seed;
+};
+
+Task* ThreadPool::getTask( Worker* self )
+{
+    Task* task = 0;
+    if( self && self->deque.pop( task ))
+    {
+        --pending;
+        return task;
+    }
+
+    if( !injected.isEmpty() && injected.tryPop( task ))
+    {
+        --pending;
+        return task;
+    }
+
+    const size_t nWorkers = workers.size();
+    const size_t start = self ? self->getVictim() : 0;
+    for( size_t i = 0; i < nWorkers; ++i )
+    {
+        Worker* victim = workers[ ( start + i ) % nWorkers ];
+        if( victim != self && victim->deque.steal( task ))
+        {
+            --pending;
+            return task;
+        }
+    }
+    return 0;
+}
+
+void ThreadPool::notify()
+{
+    // Full barrier on read pairs with the increment in park() to not miss a
+    // worker parking concurrently.
+    if( idle > 0 )
+    {
+        condition.lock();
+        condition.signal();
+        condition.unlock();
+    }
+}
+
+bool ThreadPool::park()
+{
+    // Spin and yield briefly before blocking, new work often arrives shortly
+    for( size_t i = 0; i < 128; ++i )
+    {
+        if( pending > 0 )
+            return true;
+        if( i < 64 )
+            spinPause();
+        else
+            lunchbox::Thread::yield();
+    }
+
+    condition.lock();
+    ++idle;
+    while( pending <= 0 && running )
+        condition.wait();
+    --idle;
+    const bool result = pending > 0 || running;
+    condition.unlock();
+    return result;
+}
+
+void ThreadPool::stop()
+{
+    condition.lock();
+    running = false;
+    condition.broadcast();
+    condition.unlock();
+}
+}
+
+ThreadPool::ThreadPool( size_t size, const bool pinned )
+    : _impl( new detail::ThreadPool )
+{
+    const size_t nCores = detail::getNCores();
+    if( size == 0 )
+        size = nCores;
+
+    _impl->workers.reserve( size );
+    for( size_t i = 0; i < size; ++i )
+    {
+        const int32_t affinity = pinned ? Thread::CORE + int32_t( i % nCores )
+                                        : int32_t( Thread::NONE );
+        _impl->workers.push_back( new detail::Worker( *_impl, affinity,
+                                                      uint32_t( i + 1 )));
+    }
+
+    // start after creation, workers steal from each other
+    for( size_t i = 0; i < size; ++i )
+        LBCHECK( _impl->workers[ i ]->start( ));
+}
+
+ThreadPool::~ThreadPool()
+{
+    _impl->stop();
+    for( size_t i = 0; i < _impl->workers.size(); ++i )
+    {
+        _impl->workers[ i ]->join();
+        delete _impl->workers[ i ];
+    }
+    LBASSERT( _impl->injected.isEmpty( ));
+    delete _impl;
+}
+
+size_t ThreadPool::getSize() const
+{
+    return _impl->workers.size();
+}
+
+bool ThreadPool::isWorkerThread() const
+{
+    return _impl->current.get() != 0;
+}
+
+bool ThreadPool::runTask()
+{
+    Task* task = _impl->getTask( _impl->current.get( ));
+    if( !task )
+        return false;
+
+    (*task)();
+    delete task;
+    return true;
+}
+
+void ThreadPool::_post( Task* task )
+{
+    detail::Worker* self = _impl->current.get();
+    if( self )
+        self->deque.push( task );
+    else
+        _impl->injected.push( task );
+
+    ++_impl->pending;
+    _impl->notify();
+}
+
+void ThreadPool::_notifyDone()
+{
+    // Full barrier on read pairs with the increment in _waitDone()
+    if( _impl->waiting > 0 )
+    {
+        _impl->done.lock();
+        _impl->done.broadcast();
+        _impl->done.unlock();
+    }
+}
+
+bool ThreadPool::_waitDone( const a_int32_t& done, const uint32_t timeout )
+{
+    // any finished job broadcasts, continue the wait with the remaining time
+    const bool indefinite = ( timeout == LB_TIMEOUT_INDEFINITE );
+    const int64_t time = timeout == LB_TIMEOUT_DEFAULT ? 300000 /* 5 min */ :
+                                                         timeout;
+    const Clock clock;
+    bool result = true;
+    _impl->done.lock();
+    ++_impl->waiting;
+    while( !done && result )
+    {
+        const int64_t elapsed = indefinite ? 0 : clock.getTime64();
+        const uint32_t remaining = indefinite ? LB_TIMEOUT_INDEFINITE :
+                                                uint32_t( time - elapsed );
+        result = elapsed < time && _impl->done.timedWait( remaining );
+    }
+    --_impl->waiting;
+    _impl->done.unlock();
+    return result || done;
+}
+}
@@ -0,0 +1,226 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_THREADPOOL_H
+#define LUNCHBOX_THREADPOOL_H
+
+#include <lunchbox/api.h>    // LUNCHBOX_API definition
+#include <lunchbox/atomic.h> // used inline
+#include <lunchbox/future.h> // return value
+#include <lunchbox/types.h>
+
+#include <boost/function/function0.hpp>
+#include <boost/utility/result_of.hpp>
+
+namespace lunchbox
+{
+namespace detail { class ThreadPool; }
+
+/**
+ * A pool of worker threads executing tasks with work stealing.
+ *
+ * Each worker thread owns a WorkStealingDeque. Tasks posted from a worker
+ * thread, e.g., child tasks of recursive work, are pushed to the deque of this
+ * worker without taking a lock. Tasks posted from other threads are placed in a
+ * shared injection queue. Idle workers first take work from their own deque,
+ * then from the injection queue and last steal from a randomly chosen worker.
+ * Workers without any work park on a condition variable, which is only
+ * signalled if a worker is parked.
+ *
+ * Waiting on a Future returned by post() from a worker thread executes other
+ * pending tasks while the result is not ready, so that recursive tasks can wait
+ * on their children without exhausting the workers.
+ *
+ * Tasks should not throw exceptions.
+ *
+ * Example: @include tests/threadPool.cpp
+ */
+class ThreadPool : public boost::noncopyable
+{
+public:
+    /** The type of the internal, type-erased tasks. @version 1.9.2 */
+    typedef boost::function< void() > Task;
+
+    /**
+     * Construct and start a new thread pool.
+     *
+     * @param size the number of worker threads, or 0 for one thread per
+     *             online CPU core.
+     * @param pinned if true, bind worker i to core i modulo the number of
+     *               cores using Thread::setAffinity().
+     * @version 1.9.2
+     */
+    LUNCHBOX_API explicit ThreadPool( size_t size = 0, bool pinned = false );
+
+    /**
+     * Destruct the thread pool after executing all pending tasks.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API ~ThreadPool();
+
+    /** @return the number of worker threads. @version 1.9.2 */
+    LUNCHBOX_API size_t getSize() const;
+
+    /**
+     * @return true if the calling thread is a worker of this pool.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API bool isWorkerThread() const;
+
+    /**
+     * Post a new task for asynchronous execution.
+     *
+     * @param func the nullary function object to execute, for example a
+     *             boost::function or the result of boost::bind.
+     * @return a future for the return value of the function.
+     * @version 1.9.2
+     */
+    template< class F >
+    Future< typename boost::result_of< F() >::type > post( const F& func );
+
+    /**
+     * Execute one pending task in the calling thread.
+     *
+     * Used by the futures of this pool to wait cooperatively. Can be used by
+     * other threads to help executing the tasks of this pool.
+     *
+     * @return true if a task was executed, false if no task was found.
+     * @version 1.9.2
+     */
+    LUNCHBOX_API bool runTask();
+
+private:
+    detail::ThreadPool* const _impl;
+
+    template< class T > class Job;
+    template< class T > class Run;
+
+    LUNCHBOX_API void _post( Task* task );
+    LUNCHBOX_API void _notifyDone();
+    LUNCHBOX_API bool _waitDone( const a_int32_t& done, uint32_t timeout );
+};
+}
+
+// Implementation
+
+#include <lunchbox/clock.h>
+#include <lunchbox/thread.h>
+#include <boost/mpl/if.hpp>
+#include <boost/type_traits/is_same.hpp>
+
+namespace lunchbox
+{
+/** @internal The future of a posted function. */
+template< class T > class ThreadPool::Job : public FutureImpl< T >
+{
+    typedef typename
+    boost::mpl::if_< boost::is_same< T, void >, void*, T >::type value_t;
+
+public:
+    typedef boost::function< T() > Func;
+
+    Job( ThreadPool& pool, const Func& func )
+        : _pool( pool ), _func( func ), _result(), _done( 0 ) {}
+    virtual ~Job() {}
+
+    void run()
+    {
+        _result = _func();
+        _func.clear();
+        _done = 1;
+        _pool._notifyDone();
+    }
+
+protected:
+    T wait( const uint32_t timeout ) final
+    {
+        _wait( timeout );
+        return _result;
+    }
+
+    bool isReady() const final { return _done != 0; }
+
+private:
+    ThreadPool& _pool;
+    Func _func;
+    value_t _result;
+    a_int32_t _done;
+
+    void _wait( const uint32_t timeout )
+    {
+        if( _done )
+            return;
+
+        if( !_pool.isWorkerThread( ))
+        {
+            if( !_pool._waitDone( _done, timeout ))
+                throw FutureTimeout();
+            return;
+        }
+
+        // Do not block a worker, execute other tasks until the result is ready
+        const Clock clock;
+        while( !_done )
+        {
+            if( _pool.runTask( ))
+                continue;
+            if( timeout != LB_TIMEOUT_INDEFINITE &&
+                clock.getTime64() >= int64_t( timeout ))
+            {
+                throw FutureTimeout();
+            }
+            Thread::yield();
+        }
+    }
+};
+
+template<> inline void ThreadPool::Job< void >::run()
+{
+    _func();
+    _func.clear();
+    _done = 1;
+    _pool._notifyDone();
+}
+
+template<> inline void ThreadPool::Job< void >::wait( const uint32_t timeout )
+{
+    _wait( timeout );
+}
+
+/** @internal Task executing a Job. */
+template< class T > class ThreadPool::Run
+{
+public:
+    explicit Run( const RefPtr< Job< T > >& job ) : _job( job ) {}
+    void operator()() { _job->run(); }
+
+private:
+    RefPtr< Job< T > > _job;
+};
+
+template< class F > inline
+Future< typename boost::result_of< F() >::type > ThreadPool::post(
+    const F& func )
+{
+    typedef typename boost::result_of< F() >::type T;
+    RefPtr< Job< T > > job = new Job< T >( *this, func );
+    _post( new Task( Run< T >( job )));
+    return Future< T >( job );
+}
+}
+
+#endif // LUNCHBOX_THREADPOOL_H
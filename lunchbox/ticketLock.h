@@ -0,0 +1,119 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_TICKETLOCK_H
+#define LUNCHBOX_TICKETLOCK_H
+
+#include <lunchbox/atomic.h>         // used in inline method
+#include <lunchbox/debug.h>          // used in inline method
+#include <lunchbox/thread.h>         // used in inline method
+#include <boost/noncopyable.hpp>
+
+namespace lunchbox
+{
+/**
+ * A fair spin lock granting the lock in request order.
+ *
+ * Each thread draws a ticket by incrementing a counter and waits until the
+ * ticket is served. Waiting threads pause proportionally to their position in
+ * the queue, and yield their time slice after a while. Unlike SpinLock, no
+ * thread can overtake another, which bounds the waiting time. All waiting
+ * threads spin on the same cache line, so the lock scales worse than MCSLock
+ * with many waiting threads.
+ *
+ * If more threads than cores wait on the lock, the throughput drops sharply
+ * since the thread owning the next ticket may not be scheduled.
+ *
+ * @sa ScopedMutex, MCSLock
+ *
+ * Example: @include tests/lock.cpp
+ */
+class TicketLock : public boost::noncopyable
+{
+public:
+    /** Construct a new lock. @version 1.9.2 */
+    TicketLock() : _next( 0 ), _serving( 0 ) {}
+
+    /** Destruct the lock. @version 1.9.2 */
+    ~TicketLock() {}
+
+    /** Acquire the lock. @version 1.9.2 */
+    void set()
+        {
+            const uint32_t ticket =
+                uint32_t( Atomic< int32_t >::getAndAdd( _next, 1,
+                                                        ORDER_RELAXED ));
+            for( uint32_t i = 0; ; ++i )
+            {
+                const uint32_t ahead = ticket - uint32_t(
+                    Atomic< int32_t >::loadAcquire( _serving ));
+                if( ahead == 0 )
+                    return;
+
+                if( i < nSpins )
+                {
+                    for( uint32_t j = 0; j < ahead; ++j )
+                        spinPause();
+                }
+                else
+                    Thread::yield();
+            }
+        }
+
+    /** Release the lock. @version 1.9.2 */
+    void unset()
+        {
+            LBASSERT( isSet( ));
+            Atomic< int32_t >::storeRelease( _serving,
+                                    int32_t( uint32_t( _serving ) + 1 ));
+        }
+
+    /**
+     * Attempt to acquire the lock.
+     *
+     * @return true if the lock was set, false if it was not set.
+     * @version 1.9.2
+     */
+    bool trySet()
+        {
+            const int32_t serving = Atomic< int32_t >::loadAcquire( _serving );
+            return Atomic< int32_t >::load( _next, ORDER_RELAXED ) == serving &&
+                   Atomic< int32_t >::compareAndSwap( &_next, serving,
+                                    int32_t( uint32_t( serving ) + 1 ),
+                                    ORDER_RELAXED );
+        }
+
+    /**
+     * Test if the lock is set.
+     *
+     * @return true if the lock is set, false if it is not set.
+     * @version 1.9.2
+     */
+    bool isSet()
+        {
+            return Atomic< int32_t >::loadAcquire( _next ) !=
+                   Atomic< int32_t >::loadAcquire( _serving );
+        }
+
+private:
+    enum { nSpins = 64 }; // backoff rounds before yielding
+
+    int32_t _next; // the next ticket drawn
+    int32_t _serving; // the ticket owning the lock, written by the owner
+};
+}
+#endif // LUNCHBOX_TICKETLOCK_H
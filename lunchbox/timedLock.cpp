@@ -17,8 +17,11 @@
 
 #include "timedLock.h"
 
-#include "condition.h"
+#include "atomic.h"
+#include "clock.h"
 #include "debug.h"
+#include "futex.h"
+#include "lockProfile.h"
 
 namespace lunchbox
 {
@@ -27,14 +30,63 @@ namespace detail
 class TimedLock
 {
 public:
-    TimedLock() : locked( false ) {}
-    lunchbox::Condition condition;
-    bool locked;
+    enum State
+    {
+        UNLOCKED = 0,
+        LOCKED,
+        CONTENDED // locked, threads may block in futexWait
+    };
+
+    explicit TimedLock( const char* name )
+        : state( UNLOCKED )
+        , waiters( 0 )
+        , profile( lunchbox::LockProfile::create( name ))
+    {}
+    ~TimedLock() { delete profile; }
+
+    bool trySet()
+    {
+        return Atomic< int32_t >::compareAndSwap( &state, UNLOCKED, LOCKED,
+                                                  ORDER_ACQUIRE );
+    }
+
+    /** Set the contended state. @return true if the lock was acquired. */
+    bool setContended()
+    {
+        return Atomic< int32_t >::getAndSet( state, CONTENDED,
+                                             ORDER_ACQUIRE ) == UNLOCKED;
+    }
+
+    /**
+     * Leave the contended path, after acquiring the lock or on timeout.
+     *
+     * The last waiter resets the state of an acquired lock to LOCKED, so that
+     * later unset() calls do not wake anybody. The reset is undone if a new
+     * waiter registered concurrently, which might be blocked on CONTENDED.
+     */
+    void leaveContended( const bool acquired )
+    {
+        if( Atomic< int32_t >::getAndSub( waiters, 1 ) != 1 || !acquired )
+            return;
+        if( Atomic< int32_t >::compareAndSwap( &state, CONTENDED, LOCKED ) &&
+            Atomic< int32_t >::loadAcquire( waiters ) > 0 )
+        {
+            Atomic< int32_t >::getAndSet( state, CONTENDED, ORDER_RELAXED );
+        }
+    }
+
+    int32_t state;
+    int32_t waiters; // threads in the contended path of set()
+    lunchbox::LockProfile* const profile;
 };
 }
 
 TimedLock::TimedLock()
-        : _impl( new detail::TimedLock )
+        : _impl( new detail::TimedLock( 0 ))
+{}
+
+TimedLock::TimedLock( const char* name )
+        : _impl( new detail::TimedLock( name ))
 {}
 
 TimedLock::~TimedLock()
@@ -44,55 +96,72 @@ TimedLock::~TimedLock()
 
 bool TimedLock::set( const uint32_t timeout )
 {
-    _impl->condition.lock();
+    if( _impl->trySet( ))
+    {
+        if( _impl->profile )
+            _impl->profile->acquired( true );
+        return true;
+    }
 
-    bool acquired = true;
-    while( _impl->locked )
+    const uint64_t start = _impl->profile ? LockProfile::getTime() : 0;
+    // The contended state stays set while threads wait, which makes all unset()
+    // calls wake a waiting thread. The last waiter resets it on acquisition.
+    const Clock clock;
+    Atomic< int32_t >::getAndAdd( _impl->waiters, 1 );
+    while( !_impl->setContended( ))
     {
-        if( !_impl->condition.timedWait( timeout ))
+        if( timeout == LB_TIMEOUT_INDEFINITE )
         {
-            acquired = false;
-            break;
+            futexWait( &_impl->state, detail::TimedLock::CONTENDED );
+            continue;
         }
-    }
 
-    if( acquired )
-    {
-        LBASSERT( !_impl->locked );
-        _impl->locked = true;
+        const uint32_t time = timeout == LB_TIMEOUT_DEFAULT ?
+                              300000 /* 5 min */ : timeout;
+        const int64_t elapsed = clock.getTime64();
+        if( elapsed >= int64_t( time ) ||
+            !futexWait( &_impl->state, detail::TimedLock::CONTENDED,
+                        uint32_t( time - elapsed )))
+        {
+            _impl->leaveContended( false );
+            return false;
+        }
     }
-
-    _impl->condition.unlock();
-    return acquired;
+    _impl->leaveContended( true );
+    if( _impl->profile )
+        _impl->profile->acquired( true, start );
+    return true;
 }
 
 void TimedLock::unset()
 {
-    _impl->condition.lock();
-    _impl->locked = false;
-    _impl->condition.signal();
-    _impl->condition.unlock();
+    LBASSERT( isSet( ));
+    if( _impl->profile )
+        _impl->profile->released();
+
+    // The lock may be destroyed by another thread once it is released
+    int32_t* const word = &_impl->state;
+    if( Atomic< int32_t >::getAndSub( *word, 1, ORDER_RELEASE ) !=
+        detail::TimedLock::LOCKED )
+    {
+        Atomic< int32_t >::storeRelease( *word, detail::TimedLock::UNLOCKED );
+        futexWakeOne( word );
+    }
 }
 
-
 bool TimedLock::trySet()
 {
-    _impl->condition.lock();
-    
-    bool acquired = false;
-    if( _impl->locked )
-    {
-        _impl->locked  = true;
-        acquired = true;
-    }
-
-    _impl->condition.unlock();
-    return acquired;
+    if( !_impl->trySet( ))
+        return false;
+    if( _impl->profile )
+        _impl->profile->acquired( true );
+    return true;
 }
 
 bool TimedLock::isSet()
 {
-    return _impl->locked;
+    return Atomic< int32_t >::loadAcquire( _impl->state ) !=
+           detail::TimedLock::UNLOCKED;
 }
 
 }
@@ -38,6 +38,15 @@ public:
     /** Construct a new timed lock. @version 1.0 */
     LUNCHBOX_API TimedLock();
 
+    /**
+     * Construct a new named timed lock.
+     *
+     * @param name the name used for lock profiling.
+     * @sa LockProfile
+     * @version 1.9.2
+     */
+    LUNCHBOX_API explicit TimedLock( const char* name );
+
     /** Destruct the lock. @version 1.0 */
     LUNCHBOX_API ~TimedLock();
 
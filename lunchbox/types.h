@@ -222,6 +222,7 @@ typedef std::vector< std::string > Strings;
 typedef Strings::const_iterator StringsCIter;
 typedef Strings::iterator StringsIter;
 
+class BufferPool;
 class Clock;
 class Lock;
 class NonCopyable;
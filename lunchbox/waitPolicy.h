@@ -0,0 +1,84 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_WAITPOLICY_H
+#define LUNCHBOX_WAITPOLICY_H
+
+#include <lunchbox/atomic.h>   // used inline
+#include <lunchbox/types.h>
+#include <ostream>
+
+namespace lunchbox
+{
+/**
+ * How a thread waits for a condition to become true.
+ *
+ * The thread first re-checks the condition nSpins times with a CPU pause in
+ * between, then nYields times after yielding its time slice, and finally
+ * blocks until it is woken. Spinning pays off if the condition typically
+ * becomes true within a few microseconds and the signaling thread runs on
+ * another core. The default policy blocks immediately.
+ *
+ * @sa Monitor::setWaitPolicy(), WaitStats
+ */
+struct WaitPolicy
+{
+    /** Construct a new wait policy. @version 1.9.2 */
+    explicit WaitPolicy( const uint32_t spins = 0, const uint32_t yields = 0 )
+        : nSpins( spins ), nYields( yields ) {}
+
+    uint32_t nSpins; //!< Number of pause-and-recheck iterations
+    uint32_t nYields; //!< Number of yield-and-recheck iterations
+};
+
+/**
+ * Counts in which phase of a WaitPolicy waits were satisfied.
+ *
+ * Waits satisfied without waiting in the caller's lock-free fast path are not
+ * counted.
+ */
+struct WaitStats
+{
+    /** Construct new, zero statistics. @version 1.9.2 */
+    WaitStats() : spun( 0 ), yielded( 0 ), blocked( 0 ), timedOut( 0 ) {}
+
+    /** @return a copy of concurrently updated statistics. @internal */
+    WaitStats snapshot() const
+    {
+        WaitStats stats;
+        stats.spun = Atomic< ssize_t >::load( spun, ORDER_RELAXED );
+        stats.yielded = Atomic< ssize_t >::load( yielded, ORDER_RELAXED );
+        stats.blocked = Atomic< ssize_t >::load( blocked, ORDER_RELAXED );
+        stats.timedOut = Atomic< ssize_t >::load( timedOut, ORDER_RELAXED );
+        return stats;
+    }
+
+    ssize_t spun; //!< Waits satisfied while spinning
+    ssize_t yielded; //!< Waits satisfied while yielding
+    ssize_t blocked; //!< Waits satisfied after blocking
+    ssize_t timedOut; //!< Timed waits which failed
+};
+
+/** Print the wait statistics to the given output stream. @version 1.9.2 */
+inline std::ostream& operator << ( std::ostream& os, const WaitStats& stats )
+{
+    return os << "spun " << stats.spun << " yielded " << stats.yielded
+              << " blocked " << stats.blocked << " timed out "
+              << stats.timedOut;
+}
+}
+#endif // LUNCHBOX_WAITPOLICY_H
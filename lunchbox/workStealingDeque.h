@@ -0,0 +1,116 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_WORKSTEALINGDEQUE_H
+#define LUNCHBOX_WORKSTEALINGDEQUE_H
+
+#include <lunchbox/atomic.h>       // used inline
+#include <lunchbox/debug.h>        // used in inline method
+#include <lunchbox/thread.h>       // thread-safety checks
+
+#include <vector>
+
+namespace lunchbox
+{
+/**
+ * A lock-free, unbounded work-stealing deque (Chase-Lev).
+ *
+ * The owning thread pushes and pops elements at the bottom of the deque in LIFO
+ * order. Any other thread may steal elements from the top in FIFO order. The
+ * owner only synchronizes with thieves when the deque has at most one element.
+ *
+ * Current implementation constraints:
+ * * One owner thread for push() and pop(), any number of threads for steal()
+ * * Elements are read speculatively by thieves, and should therefore be
+ *   pointers or small, trivially copyable types
+ * * The storage grows when full, but never shrinks until destruction
+ * * Not copyable
+ *
+ * Example: @include tests/threadPool.cpp
+ */
+template< typename T > class WorkStealingDeque : public boost::noncopyable
+{
+public:
+    typedef T value_type;
+
+    /** Construct a new deque of the given initial size. @version 1.9.2 */
+    explicit WorkStealingDeque( const size_t size = 64 );
+
+    /** Destruct this deque. @version 1.9.2 */
+    ~WorkStealingDeque();
+
+    /**
+     * @return true if the deque is empty, false otherwise. The result is a
+     *         snapshot when used concurrently.
+     * @version 1.9.2
+     */
+    bool isEmpty() const { return getSize() == 0; }
+
+    /**
+     * @return the number of elements in the deque. The result is a snapshot
+     *         when used concurrently.
+     * @version 1.9.2
+     */
+    size_t getSize() const;
+
+    /**
+     * Push a new element to the bottom of the deque. Owner thread only.
+     *
+     * @param element the element to add.
+     * @version 1.9.2
+     */
+    void push( const T& element );
+
+    /**
+     * Retrieve and pop the bottom element of the deque. Owner thread only.
+     *
+     * @param result the bottom value or unmodified
+     * @return true if an element was placed in result, false if the deque
+     *         is empty.
+     * @version 1.9.2
+     */
+    bool pop( T& result );
+
+    /**
+     * Retrieve and pop the top element of the deque. Thread-safe.
+     *
+     * @param result the top value or unmodified
+     * @return true if an element was placed in result, false if the deque
+     *         is empty or another thread took the top element concurrently.
+     * @version 1.9.2
+     */
+    bool steal( T& result );
+
+private:
+    class Array;
+
+    char _pad0[ LB_CACHELINE_SIZE ];
+    ssize_t _top;
+    char _pad1[ LB_CACHELINE_SIZE ];
+    ssize_t _bottom;
+    Array* _array;
+    char _pad2[ LB_CACHELINE_SIZE ];
+
+    std::vector< Array* > _retired; // grown arrays, may still be read
+
+    LB_TS_VAR( _owner );
+};
+}
+
+#include "workStealingDeque.ipp" // template implementation
+
+#endif // LUNCHBOX_WORKSTEALINGDEQUE_H
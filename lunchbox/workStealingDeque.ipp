@@ -0,0 +1,142 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+namespace lunchbox
+{
+/** A circular array of power-of-two size, indexed by unbounded positions. */
+template< typename T > class WorkStealingDeque< T >::Array
+{
+public:
+    explicit Array( const size_t size )
+        : _mask( size - 1 ), _data( new T[ size ] )
+    {
+        LBASSERT(( size & _mask ) == 0 );
+    }
+
+    ~Array() { delete [] _data; }
+
+    size_t getSize() const { return _mask + 1; }
+    T get( const ssize_t i ) const { return _data[ i & _mask ]; }
+    void put( const ssize_t i, const T& element )
+        { _data[ i & _mask ] = element; }
+
+    Array* grow( const ssize_t top, const ssize_t bottom ) const
+    {
+        Array* array = new Array( getSize() << 1 );
+        for( ssize_t i = top; i < bottom; ++i )
+            array->put( i, get( i ));
+        return array;
+    }
+
+private:
+    const ssize_t _mask;
+    T* const _data;
+};
+
+template< typename T >
+WorkStealingDeque< T >::WorkStealingDeque( const size_t size )
+    : _top( 0 )
+    , _bottom( 0 )
+    , _array( 0 )
+{
+    LBASSERT( size > 0 );
+    size_t ringSize = 2;
+    while( ringSize < size )
+        ringSize <<= 1;
+    _array = new Array( ringSize );
+    memoryBarrier();
+}
+
+template< typename T > WorkStealingDeque< T >::~WorkStealingDeque()
+{
+    delete _array;
+    for( size_t i = 0; i < _retired.size(); ++i )
+        delete _retired[ i ];
+}
+
+template< typename T > size_t WorkStealingDeque< T >::getSize() const
+{
+    const ssize_t top = Atomic< ssize_t >::loadAcquire( _top );
+    const ssize_t bottom = Atomic< ssize_t >::loadAcquire( _bottom );
+    return bottom > top ? bottom - top : 0;
+}
+
+template< typename T > void WorkStealingDeque< T >::push( const T& element )
+{
+    LB_TS_SCOPED( _owner );
+    const ssize_t bottom = _bottom;
+    const ssize_t top = Atomic< ssize_t >::loadAcquire( _top );
+    Array* array = _array;
+
+    if( bottom - top >= ssize_t( array->getSize( )))
+    {
+        // Thieves may still read from the old array, retire it until dtor
+        _retired.push_back( array );
+        array = array->grow( top, bottom );
+        Atomic< Array* >::storeRelease( _array, array );
+    }
+
+    array->put( bottom, element );
+    Atomic< ssize_t >::storeRelease( _bottom, bottom + 1 );
+}
+
+template< typename T > bool WorkStealingDeque< T >::pop( T& result )
+{
+    LB_TS_SCOPED( _owner );
+    const ssize_t bottom = _bottom - 1;
+    Array* array = _array;
+    _bottom = bottom;
+    memoryBarrier(); // store bottom before loading top, pairs with steal()
+    const ssize_t top = _top;
+
+    if( top > bottom ) // empty
+    {
+        _bottom = bottom + 1;
+        return false;
+    }
+
+    const T element = array->get( bottom );
+    if( top == bottom ) // last element, race against thieves for it
+    {
+        const bool won = Atomic< ssize_t >::compareAndSwap( &_top, top,
+                                                            top + 1 );
+        Atomic< ssize_t >::storeRelease( _bottom, bottom + 1 );
+        if( !won )
+            return false;
+    }
+    result = element;
+    return true;
+}
+
+template< typename T > bool WorkStealingDeque< T >::steal( T& result )
+{
+    const ssize_t top = Atomic< ssize_t >::loadAcquire( _top );
+    memoryBarrier(); // load top before bottom, pairs with pop()
+    const ssize_t bottom = Atomic< ssize_t >::loadAcquire( _bottom );
+
+    if( top >= bottom )
+        return false;
+
+    const Array* array = Atomic< Array* >::loadAcquire( _array );
+    const T element = array->get( top );
+    if( !Atomic< ssize_t >::compareAndSwap( &_top, top, top + 1 ))
+        return false;
+
+    result = element;
+    return true;
+}
+}
@@ -0,0 +1,156 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <test.h>
+#include <lunchbox/arena.h>
+#include <lunchbox/clock.h>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#define NFRAMES 2000
+#define NOBJECTS 1000
+
+namespace
+{
+typedef std::map< int, int, std::less< int >,
+                  lunchbox::ArenaAllocator< std::pair< const int, int > > >
+    ArenaMap;
+typedef std::vector< int, lunchbox::ArenaAllocator< int > > ArenaVector;
+
+void _testArena()
+{
+    lunchbox::Arena arena( 4096 );
+    TEST( arena.getCapacity() == 0 );
+
+    uint8_t* first = static_cast< uint8_t* >( arena.allocate( 10 ));
+    TEST( first );
+    TEST( arena.getCapacity() == 4096 );
+    for( size_t alignment = 1; alignment <= 256; alignment <<= 1 )
+    {
+        uint8_t* data = static_cast< uint8_t* >( arena.allocate( 3,
+                                                                 alignment ));
+        TESTINFO(( uintptr_t( data ) & ( alignment - 1 )) == 0, alignment );
+        TEST( data >= first + 10 );
+    }
+    double* values = arena.allocate< double >( 4 );
+    TEST(( uintptr_t( values ) & ( sizeof( double ) - 1 )) == 0 );
+
+    // large allocations get their own chunk, the current one stays in use
+    uint8_t* large = static_cast< uint8_t* >( arena.allocate( 10000 ));
+    ::memset( large, 0, 10000 );
+    TEST( arena.getCapacity() > 4096 + 10000 );
+    uint8_t* small = static_cast< uint8_t* >( arena.allocate( 16 ));
+    TEST( small > first && small < first + 4096 );
+
+    // chained chunks
+    for( size_t i = 0; i < 100; ++i )
+        ::memset( arena.allocate( 100 ), 0, 100 );
+    TEST( arena.getCapacity() > 3 * 4096 );
+
+    // reset keeps standard chunks
+    arena.reset();
+    TEST( arena.getCapacity() == 0 );
+    TEST( arena.allocate( 10 ));
+    TEST( arena.getCapacity() == 4096 );
+
+    arena.clear();
+    TEST( arena.getCapacity() == 0 );
+
+    {
+        const lunchbox::ArenaAllocator< int > allocator( arena );
+        ArenaVector vector( allocator );
+        for( int i = 0; i < 1000; ++i )
+            vector.push_back( i );
+        TEST( vector[ 999 ] == 999 );
+
+        ArenaMap map( std::less< int >(), allocator );
+        for( int i = 0; i < 1000; ++i )
+            map[ i ] = -i;
+        TEST( map.size() == 1000 );
+        TEST( map[ 500 ] == -500 );
+        TEST( map.get_allocator() == vector.get_allocator( ));
+    }
+    arena.reset();
+}
+
+void _testPerformance()
+{
+    std::cout << "operation, ns/object" << std::endl;
+    static const size_t sizes[] = { 16, 24, 32, 48, 64, 96, 128, 40 };
+    void* objects[ NOBJECTS ];
+
+    lunchbox::Clock clock;
+    for( size_t i = 0; i < NFRAMES; ++i )
+    {
+        for( size_t j = 0; j < NOBJECTS; ++j )
+        {
+            objects[j] = ::malloc( sizes[ j % 8 ] );
+            *static_cast< uint8_t* >( objects[j] ) = uint8_t( j );
+        }
+        for( size_t j = 0; j < NOBJECTS; ++j )
+            ::free( objects[j] );
+    }
+    const float mallocTime = clock.resetTimef();
+
+    lunchbox::Arena arena;
+    for( size_t i = 0; i < NFRAMES; ++i )
+    {
+        for( size_t j = 0; j < NOBJECTS; ++j )
+        {
+            objects[j] = arena.allocate( sizes[ j % 8 ] );
+            *static_cast< uint8_t* >( objects[j] ) = uint8_t( j );
+        }
+        arena.reset();
+    }
+    const float arenaTime = clock.resetTimef();
+
+    for( size_t i = 0; i < NFRAMES; ++i )
+    {
+        std::map< int, int > map;
+        for( int j = 0; j < NOBJECTS; ++j )
+            map[ j ] = j;
+    }
+    const float mapTime = clock.resetTimef();
+
+    const ArenaMap::allocator_type allocator( arena );
+
+    for( size_t i = 0; i < NFRAMES; ++i )
+    {
+        {
+            ArenaMap map( std::less< int >(), allocator );
+            for( int j = 0; j < NOBJECTS; ++j )
+                map[ j ] = j;
+        }
+        arena.reset();
+    }
+    const float arenaMapTime = clock.resetTimef();
+
+    const float scale = 1000000.f / float( NFRAMES * NOBJECTS );
+    std::cout << "   malloc/free, " << mallocTime * scale << std::endl
+              << "   Arena/reset, " << arenaTime * scale << std::endl
+              << "      std::map, " << mapTime * scale << std::endl
+              << "ArenaAllocator, " << arenaMapTime * scale << std::endl;
+}
+}
+
+int main( int, char** )
+{
+    _testArena();
+    _testPerformance();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,115 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <test.h>
+#include <lunchbox/atomic.h>
+#include <lunchbox/clock.h>
+#include <iostream>
+
+#define NOPS 10000000
+
+using lunchbox::Atomic;
+
+namespace
+{
+int32_t _value = 0;
+
+void _print( const char* name, const float time )
+{
+    std::cout << std::setw( 28 ) << name << ", " << std::setw( 8 )
+              << time * 1000000.f / float( NOPS ) << std::endl;
+}
+
+void _testOperations()
+{
+    int32_t value = 0;
+    Atomic< int32_t >::store( value, 42, lunchbox::ORDER_RELAXED );
+    TEST( Atomic< int32_t >::load( value, lunchbox::ORDER_ACQUIRE ) == 42 );
+    TEST( Atomic< int32_t >::getAndAdd( value, 2,
+                                        lunchbox::ORDER_RELAXED ) == 42 );
+    TEST( Atomic< int32_t >::getAndSub( value, 4,
+                                        lunchbox::ORDER_RELEASE ) == 44 );
+    TEST( Atomic< int32_t >::getAndSet( value, 7,
+                                        lunchbox::ORDER_ACQ_REL ) == 40 );
+    TEST( !Atomic< int32_t >::compareAndSwap( &value, 40, 8,
+                                              lunchbox::ORDER_ACQUIRE ));
+    TEST( Atomic< int32_t >::compareAndSwap( &value, 7, 8,
+                                             lunchbox::ORDER_SEQ_CST ));
+    TEST( Atomic< int32_t >::load( value, lunchbox::ORDER_SEQ_CST ) == 8 );
+
+    lunchbox::a_ssize_t atomic( 17 );
+    atomic = 18;
+    TEST( atomic == 18 );
+    lunchbox::memoryBarrier( lunchbox::ORDER_ACQ_REL );
+}
+
+void _testPerformance()
+{
+    std::cout << "operation, ns/op" << std::endl;
+    lunchbox::Clock clock;
+    for( size_t i = 0; i < NOPS; ++i )
+        Atomic< int32_t >::getAndAdd( _value, 1 );
+    _print( "getAndAdd seq_cst", clock.resetTimef( ));
+
+    for( size_t i = 0; i < NOPS; ++i )
+        Atomic< int32_t >::getAndAdd( _value, 1, lunchbox::ORDER_RELAXED );
+    _print( "getAndAdd relaxed", clock.resetTimef( ));
+    TEST( _value == 2 * NOPS );
+
+    // the store and load of Atomic before explicit memory orders
+    for( size_t i = 0; i < NOPS; ++i )
+    {
+        *static_cast< volatile int32_t* >( &_value ) = int32_t( i );
+        lunchbox::memoryBarrier();
+    }
+    _print( "store, full barrier", clock.resetTimef( ));
+
+    for( size_t i = 0; i < NOPS; ++i )
+        Atomic< int32_t >::store( _value, int32_t( i ),
+                                  lunchbox::ORDER_SEQ_CST );
+    _print( "store seq_cst", clock.resetTimef( ));
+
+    for( size_t i = 0; i < NOPS; ++i )
+        Atomic< int32_t >::store( _value, int32_t( i ),
+                                  lunchbox::ORDER_RELEASE );
+    _print( "store release", clock.resetTimef( ));
+
+    uint64_t sum = 0;
+    for( size_t i = 0; i < NOPS; ++i )
+    {
+        lunchbox::memoryBarrierAcquire();
+        sum += *static_cast< volatile int32_t* >( &_value );
+    }
+    _print( "acquire barrier, load", clock.resetTimef( ));
+
+    for( size_t i = 0; i < NOPS; ++i )
+        sum += Atomic< int32_t >::load( _value, lunchbox::ORDER_ACQUIRE );
+    _print( "load acquire", clock.resetTimef( ));
+
+    for( size_t i = 0; i < NOPS; ++i )
+        sum += Atomic< int32_t >::load( _value, lunchbox::ORDER_RELAXED );
+    _print( "load relaxed", clock.resetTimef( ));
+    TEST( sum == 3 * uint64_t( NOPS - 1 ) * NOPS );
+}
+}
+
+int main( int, char** )
+{
+    _testOperations();
+    _testPerformance();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,185 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define TEST_RUNTIME 300 // seconds
+#include <test.h>
+#include <lunchbox/barrier.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/latch.h>
+#include <lunchbox/monitor.h>
+#include <lunchbox/thread.h>
+#include <iostream>
+
+#define MAXTHREADS 64
+#define NPHASES 2000
+
+namespace
+{
+/** The equivalent barrier using a counting monitor */
+class MonitorBarrier
+{
+public:
+    explicit MonitorBarrier( const uint32_t size ) : _size( size ) {}
+
+    void enter( const uint32_t phase )
+    {
+        ++_count;
+        _count.waitGE( _size * ( phase + 1 ));
+    }
+
+private:
+    const uint32_t _size;
+    lunchbox::Monitoru _count;
+};
+
+uint32_t _slots[ MAXTHREADS ];
+
+class Thread : public lunchbox::Thread
+{
+public:
+    Thread() : barrier( 0 ), monitor( 0 ), latch( 0 ), index( 0 ), nSize( 0 )
+             , nLast( 0 ), nErrors( 0 ) {}
+
+    virtual void run()
+    {
+        if( latch )
+            latch->countDownAndWait();
+
+        for( uint32_t phase = 0; phase < NPHASES; ++phase )
+        {
+            if( monitor )
+            {
+                monitor->enter( phase );
+                continue;
+            }
+
+            _slots[ index ] = phase;
+            if( barrier->enter( ))
+                ++nLast;
+
+            // all threads have stored the phase before anybody left
+            for( size_t i = 0; i < nSize; ++i )
+                if( _slots[ i ] < phase )
+                    ++nErrors;
+            barrier->enter();
+        }
+    }
+
+    lunchbox::Barrier* barrier;
+    MonitorBarrier* monitor;
+    lunchbox::Latch* latch;
+    size_t index;
+    size_t nSize;
+    size_t nLast;
+    size_t nErrors;
+};
+
+void _testLatch()
+{
+    lunchbox::Latch open( 0 );
+    TEST( open.isOpen( ));
+    open.wait();
+
+    lunchbox::Latch latch( 3 );
+    TEST( !latch.isOpen( ));
+    TEST( latch.getCount() == 3 );
+    latch.countDown( 2 );
+    TEST( latch.getCount() == 1 );
+    TEST( !latch.isOpen( ));
+    latch.countDown();
+    TEST( latch.isOpen( ));
+    TEST( latch.getCount() == 0 );
+    latch.wait();
+
+    lunchbox::Latch start( 8, lunchbox::WaitPolicy( ));
+    lunchbox::Barrier barrier( 8 );
+    Thread threads[ 8 ];
+    for( size_t i = 0; i < 8; ++i )
+    {
+        threads[i].latch = &start;
+        threads[i].barrier = &barrier;
+        threads[i].index = i;
+        threads[i].nSize = 8;
+        TEST( threads[i].start( ));
+    }
+    start.wait();
+    TEST( start.isOpen( ));
+
+    size_t nLast = 0;
+    for( size_t i = 0; i < 8; ++i )
+    {
+        TEST( threads[i].join( ));
+        TESTINFO( threads[i].nErrors == 0, threads[i].nErrors );
+        nLast += threads[i].nLast;
+    }
+    TESTINFO( nLast == NPHASES, nLast );
+    TEST( barrier.getPhase() == 2 * NPHASES );
+}
+
+void _setBarrier( Thread& thread, lunchbox::Barrier& barrier )
+    { thread.barrier = &barrier; }
+void _setBarrier( Thread& thread, MonitorBarrier& barrier )
+    { thread.monitor = &barrier; }
+
+template< class B > float _benchmark( B& barrier, const size_t nThreads )
+{
+    Thread threads[ MAXTHREADS ];
+    lunchbox::Clock clock;
+    for( size_t i = 0; i < nThreads; ++i )
+    {
+        threads[i].index = i;
+        threads[i].nSize = nThreads;
+        _setBarrier( threads[i], barrier );
+        TEST( threads[i].start( ));
+    }
+    for( size_t i = 0; i < nThreads; ++i )
+        TEST( threads[i].join( ));
+    return clock.getTimef() * 1000.f / float( NPHASES );
+}
+
+void _testPerformance()
+{
+    std::cout << "threads, Barrier us/phase, blocking Barrier us/phase, "
+              << "Monitoru us/phase" << std::endl;
+    for( size_t nThreads = 1; nThreads <= MAXTHREADS; nThreads <<= 1 )
+    {
+        const uint32_t size = uint32_t( nThreads );
+        lunchbox::Barrier barrier( size );
+        lunchbox::Barrier blocking( size, lunchbox::WaitPolicy( ));
+        MonitorBarrier monitor( size );
+
+        // Thread barriers enter twice per phase
+        const float time = _benchmark( barrier, nThreads ) * .5f;
+        const float blockingTime = _benchmark( blocking, nThreads ) * .5f;
+        const float monitorTime = _benchmark( monitor, nThreads );
+        std::cout << std::setw( 7 ) << nThreads << ", " << std::setw( 17 )
+                  << time << ", " << std::setw( 26 ) << blockingTime << ", "
+                  << std::setw( 17 ) << monitorTime << std::endl;
+
+        const lunchbox::WaitStats& stats = barrier.getWaitStats();
+        TEST( size_t( stats.spun + stats.yielded + stats.blocked ) ==
+              2 * NPHASES * ( nThreads - 1 ));
+    }
+}
+}
+
+int main( int, char** )
+{
+    _testLatch();
+    _testPerformance();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,142 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <test.h>
+#include <lunchbox/buffer.h>
+#include <lunchbox/clock.h>
+#include <iostream>
+
+#define NPOLICIES 5
+#define MAXSIZE ( 256 * 1024 * 1024 )
+#define CHUNKSIZE ( 64 * 1024 )
+
+namespace
+{
+const lunchbox::BufferPolicy _policies[ NPOLICIES ] =
+{
+    lunchbox::BUFFER_MALLOC, lunchbox::BUFFER_CACHELINE, lunchbox::BUFFER_PAGE,
+    lunchbox::BUFFER_HUGEPAGE, lunchbox::BUFFER_MMAP
+};
+const char* const _names[ NPOLICIES ] =
+    { "malloc", "cacheline", "page", "hugepage", "mmap" };
+const uintptr_t _alignments[ NPOLICIES ] = { 1, LB_CACHELINE_SIZE, 4096, 4096,
+                                             4096 };
+
+bool _isAligned( const void* data, const size_t i )
+{
+    return ( uintptr_t( data ) & ( _alignments[i] - 1 )) == 0;
+}
+
+void _fill( lunchbox::Bufferb& buffer, const uint64_t from )
+{
+    for( uint64_t i = from; i < buffer.getSize(); ++i )
+        buffer[i] = uint8_t( i * 7 );
+}
+
+bool _check( const lunchbox::Bufferb& buffer, const uint64_t size )
+{
+    for( uint64_t i = 0; i < size; ++i )
+        if( buffer[i] != uint8_t( i * 7 ))
+            return false;
+    return true;
+}
+
+void _testPolicy( const size_t i )
+{
+    const lunchbox::BufferPolicy policy = _policies[i];
+    lunchbox::Bufferb buffer( policy );
+    TEST( buffer.getPolicy() == policy );
+    TEST( buffer.isEmpty( ));
+
+    // grow across page and huge page boundaries
+    static const uint64_t sizes[] = { 1, 100, 5000, 3 * 1024 * 1024 + 17,
+                                      9 * 1024 * 1024, 1000, 0 };
+    for( size_t j = 0; sizes[j]; ++j )
+    {
+        const uint64_t oldSize = std::min( buffer.getSize(), sizes[j] );
+        if( sizes[j] > buffer.getMaxSize( ))
+            buffer.resize( sizes[j] );
+        else
+            buffer.setSize( sizes[j] );
+        TESTINFO( _isAligned( buffer.getData(), i ), _names[i] );
+        TEST( buffer.getSize() == sizes[j] );
+        TESTINFO( _check( buffer, oldSize ), _names[i] << " " << sizes[j] );
+        _fill( buffer, oldSize );
+    }
+    TEST( _check( buffer, buffer.getSize( )));
+
+    // shrinks the allocation, also from huge pages
+    buffer.pack();
+    TEST( buffer.getMaxSize() == 1000 );
+    TESTINFO( _check( buffer, 1000 ), _names[i] );
+    TEST( _isAligned( buffer.getData(), i ));
+
+    lunchbox::Bufferb other( 10 );
+    other.swap( buffer );
+    TEST( other.getPolicy() == policy );
+    TEST( buffer.getPolicy() == lunchbox::BUFFER_MALLOC );
+    TEST( other.getSize() == 1000 );
+    TEST( _check( other, 1000 ));
+
+    lunchbox::Bufferb moved( other );
+    TEST( moved.getPolicy() == policy );
+    TEST( other.getData() == 0 );
+    TEST( _check( moved, 1000 ));
+
+    for( size_t j = 0; j < NPOLICIES; ++j )
+    {
+        moved.setPolicy( _policies[j] );
+        TEST( moved.getPolicy() == _policies[j] );
+        TEST( moved.getSize() == 1000 );
+        TEST( _isAligned( moved.getData(), j ));
+        TEST( _check( moved, 1000 ));
+    }
+
+    moved.pack();
+    moved.setSize( 0 );
+    moved.pack();
+    TEST( moved.getMaxSize() == 0 );
+    moved.clear();
+    TEST( moved.getData() == 0 );
+}
+
+float _benchmark( const lunchbox::BufferPolicy policy )
+{
+    uint8_t chunk[ CHUNKSIZE ];
+    ::memset( chunk, 42, CHUNKSIZE );
+
+    lunchbox::Clock clock;
+    lunchbox::Bufferb buffer( policy );
+    while( buffer.getSize() < MAXSIZE )
+        buffer.append( chunk, CHUNKSIZE );
+    TEST( buffer[ MAXSIZE - 1 ] == 42 );
+    return clock.getTimef();
+}
+}
+
+int main( int, char** )
+{
+    for( size_t i = 0; i < NPOLICIES; ++i )
+        _testPolicy( i );
+
+    std::cout << "policy, ms to append " << MAXSIZE / 1024 / 1024 << " MB"
+              << std::endl;
+    for( size_t i = 0; i < NPOLICIES; ++i )
+        std::cout << std::setw( 9 ) << _names[i] << ", "
+                  << _benchmark( _policies[i] ) << std::endl;
+    return EXIT_SUCCESS;
+}
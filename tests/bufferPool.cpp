@@ -0,0 +1,161 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <test.h>
+#include <lunchbox/bufferPool.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/compressor.h>
+#include <lunchbox/compressorResult.h>
+#include <lunchbox/pluginRegistry.h>
+#include <lunchbox/plugins/compressorTypes.h>
+#include <iostream>
+
+#define NFRAMES 100
+#define FRAMESIZE ( 4 * 1024 * 1024 )
+
+namespace
+{
+void _testPool()
+{
+    lunchbox::BufferPool pool;
+    lunchbox::Bufferb* buffer = pool.alloc( 1000 );
+    TEST( buffer->getMaxSize() >= 1000 );
+    TEST( buffer->isEmpty( ));
+    TEST( pool.getNAllocations() == 1 );
+
+    buffer->resize( 1000 );
+    pool.release( buffer );
+    TEST( pool.getNCached() == 1 );
+
+    // reused for smaller sizes of the same class, emptied
+    lunchbox::Bufferb* reused = pool.alloc( 600 );
+    TEST( reused == buffer );
+    TEST( reused->isEmpty( ));
+    TEST( pool.getNReuses() == 1 );
+    TEST( pool.getNCached() == 0 );
+
+    // too small for the next class
+    pool.release( reused );
+    lunchbox::Bufferb* large = pool.alloc( 3000 );
+    TEST( large != buffer );
+    TEST( pool.getNAllocations() == 2 );
+    TEST( pool.getNCached() == 1 );
+
+    // reserve keeps large enough buffers
+    lunchbox::Bufferb* kept = large;
+    pool.reserve( kept, 2000 );
+    TEST( kept == large );
+    pool.reserve( kept, 5000 );
+    TEST( kept != large );
+    TEST( kept->getMaxSize() >= 5000 );
+    TEST( pool.getNCached() == 2 );
+    lunchbox::Bufferb* none = 0;
+    pool.reserve( none, 100 );
+    TEST( none );
+    pool.release( none );
+    pool.release( kept );
+
+    // bounded number of buffers per class
+    pool.flush();
+    TEST( pool.getNCached() == 0 );
+    pool.setMaxCached( 2 );
+    TEST( pool.getMaxCached() == 2 );
+    lunchbox::Bufferb* buffers[ 4 ];
+    for( size_t i = 0; i < 4; ++i )
+        buffers[i] = pool.alloc( 100 );
+    for( size_t i = 0; i < 4; ++i )
+        pool.release( buffers[i] );
+    TEST( pool.getNCached() == 2 );
+    TEST( pool.alloc( 100 ) == buffers[3] );
+    pool.release( buffers[3] );
+
+    pool.resetStatistics();
+    TEST( pool.getNAllocations() == 0 );
+    TEST( pool.getNReuses() == 0 );
+
+    lunchbox::BufferPool alignedPool( lunchbox::BUFFER_CACHELINE );
+    buffer = alignedPool.alloc( 100 );
+    TEST( buffer->getPolicy() == lunchbox::BUFFER_CACHELINE );
+    TEST(( uintptr_t( buffer->getData( )) & ( LB_CACHELINE_SIZE - 1 )) == 0 );
+    alignedPool.release( buffer );
+}
+
+void _testCompressor( const bool pack, const uint8_t* data )
+{
+    lunchbox::PluginRegistry registry;
+    TEST( registry.addLunchboxPlugins( ));
+    registry.init();
+
+    lunchbox::Compressor::setPackResults( pack );
+    TEST( lunchbox::Compressor::getPackResults() == pack );
+
+    lunchbox::BufferPool& pool = lunchbox::Compressor::getResultPool();
+    uint64_t inDims[2]  = { 0, FRAMESIZE };
+    {
+        lunchbox::Compressor compressor( registry, EQ_COMPRESSOR_RLE_BYTE );
+        TEST( compressor.isGood( ));
+
+        // warm up the pool
+        compressor.compress( const_cast< uint8_t* >( data ), inDims );
+        compressor.compress( const_cast< uint8_t* >( data ), inDims );
+        pool.resetStatistics();
+
+        lunchbox::Clock clock;
+        for( size_t i = 0; i < NFRAMES; ++i )
+        {
+            compressor.compress( const_cast< uint8_t* >( data ), inDims );
+            TEST( compressor.getResult().getSize() > 0 );
+        }
+        const float time = clock.getTimef();
+        const size_t nAllocations = pool.getNAllocations();
+
+        std::cout << std::setw( 6 ) << ( pack ? "pack" : "retain" ) << ", "
+                  << std::setw( 17 ) << float( nAllocations ) / NFRAMES
+                  << ", " << std::setw( 12 ) << time / NFRAMES << std::endl;
+        // steady state without allocations, packed results bypass the pool
+        TESTINFO( nAllocations == 0, nAllocations );
+    }
+
+    // retained results of deleted compressors are reused by new ones
+    pool.resetStatistics();
+    {
+        lunchbox::Compressor compressor( registry, EQ_COMPRESSOR_RLE_BYTE );
+        compressor.compress( const_cast< uint8_t* >( data ), inDims );
+    }
+    TEST( pool.getNAllocations() == 0 );
+    if( pack )
+        TEST( pool.getNCached() == 0 );
+    registry.exit();
+}
+}
+
+int main( int, char** )
+{
+    _testPool();
+
+    uint8_t* data = new uint8_t[ FRAMESIZE ];
+    for( size_t i = 0; i < FRAMESIZE; ++i )
+        data[i] = uint8_t(( i >> 6 ) * 13 );
+
+    std::cout << "policy, allocations/frame, ms/frame" << std::endl;
+    _testCompressor( true, data );
+    _testCompressor( false, data );
+    lunchbox::Compressor::setPackResults( true );
+
+    delete [] data;
+    return EXIT_SUCCESS;
+}
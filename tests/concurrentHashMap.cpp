@@ -0,0 +1,281 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define TEST_RUNTIME 300 // seconds
+#include <test.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/concurrentHashMap.h>
+#include <lunchbox/scopedMutex.h>
+#include <lunchbox/stdExt.h>
+#include <lunchbox/thread.h>
+#include <iostream>
+
+#define MAXTHREADS 8
+#define NKEYS 20000
+#define NOPS 200000
+
+namespace
+{
+typedef lunchbox::ConcurrentHashMap< uint32_t, uint32_t > Map;
+typedef lunchbox::ConcurrentHashMap< lunchbox::UUID, size_t > UUIDMap;
+typedef stde::hash_map< uint32_t, uint32_t > StdMap;
+
+lunchbox::a_int32_t _running;
+
+class Writer : public lunchbox::Thread
+{
+public:
+    Writer() : map( 0 ), offset( 0 ) {}
+
+    virtual void run()
+    {
+        for( uint32_t i = offset; i < offset + NKEYS; ++i )
+            TEST( map->insert( i, i << 1 ));
+    }
+
+    Map* map;
+    uint32_t offset;
+};
+
+class Reader : public lunchbox::Thread
+{
+public:
+    Reader() : map( 0 ), nFound( 0 ) {}
+
+    virtual void run()
+    {
+        nFound = 0;
+        while( _running )
+        {
+            for( uint32_t i = 0; i < NKEYS * MAXTHREADS; i += 7 )
+            {
+                uint32_t value = 0;
+                if( map->find( i, value ))
+                {
+                    TESTINFO( value == i << 1, i << ": " << value );
+                    ++nFound;
+                }
+            }
+        }
+    }
+
+    Map* map;
+    size_t nFound;
+};
+
+/** Baseline: stde::hash_map guarded by a SpinLock */
+class LockedMap
+{
+public:
+    bool find( const uint32_t key, uint32_t& value ) const
+    {
+        lunchbox::ScopedFastWrite mutex( _lock );
+        StdMap::const_iterator i = _map.find( key );
+        if( i == _map.end( ))
+            return false;
+        value = i->second;
+        return true;
+    }
+
+    bool insert( const uint32_t key, const uint32_t value )
+    {
+        lunchbox::ScopedFastWrite mutex( _lock );
+        return _map.insert( std::make_pair( key, value )).second;
+    }
+
+    bool erase( const uint32_t key )
+    {
+        lunchbox::ScopedFastWrite mutex( _lock );
+        return _map.erase( key ) > 0;
+    }
+
+private:
+    mutable lunchbox::SpinLock _lock;
+    StdMap _map;
+};
+
+template< class M > class Benchmark : public lunchbox::Thread
+{
+public:
+    Benchmark() : map( 0 ), writeRatio( 0 ), seed( 0 ) {}
+
+    virtual void run()
+    {
+        uint32_t value;
+        for( size_t i = 0; i < NOPS; ++i )
+        {
+            seed ^= seed << 13; // xorshift
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            const uint32_t key = seed % NKEYS;
+            if( seed % 100 >= writeRatio )
+                map->find( key, value );
+            else if( seed & 0x100 )
+                map->insert( key, key );
+            else
+                map->erase( key );
+        }
+    }
+
+    M* map;
+    uint32_t writeRatio; // percent
+    uint32_t seed;
+};
+
+template< class M >
+float _benchmark( const size_t nThreads, const uint32_t writeRatio )
+{
+    M map;
+    for( uint32_t i = 0; i < NKEYS; i += 2 )
+        map.insert( i, i );
+
+    Benchmark< M > threads[ MAXTHREADS ];
+    lunchbox::Clock clock;
+    for( size_t i = 0; i < nThreads; ++i )
+    {
+        threads[i].map = &map;
+        threads[i].writeRatio = writeRatio;
+        threads[i].seed = uint32_t( i + 1 ) * 2654435761u;
+        TEST( threads[i].start( ));
+    }
+    for( size_t i = 0; i < nThreads; ++i )
+        TEST( threads[i].join( ));
+    return float( NOPS * nThreads ) / clock.getTimef();
+}
+}
+
+static void _testBasic()
+{
+    Map map;
+    TEST( map.empty( ));
+    TEST( map.getNBuckets() == 64 );
+
+    uint32_t value = 0;
+    TEST( !map.find( 42, value ));
+    TEST( map.insert( 42, 17 ));
+    TEST( !map.insert( 42, 18 ));
+    TEST( map.find( 42, value ));
+    TEST( value == 17 );
+    TEST( !map.set( 42, 18 ));
+    TEST( map.find( 42, value ));
+    TEST( value == 18 );
+    TEST( map.erase( 42 ));
+    TEST( !map.erase( 42 ));
+    TEST( !map.contains( 42 ));
+    TEST( map.empty( ));
+
+    for( uint32_t i = 0; i < NKEYS; ++i ) // grows several times
+        TEST( map.set( i, i << 1 ));
+    TEST( map.size() == NKEYS );
+    TESTINFO( map.getNBuckets() >= NKEYS / 2, map.getNBuckets( ));
+    for( uint32_t i = 0; i < NKEYS; ++i )
+    {
+        TEST( map.find( i, value ));
+        TEST( value == i << 1 );
+    }
+    for( uint32_t i = 0; i < NKEYS; i += 2 )
+        TEST( map.erase( i ));
+    TEST( map.size() == NKEYS / 2 );
+    for( uint32_t i = 0; i < NKEYS; ++i )
+        TEST( map.contains( i ) == bool( i & 1 ));
+
+    map.clear();
+    TEST( map.empty( ));
+    TEST( map.getNBuckets() == 64 );
+    TEST( !map.contains( 1 ));
+
+    UUIDMap uuids( 1000 );
+    TEST( uuids.getNBuckets() == 1024 );
+    std::vector< lunchbox::UUID > keys;
+    for( size_t i = 0; i < 1000; ++i )
+    {
+        keys.push_back( lunchbox::make_UUID( ));
+        TEST( uuids.insert( keys.back(), i ));
+    }
+    size_t index = 0;
+    for( size_t i = 0; i < keys.size(); ++i )
+    {
+        TEST( uuids.find( keys[i], index ));
+        TEST( index == i );
+    }
+    lunchbox::Epoch::getGlobal().synchronize();
+}
+
+static void _testConcurrent()
+{
+    Map map;
+    Writer writers[ MAXTHREADS ];
+    Reader readers[ 2 ];
+
+    _running = 1;
+    for( size_t i = 0; i < 2; ++i )
+    {
+        readers[i].map = &map;
+        TEST( readers[i].start( ));
+    }
+    for( size_t i = 0; i < MAXTHREADS; ++i )
+    {
+        writers[i].map = &map;
+        writers[i].offset = uint32_t( i * NKEYS );
+        TEST( writers[i].start( ));
+    }
+    for( size_t i = 0; i < MAXTHREADS; ++i )
+        TEST( writers[i].join( ));
+    _running = 0;
+    for( size_t i = 0; i < 2; ++i )
+        TEST( readers[i].join( ));
+
+    TEST( map.size() == NKEYS * MAXTHREADS );
+    for( uint32_t i = 0; i < NKEYS * MAXTHREADS; ++i )
+    {
+        uint32_t value = 0;
+        TEST( map.find( i, value ));
+        TEST( value == i << 1 );
+    }
+    lunchbox::Epoch::getGlobal().synchronize();
+}
+
+static void _testPerformance()
+{
+    std::cout << "            Class, write%,     ops/ms, threads" << std::endl;
+    for( size_t nThreads = 1; nThreads <= MAXTHREADS; nThreads <<= 1 )
+    {
+        // all-write load contends on the reclamation of erased nodes
+        const uint32_t writeRatios[] = { 5, 50, 100 };
+        for( size_t i = 0; i < 3; ++i )
+        {
+            const uint32_t writeRatio = writeRatios[i];
+            const float rate = _benchmark< Map >( nThreads, writeRatio );
+            const float lockedRate = _benchmark< LockedMap >( nThreads,
+                                                              writeRatio );
+            std::cout << "ConcurrentHashMap, " << std::setw( 6 ) << writeRatio
+                      << ", " << std::setw( 10 ) << rate << ", "
+                      << std::setw( 7 ) << nThreads << std::endl
+                      << " SpinLock+hashmap, " << std::setw( 6 ) << writeRatio
+                      << ", " << std::setw( 10 ) << lockedRate << ", "
+                      << std::setw( 7 ) << nThreads << std::endl;
+        }
+    }
+}
+
+int main( int, char** )
+{
+    _testBasic();
+    _testConcurrent();
+    _testPerformance();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,278 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define TEST_RUNTIME 300 // seconds
+#include <test.h>
+#include <lunchbox/atomic.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/epoch.h>
+#include <lunchbox/lfVector.h>
+#include <lunchbox/scopedMutex.h>
+#include <lunchbox/spinLock.h>
+#include <lunchbox/thread.h>
+#include <iostream>
+
+#define MAXTHREADS 16
+#define NREADS 1000000
+#define NSWAPS 20000
+#define MAGIC 0xC0FFEE
+
+namespace
+{
+lunchbox::a_int32_t _nFreed;
+void _countFree( void* ) { ++_nFreed; }
+
+struct Payload
+{
+    Payload() : magic( MAGIC ) {}
+    ~Payload() { magic = 0; }
+    int magic;
+};
+void _freePayload( void* payload )
+{
+    delete static_cast< Payload* >( payload );
+    ++_nFreed;
+}
+
+lunchbox::Epoch _epoch;
+Payload* _shared = 0;
+lunchbox::a_int32_t _running;
+
+class Reader : public lunchbox::Thread
+{
+public:
+    Reader() : nErrors( 0 ) {}
+
+    virtual void run()
+    {
+        nErrors = 0;
+        while( _running )
+        {
+            lunchbox::ScopedEpoch critical( _epoch );
+            const Payload* payload =
+                lunchbox::Atomic< Payload* >::loadAcquire( _shared );
+            for( size_t i = 0; i < 16; ++i )
+                if( payload->magic != MAGIC )
+                    ++nErrors;
+        }
+    }
+
+    size_t nErrors;
+};
+
+class Writer : public lunchbox::Thread
+{
+public:
+    virtual void run()
+    {
+        for( size_t i = 0; i < NSWAPS; ++i )
+        {
+            Payload* payload = new Payload;
+            Payload* old = 0;
+            do
+                old = lunchbox::Atomic< Payload* >::loadAcquire( _shared );
+            while( !lunchbox::Atomic< void* >::compareAndSwap(
+                       reinterpret_cast< void** >( &_shared ), old, payload ));
+            _epoch.retire( old, &_freePayload );
+        }
+    }
+};
+
+typedef lunchbox::LFVector< int > Vector;
+lunchbox::a_int32_t _stage;
+
+class VectorReader : public lunchbox::Thread
+{
+public:
+    VectorReader() : vector( 0 ), value( 0 ) {}
+
+    virtual void run()
+    {
+        lunchbox::ScopedEpoch critical;
+        const int& element = (*vector)[ vector->size() - 1 ];
+        _stage = 1;
+        while( _stage == 1 ) // vector is cleared concurrently
+            lunchbox::Thread::yield();
+        value = element; // undefined value, but valid memory
+    }
+
+    Vector* vector;
+    int value;
+};
+
+template< class L > class Benchmark : public lunchbox::Thread
+{
+public:
+    Benchmark() : lock( 0 ) {}
+    virtual void run()
+    {
+        for( size_t i = 0; i < NREADS; ++i )
+            L mutex( *lock );
+    }
+
+    typename L::LockType* lock;
+};
+
+struct EpochLock
+{
+    typedef lunchbox::Epoch LockType;
+    explicit EpochLock( lunchbox::Epoch& epoch ) : critical( epoch ) {}
+    lunchbox::ScopedEpoch critical;
+};
+
+struct SpinReadLock
+{
+    typedef lunchbox::SpinLock LockType;
+    explicit SpinReadLock( lunchbox::SpinLock& lock ) : mutex( lock ) {}
+    lunchbox::ScopedFastRead mutex;
+};
+
+template< class L >
+float _benchmark( typename L::LockType& lock, const size_t nThreads )
+{
+    Benchmark< L > threads[ MAXTHREADS ];
+    lunchbox::Clock clock;
+    for( size_t i = 0; i < nThreads; ++i )
+    {
+        threads[i].lock = &lock;
+        TEST( threads[i].start( ));
+    }
+    for( size_t i = 0; i < nThreads; ++i )
+        TEST( threads[i].join( ));
+    return float( NREADS * nThreads ) / clock.getTimef();
+}
+}
+
+static void _testBasic()
+{
+    lunchbox::Epoch epoch;
+    TEST( !epoch.isInside( ));
+
+    _nFreed = 0;
+    epoch.enter();
+    epoch.enter();
+    TEST( epoch.isInside( ));
+    epoch.retire( 0, &_countFree );
+    for( size_t i = 0; i < 10; ++i )
+        TEST( epoch.reclaim() == 1 ); // blocked by this thread
+    TEST( _nFreed == 0 );
+    TEST( epoch.getNRetired() == 1 );
+
+    epoch.leave();
+    TEST( epoch.isInside( ));
+    TEST( epoch.reclaim() == 1 );
+    epoch.leave();
+    TEST( !epoch.isInside( ));
+
+    epoch.synchronize();
+    TEST( _nFreed == 1 );
+    TEST( epoch.getNRetired() == 0 );
+
+    { // freed on destruction
+        lunchbox::Epoch other;
+        lunchbox::ScopedEpoch critical( other );
+        other.retire( 0, &_countFree );
+        other.retireArray( new int[ 16 ] );
+        TEST( other.getNRetired() == 2 );
+    }
+    TEST( _nFreed == 2 );
+}
+
+static void _testConcurrent()
+{
+    _nFreed = 0;
+    _running = 1;
+    _shared = new Payload;
+
+    Reader readers[ 4 ];
+    Writer writers[ 2 ];
+    for( size_t i = 0; i < 4; ++i )
+        TEST( readers[i].start( ));
+    for( size_t i = 0; i < 2; ++i )
+        TEST( writers[i].start( ));
+
+    for( size_t i = 0; i < 2; ++i )
+        TEST( writers[i].join( ));
+    _running = 0;
+    for( size_t i = 0; i < 4; ++i )
+    {
+        TEST( readers[i].join( ));
+        TEST( readers[i].nErrors == 0 );
+    }
+
+    _epoch.synchronize();
+    TESTINFO( _nFreed == 2 * NSWAPS, _nFreed );
+    delete _shared;
+    _shared = 0;
+}
+
+static void _testLFVector()
+{
+    Vector vector;
+    for( int i = 0; i < 1000; ++i )
+        vector.push_back( i );
+
+    lunchbox::Epoch& epoch = lunchbox::Epoch::getGlobal();
+    epoch.synchronize();
+
+    VectorReader reader;
+    reader.vector = &vector;
+    _stage = 0;
+    TEST( reader.start( ));
+    while( _stage == 0 )
+        lunchbox::Thread::yield();
+
+    vector.clear();
+    TEST( vector.empty( ));
+    TEST( epoch.reclaim() > 0 ); // storage held by reader
+    _stage = 2;
+    TEST( reader.join( ));
+
+    epoch.synchronize();
+    TEST( epoch.getNRetired() == 0 );
+
+    for( int i = 0; i < 1000; ++i ) // shrinking with trim
+        vector.push_back( i );
+    vector.resize( 10 );
+    TEST( vector.size() == 10 );
+    epoch.synchronize();
+}
+
+static void _testPerformance()
+{
+    lunchbox::Epoch epoch;
+    lunchbox::SpinLock lock;
+    std::cout << "    Class,  reads/ms, threads" << std::endl;
+    for( size_t nThreads = 1; nThreads <= MAXTHREADS; nThreads <<= 1 )
+    {
+        const float epochRate = _benchmark< EpochLock >( epoch, nThreads );
+        const float spinRate = _benchmark< SpinReadLock >( lock, nThreads );
+        std::cout << "    Epoch, " << std::setw( 9 ) << epochRate << ", "
+                  << std::setw( 7 ) << nThreads << std::endl
+                  << " SpinLock, " << std::setw( 9 ) << spinRate << ", "
+                  << std::setw( 7 ) << nThreads << std::endl;
+    }
+}
+
+int main( int, char** )
+{
+    _testBasic();
+    _testConcurrent();
+    _testLFVector();
+    _testPerformance();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,72 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LUNCHBOX_LATENCY_H
+#define LUNCHBOX_LATENCY_H
+
+#include <lunchbox/clock.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#define MAXSAMPLES 100000 // latency samples per thread
+
+typedef std::vector< float > Latencies; // set() times in microseconds
+
+/** Acquire the lock, sampling the time to acquire it until MAXSAMPLES. */
+template< class T >
+inline void setSampled( T& lock, const lunchbox::Clock& clock,
+                        Latencies& latencies )
+{
+    if( latencies.size() >= MAXSAMPLES )
+    {
+        lock.set();
+        return;
+    }
+
+    const double start = clock.getTimed();
+    lock.set();
+    latencies.push_back( float( clock.getTimed() - start ) * 1000.f );
+}
+
+/** @return the sorted latency samples of all given threads. */
+template< class T >
+inline Latencies getSortedLatencies( const T* threads, const size_t nThreads )
+{
+    Latencies latencies;
+    for( size_t i = 0; i < nThreads; ++i )
+        latencies.insert( latencies.end(), threads[i].latencies.begin(),
+                          threads[i].latencies.end( ));
+    std::sort( latencies.begin(), latencies.end( ));
+    return latencies;
+}
+
+/** @return the nearest-rank percentile of the sorted samples. */
+inline float getPercentile( const Latencies& sorted, const double percent )
+{
+    if( sorted.empty( ))
+        return 0.f;
+
+    // the epsilon keeps exact ranks, e.g. p99.9 of 1000 samples, in place
+    const double rank = std::ceil( percent / 100. * double( sorted.size( )) -
+                                   1e-6 );
+    const size_t index = rank < 1. ? 0 : size_t( rank ) - 1;
+    return sorted[ std::min( index, sorted.size() - 1 ) ];
+}
+
+#endif
@@ -1,5 +1,5 @@
 
-/* Copyright (c) 2010-2011, Stefan Eilemann <eile@equalizergraphics.com>
+/* Copyright (c) 2010-2014, Stefan Eilemann <eile@equalizergraphics.com>
  *
  * This library is free software; you can redistribute it and/or modify it under
  * the terms of the GNU Lesser General Public License version 2.1 as published
@@ -22,12 +22,14 @@
 #include <iostream>
 
 #define RUNTIME 1000 /*ms*/
+#define BATCH 64
 
-lunchbox::LFQueue< uint64_t > queue(1024);
+bool _writing = true;
 
-class ReadThread : public lunchbox::Thread
+template< class Q > class ReadThread : public lunchbox::Thread
 {
 public:
+    explicit ReadThread( Q& queue ) : _queue( queue ) {}
     virtual ~ReadThread() {}
     virtual void run()
         {
@@ -38,11 +40,11 @@ public:
             lunchbox::Clock clock;
             while( clock.getTime64() < RUNTIME )
             {
-                if( queue.getFront( item ))
+                if( _queue.getFront( item ))
                 {
                     TEST( item == nOps );
                     uint64_t item2 = 0xffffffffffffffffull;
-                    TEST( queue.pop( item2 ));
+                    TEST( _queue.pop( item2 ));
                     TEST( item2 == item );
                     ++nOps;
                 }
@@ -53,14 +55,90 @@ public:
             std::cout << 2*nOps/time << " reads/ms, " << nEmpty/time
                       << " empty/ms" << std::endl;
         }
+
+private:
+    Q& _queue;
 };
 
-int main( int, char** )
+template< class Q > class BatchReadThread : public lunchbox::Thread
+{
+public:
+    explicit BatchReadThread( Q& queue ) : _queue( queue ) {}
+    virtual ~BatchReadThread() {}
+    virtual void run()
+        {
+            uint64_t nOps = 0;
+            uint64_t items[ BATCH ];
+
+            lunchbox::Clock clock;
+            while( LB_LIKELY( _writing ) || !_queue.isEmpty( ))
+            {
+                const size_t n = _queue.pop( items, BATCH );
+                for( size_t i = 0; i < n; ++i )
+                    TEST( items[i] == nOps++ );
+            }
+            const float time = clock.getTimef();
+            std::cout << nOps/time << " batched reads/ms" << std::endl;
+        }
+
+private:
+    Q& _queue;
+};
+
+template< class Q > void _testBatch()
+{
+    Q small( 7 );
+    const uint64_t values[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    uint64_t result[ 10 ];
+
+    TEST( small.push( values, 5 ) == 5 );
+    TEST( small.pop( result, 3 ) == 3 );
+    TEST( result[0] == 0 && result[2] == 2 );
+
+    // wraps around the end of the ring buffer
+    TEST( small.push( values + 5, 5 ) == 5 );
+    TEST( small.push( values, 1 ) == 0 );
+    TEST( small.pop( result, 10 ) == 7 );
+    for( size_t i = 0; i < 7; ++i )
+        TEST( result[i] == i + 3 );
+    TEST( small.isEmpty( ));
+
+    // in-place writes only return contiguous slots
+    TEST( !small.reserveWrite( 7 ));
+    uint64_t* slots = small.reserveWrite( 6 );
+    TEST( slots );
+    slots[0] = 42;
+    slots[1] = 17;
+    small.commitWrite( 2 );
+    TEST( small.pop( result, 10 ) == 2 );
+    TEST( result[0] == 42 && result[1] == 17 );
+
+    slots = small.reserveWrite( 4 );
+    TEST( slots );
+    for( size_t i = 0; i < 4; ++i )
+        slots[i] = i;
+    small.commitWrite( 4 );
+
+    slots = small.reserveWrite( 3 );
+    TEST( slots );
+    for( size_t i = 0; i < 3; ++i )
+        slots[i] = i + 4;
+    small.commitWrite( 3 );
+
+    TEST( !small.reserveWrite( 1 ));
+    TEST( small.pop( result, 10 ) == 7 );
+    for( size_t i = 0; i < 7; ++i )
+        TEST( result[i] == i );
+}
+
+template< class Q > void _testSPSC()
 {
-    ReadThread reader;
+    Q queue( 1024 );
+    ReadThread< Q > reader( queue );
     uint64_t nOps = 0;
     uint64_t nEmpty = 0;
 
+    std::cout << lunchbox::className( queue ) << std::endl;
     TEST( reader.start( ));
 
     lunchbox::Clock clock;
@@ -76,5 +154,38 @@ int main( int, char** )
     std::cout << nOps/time << " writes/ms, " << nEmpty/time << " full/ms"
               << std::endl;
 
+    queue.clear();
+    BatchReadThread< Q > batchReader( queue );
+    uint64_t items[ BATCH ];
+    nOps = 0;
+    _writing = true;
+
+    TEST( batchReader.start( ));
+    clock.reset();
+    while( clock.getTime64() < RUNTIME )
+    {
+        for( size_t i = 0; i < BATCH; ++i )
+            items[i] = nOps + i;
+        nOps += queue.push( items, BATCH );
+    }
+    const float batchTime = clock.getTimef();
+    _writing = false;
+
+    TEST( batchReader.join( ));
+    std::cout << nOps/batchTime << " batched writes/ms" << std::endl;
+}
+
+typedef lunchbox::LFQueue< uint64_t > Queue;
+typedef lunchbox::LFQueue< uint64_t, true > PaddedQueue;
+
+int main( int, char** )
+{
+    _testBatch< Queue >();
+    _testBatch< PaddedQueue >();
+    TEST( PaddedQueue( 1000 ).getCapacity() == 1023 );
+    TEST( PaddedQueue( 1023 ).getCapacity() == 1023 );
+
+    _testSPSC< Queue >();
+    _testSPSC< PaddedQueue >();
     return EXIT_SUCCESS;
 }
@@ -203,6 +203,133 @@ public:
     Flusher& operator=( const Flusher& ) { return *this; }
 };
 
+class Appender : public lunchbox::Thread
+{
+public:
+    Appender() : vector( 0 ), begin( 0 ), end( 0 ), locked( false ) {}
+    virtual ~Appender() {}
+
+    virtual void run()
+        {
+            if( locked )
+            {
+                for( size_t i = begin; i < end; ++i )
+                {
+                    Vector_t::ScopedWrite mutex = vector->getWriteLock();
+                    vector->push_back( i, false );
+                }
+            }
+            else
+            {
+                for( size_t i = begin; i < end; ++i )
+                    vector->push_back( i );
+            }
+        }
+    Vector_t* vector;
+    size_t begin;
+    size_t end;
+    bool locked;
+
+    Appender& operator=( const Appender& ) { return *this; }
+};
+
+static void _testAppend( const size_t nThreads )
+{
+    std::cout << "  append/ms,  locked/ms, #threads" << std::endl;
+    const size_t nOps = LOOPSIZE * 10;
+    std::vector< Appender > appenders( nThreads );
+
+    for( size_t i = 1; i <= nThreads; i = i<<1 )
+    {
+        float times[2];
+        for( size_t locked = 0; locked < 2; ++locked )
+        {
+            Vector_t vector;
+            const size_t nOpsPerThread = nOps / i;
+            _clock.reset();
+            for( size_t k = 0; k < i; ++k )
+            {
+                appenders[k].vector = &vector;
+                appenders[k].begin = k * nOpsPerThread;
+                appenders[k].end = (k+1) * nOpsPerThread;
+                appenders[k].locked = locked;
+                appenders[k].start();
+            }
+            for( size_t k = 0; k < i; ++k )
+                appenders[k].join();
+            times[ locked ] = _clock.getTimef();
+
+            // all elements are present exactly once
+            const size_t size = i * nOpsPerThread;
+            TESTINFO( vector.size() == size, vector.size() << " != " << size );
+            std::vector< bool > found( size, false );
+            for( size_t k = 0; k < vector.size(); ++k )
+            {
+                TEST( vector[k] < size );
+                TEST( !found[ vector[k] ] );
+                found[ vector[k] ] = true;
+            }
+        }
+
+        std::cerr << std::setw(11) << float(nOps)/times[0] << ", "
+                  << std::setw(10) << float(nOps)/times[1] << ", "
+                  << std::setw(8) << i << std::endl;
+    }
+}
+
+/** Throws on assignment or construction from a negative value. */
+struct Throwing
+{
+    Throwing() : value( 0 ) {}
+    explicit Throwing( const int v ) : value( v )
+        { if( v < 0 ) throw std::runtime_error( "construction" ); }
+
+    Throwing& operator = ( const Throwing& from )
+    {
+        if( from.value < 0 )
+            throw std::runtime_error( "assignment" );
+        value = from.value;
+        return *this;
+    }
+
+    int value;
+};
+
+static void _testExceptions()
+{
+    lunchbox::LFVector< Throwing > vector;
+    Throwing bad;
+    bad.value = -1;
+
+    vector.push_back( Throwing( 1 ));
+    try
+    {
+        vector.push_back( bad );
+        TEST( false );
+    }
+    catch( const std::runtime_error& ) {}
+    TEST( vector.size() == 2 ); // default element appended
+    TEST( vector[1].value == 0 );
+
+#ifdef LB_MOVE_SEMANTICS
+    try
+    {
+        vector.emplace_back( -1 );
+        TEST( false );
+    }
+    catch( const std::runtime_error& ) {}
+    TEST( vector.size() == 2 );
+    vector.emplace_back( 3 );
+    TEST( vector.size() == 3 );
+    TEST( vector[2].value == 3 );
+#endif
+
+    // the claims have been released, exclusive operations do not stall
+    vector.push_back( Throwing( 4 ));
+    vector.clear();
+    TEST( vector.empty( ));
+}
+
 template< class V, class T > void _runSerialTest()
 {
     V vector;
@@ -296,6 +423,9 @@ int main( int, char** )
     _runSerialTest< std::vector< size_t >, size_t >();
     _runSerialTest< Vector_t, size_t >();
 
+    _testAppend( nThreads );
+    _testExceptions();
+
     std::vector< Reader > readers(nThreads);
     std::vector< Writer > writers(nThreads);
     std::vector< Pusher > pushers(nThreads);
@@ -0,0 +1,175 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <test.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/compiler.h>
+#include <lunchbox/lfmtQueue.h>
+#include <lunchbox/mtQueue.h>
+#include <lunchbox/thread.h>
+#include <iomanip>
+#include <iostream>
+
+#define NOPS 100000
+#define NTHREADS 4
+
+lunchbox::LFMTQueue< uint64_t > queue( 1024 );
+lunchbox::LFMTQueue< uint64_t >::Group group( NTHREADS + 1 );
+
+#ifdef LB_GCC_4_6_OR_LATER
+#  pragma GCC diagnostic ignored "-Wunused-but-set-variable"
+#endif
+class ReadThread : public lunchbox::Thread
+{
+public:
+    virtual ~ReadThread() {}
+    virtual void run() { run_(); }
+
+    static void run_()
+    {
+        uint64_t item = 0xffffffffffffffffull;
+#ifndef NDEBUG
+        uint64_t last = 0;
+#endif
+        while( queue.popBarrier( item, group ))
+        {
+#ifndef NDEBUG
+            TESTINFO( last < item, last << " >= " << item );
+            last = item;
+#endif
+        }
+        TEST( queue.isEmpty( ));
+    }
+};
+
+template< class Q > class Producer : public lunchbox::Thread
+{
+public:
+    Producer() : queue_( 0 ), nOps_( 0 ) {}
+    virtual void run()
+    {
+        for( size_t i = 0; i < nOps_; ++i )
+            queue_->push( i );
+    }
+
+    Q* queue_;
+    size_t nOps_;
+};
+
+template< class Q > class Consumer : public lunchbox::Thread
+{
+public:
+    Consumer() : queue_( 0 ), nOps_( 0 ) {}
+    virtual void run()
+    {
+        for( size_t i = 0; i < nOps_; ++i )
+            queue_->pop();
+    }
+
+    Q* queue_;
+    size_t nOps_;
+};
+
+// Pushes from nProducers threads, pops from one or nProducers threads
+template< class Q > float _benchmark( Q& q, const size_t nProducers,
+                                      const size_t nConsumers )
+{
+    Producer< Q > producers[ NTHREADS ];
+    Consumer< Q > consumers[ NTHREADS ];
+    const size_t nOps = NOPS / nProducers;
+
+    lunchbox::Clock clock;
+    for( size_t i = 0; i < nConsumers; ++i )
+    {
+        consumers[i].queue_ = &q;
+        consumers[i].nOps_ = nOps * nProducers / nConsumers;
+        TEST( consumers[i].start( ));
+    }
+    for( size_t i = 0; i < nProducers; ++i )
+    {
+        producers[i].queue_ = &q;
+        producers[i].nOps_ = nOps;
+        TEST( producers[i].start( ));
+    }
+    for( size_t i = 0; i < nProducers; ++i )
+        TEST( producers[i].join( ));
+    for( size_t i = 0; i < nConsumers; ++i )
+        TEST( consumers[i].join( ));
+
+    const float time = clock.getTimef();
+    TEST( q.isEmpty( ));
+    return nOps * nProducers / time;
+}
+
+int main( int, char** )
+{
+    lunchbox::LFMTQueue< uint64_t > local( 4 );
+    TEST( local.getMaxSize() == 4 );
+    TEST( local.timedPopRange( 10 ).empty( ));
+    local.push( 1 );
+    local.push( 2 );
+    TEST( local.waitSize( 2 ) == 2 );
+    TEST( local.getSize() == 2 );
+    const std::vector< uint64_t > range = local.timedPopRange( 10, 1, 5 );
+    TEST( range.size() == 2 && range[0] == 1 && range[1] == 2 );
+    TEST( local.isEmpty( ));
+
+    uint64_t value = 0;
+    TEST( !local.timedPop( 10, value ));
+    for( size_t i = 0; i < 4; ++i )
+        TEST( local.tryPush( i ));
+    TEST( !local.tryPush( 4 ));
+    TEST( local.timedPop( 10, value ) && value == 0 );
+    TEST( local.timedPopRange( 10, 2, 2 ).size() == 2 );
+    TEST( local.pop() == 3 );
+    TEST( local.isEmpty( ));
+
+    ReadThread reader[ NTHREADS ];
+    for( size_t i = 0; i < NTHREADS; ++i )
+        TEST( reader[i].start( ));
+
+    lunchbox::Clock clock;
+    for( size_t i = 1 ; i < NOPS; ++i )
+        queue.push( i );
+    const float time = clock.getTimef();
+
+    ReadThread::run_();
+
+    for( size_t i = 0; i < NTHREADS; ++i )
+        TEST( reader[i].join( ));
+
+    std::cout << NOPS/time << " writes/ms" << std::endl;
+
+    std::cout << "   producers, consumers,     MTQueue,   LFMTQueue ops/ms"
+              << std::endl;
+    const size_t setups[][2] = {{ 1, 1 }, { NTHREADS, 1 },
+                                { NTHREADS, NTHREADS }};
+    for( size_t i = 0; i < sizeof( setups ) / sizeof( setups[0] ); ++i )
+    {
+        lunchbox::MTQueue< uint64_t > mtQueue( 1024 );
+        lunchbox::LFMTQueue< uint64_t > lfmtQueue( 1024 );
+        const size_t nProducers = setups[i][0];
+        const size_t nConsumers = setups[i][1];
+        const float mt = _benchmark( mtQueue, nProducers, nConsumers );
+        const float lf = _benchmark( lfmtQueue, nProducers, nConsumers );
+        std::cout << std::setw( 12 ) << nProducers << ", "
+                  << std::setw( 9 ) << nConsumers << ", "
+                  << std::setw( 11 ) << mt << ", " << std::setw( 11 ) << lf
+                  << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
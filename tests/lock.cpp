@@ -17,14 +17,17 @@
 
 #define TEST_RUNTIME 600 // seconds, needed for NighlyMemoryCheck
 #include "test.h"
+#include "latency.h"
 
 #include <lunchbox/atomic.h>
 #include <lunchbox/clock.h>
 #include <lunchbox/debug.h>
 #include <lunchbox/init.h>
 #include <lunchbox/lock.h>
+#include <lunchbox/mcsLock.h>
 #include <lunchbox/omp.h>
 #include <lunchbox/spinLock.h>
+#include <lunchbox/ticketLock.h>
 #include <lunchbox/timedLock.h>
 
 #include <iostream>
@@ -34,6 +37,14 @@
 
 lunchbox::Clock _clock;
 bool _running = false;
+bool _measure = false;
+
+/** A SpinLock which blocks contended threads after spinning and yielding. */
+class ParkingSpinLock : public lunchbox::SpinLock
+{
+public:
+    ParkingSpinLock() : lunchbox::SpinLock( true ) {}
+};
 
 template< class T > class Thread : public lunchbox::Thread
 {
@@ -42,13 +53,23 @@ public:
 
     T* lock;
     size_t ops;
+    Latencies latencies;
 
     virtual void run()
     {
         ops = 0;
+        latencies.clear();
+        if( _measure )
+            latencies.reserve( MAXSAMPLES );
+        const lunchbox::Clock clock;
+
         while( LB_LIKELY( _running ))
         {
-            lock->set();
+            // the first set() waits for the start of the run
+            if( _measure && ops > 0 )
+                setSampled( *lock, clock, latencies );
+            else
+                lock->set();
 #ifndef _MSC_VER
             TEST( lock->isSet( ));
 #endif
@@ -58,6 +79,47 @@ public:
     }
 };
 
+template< class T > float _run( T* lock, Thread< T >* threads,
+                                const size_t nThreads )
+{
+    _running = true;
+    for( size_t j = 0; j < nThreads; ++j )
+    {
+        threads[j].lock = lock;
+        TEST( threads[j].start( ));
+    }
+    lunchbox::sleep( 10 ); // let threads initialize
+
+    _clock.reset();
+    lock->unset();
+    lunchbox::sleep( TIME ); // let threads run
+    _running = false;
+
+    for( size_t j = 0; j < nThreads; ++j )
+        TEST( threads[j].join( ));
+    const float time = _clock.getTimef();
+
+    TEST( !lock->isSet( ));
+    lock->set();
+    return time;
+}
+
+/** @return Jain's fairness index of the per-thread operations, 1 is fair. */
+template< class T > float _getFairness( const Thread< T >* threads,
+                                        const size_t nThreads )
+{
+    double sum = 0.;
+    double sumSquares = 0.;
+    for( size_t j = 0; j < nThreads; ++j )
+    {
+        const double ops = double( threads[j].ops );
+        sum += ops;
+        sumSquares += ops * ops;
+    }
+    return sumSquares > 0. ? float( sum * sum / ( nThreads * sumSquares ))
+                           : 0.f;
+}
+
 template< class T > void _test()
 {
     T* lock = new T;
@@ -73,33 +135,28 @@ template< class T > void _test()
     Thread< T > threads[MAXTHREADS];
     for( size_t i = 1; i <= nThreads; i = i << 1 )
     {
-        _running = true;
-        for( size_t j = 0; j < i; ++j )
-        {
-            threads[j].lock = lock;
-            TEST( threads[j].start( ));
-        }
-        lunchbox::sleep( 10 ); // let threads initialize
-
-        _clock.reset();
-        lock->unset();
-        lunchbox::sleep( TIME ); // let threads run
-        _running = false;
+        _measure = false;
+        const float time = _run( lock, threads, i );
 
+        size_t ops = 0;
         for( size_t j = 0; j < i; ++j )
-            TEST( threads[j].join( ));
-        const float time = _clock.getTimef();
+            ops += threads[j].ops;
+        const float fairness = _getFairness( threads, i );
 
-        TEST( !lock->isSet( ));
-        lock->set();
+        // second run measuring the time to acquire the lock
+        _measure = true;
+        _run( lock, threads, i );
 
-        size_t ops = 0;
-        for( size_t j = 0; j < nThreads; ++j )
-            ops += threads[j].ops;
+        const Latencies latencies = getSortedLatencies( threads, i );
 
         std::cout << std::setw(20) << lunchbox::className( lock ) << ", "
                   << std::setw(12) << /*set, test, unset*/ 3 * ops / time
-                  << ", " << std::setw(3) << i << std::endl;
+                  << ", " << std::setw(3) << i << ", " << std::setw(8)
+                  << fairness << ", " << std::setw(7)
+                  << getPercentile( latencies, 50. ) << ", "
+                  << std::setw(7) << getPercentile( latencies, 99. ) << ", "
+                  << std::setw(8) << getPercentile( latencies, 99.9 )
+                  << std::endl;
     }
 
     delete lock;
@@ -109,10 +166,20 @@ int main( int argc, char **argv )
 {
     TEST( lunchbox::init( argc, argv ));
 
-    std::cout << "               Class,       ops/ms, threads" << std::endl;
+    std::cout << "               Class,       ops/ms, threads, fairness,  p50 us,"
+              << "  p99 us, p999 us" << std::endl;
     _test< lunchbox::SpinLock >();
     std::cout << std::endl;
 
+    _test< ParkingSpinLock >();
+    std::cout << std::endl;
+
+    _test< lunchbox::TicketLock >();
+    std::cout << std::endl;
+
+    _test< lunchbox::MCSLock >();
+    std::cout << std::endl;
+
     _test< lunchbox::Lock >();
     std::cout << std::endl;
 
@@ -0,0 +1,161 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define TEST_RUNTIME 300 // seconds
+#include <test.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/condition.h>
+#include <lunchbox/lock.h>
+#include <lunchbox/lockProfile.h>
+#include <lunchbox/mtQueue.h>
+#include <lunchbox/spinLock.h>
+#include <lunchbox/thread.h>
+#include <lunchbox/timedLock.h>
+#include <iostream>
+
+#define NTHREADS 4
+#define NLOOPS 100000
+
+namespace
+{
+lunchbox::LockStats _getStats( const std::string& name )
+{
+    const lunchbox::LockStatsVector stats = lunchbox::LockProfile::getStats();
+    for( size_t i = 0; i < stats.size(); ++i )
+        if( stats[i].name == name )
+            return stats[i];
+    return lunchbox::LockStats();
+}
+
+template< class T > class Thread : public lunchbox::Thread
+{
+public:
+    Thread() : lock( 0 ) {}
+
+    virtual void run()
+    {
+        for( size_t i = 0; i < NLOOPS; ++i )
+        {
+            lock->set();
+            lock->unset();
+        }
+    }
+
+    T* lock;
+};
+
+template< class T > float _runThreads( T& lock, const size_t nThreads )
+{
+    Thread< T > threads[ NTHREADS ];
+    lunchbox::Clock clock;
+    for( size_t i = 0; i < nThreads; ++i )
+    {
+        threads[i].lock = &lock;
+        TEST( threads[i].start( ));
+    }
+    for( size_t i = 0; i < nThreads; ++i )
+        TEST( threads[i].join( ));
+    return float( NLOOPS * nThreads ) / clock.getTimef();
+}
+
+template< class T > void _testLock( const char* name )
+{
+    {
+        T lock( name );
+        TEST( lock.trySet( ));
+        TEST( !lock.trySet( ));
+        lock.unset();
+
+        _runThreads( lock, NTHREADS );
+        const lunchbox::LockStats stats = _getStats( name );
+        TESTINFO( stats.nAcquired == NTHREADS * NLOOPS + 1, stats );
+        TEST( stats.nContended <= stats.nAcquired );
+        TEST( stats.maxWaitTime <= stats.waitTime );
+    }
+
+    // statistics survive the lock and are aggregated by name
+    T first( name );
+    T second( name );
+    first.set();
+    first.unset();
+    second.set();
+    second.unset();
+    const lunchbox::LockStats stats = _getStats( name );
+    TESTINFO( stats.nAcquired == NTHREADS * NLOOPS + 3, stats );
+}
+
+template< class T > void _testPerformance( const char* className )
+{
+    lunchbox::LockProfile::setEnabled( false );
+    T unnamed;
+    T disabled( className );
+    lunchbox::LockProfile::setEnabled( true );
+    T enabled( className );
+
+    const float unnamedRate = _runThreads( unnamed, 1 );
+    const float disabledRate = _runThreads( disabled, 1 );
+    const float enabledRate = _runThreads( enabled, 1 );
+    std::cout << std::setw( 10 ) << className << ", " << std::setw( 12 )
+              << unnamedRate << ", " << std::setw( 12 ) << disabledRate << ", "
+              << std::setw( 12 ) << enabledRate << std::endl;
+}
+}
+
+int main( int, char** )
+{
+    lunchbox::LockProfile::setEnabled( false );
+    {
+        lunchbox::Lock lock( "disabled" );
+        lock.set();
+        lock.unset();
+    }
+    TEST( _getStats( "disabled" ).nAcquired == 0 );
+
+    lunchbox::LockProfile::setEnabled( true );
+    TEST( lunchbox::LockProfile::isEnabled( ));
+    _testLock< lunchbox::Lock >( "Lock" );
+    _testLock< lunchbox::SpinLock >( "SpinLock" );
+    _testLock< lunchbox::TimedLock >( "TimedLock" );
+
+    lunchbox::Condition condition( "Condition" );
+    condition.lock();
+    TEST( !condition.timedWait( 1 ));
+    condition.unlock();
+    const lunchbox::LockStats stats = _getStats( "Condition" );
+    TESTINFO( stats.nAcquired == 2, stats );
+    TEST( stats.holdTime < 1000000 ); // wait time is not held
+
+    // the library names its internal locks
+    lunchbox::MTQueue< int > queue;
+    queue.push( 42 );
+    TEST( queue.pop() == 42 );
+    TEST( _getStats( "lunchbox::MTQueue" ).nAcquired >= 2 );
+
+    lunchbox::LockProfile::resetStats();
+    TEST( _getStats( "SpinLock" ).nAcquired == 0 );
+
+    std::cout << "     Class, unnamed op/ms, disabled op/ms, profiled op/ms"
+              << std::endl;
+    _testPerformance< lunchbox::SpinLock >( "SpinLock" );
+    _testPerformance< lunchbox::Lock >( "Lock" );
+    _testPerformance< lunchbox::TimedLock >( "TimedLock" );
+
+    const lunchbox::LockStatsVector all = lunchbox::LockProfile::getStats();
+    for( size_t i = 0; i < all.size(); ++i )
+        std::cout << all[i] << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -33,6 +33,7 @@ lunchbox::Monitor< bool > boolMonitor;
 class Thread : public lunchbox::Thread
 {
 public:
+    Thread() : time( 0.f ) {}
     virtual ~Thread() {}
     virtual void run()
         {
@@ -45,16 +46,17 @@ public:
                 monitor = -nOps;
             }
 
-            const float time = clock.getTimef();
-            std::cout << 2*NLOOPS/time << " ops/ms" << std::endl;
+            time = clock.getTimef();
         }
+
+    float time;
 };
 
-int main( int, char** )
+static void _testPingPong( const lunchbox::WaitPolicy& policy )
 {
-    TEST( !boolMonitor );
-    boolMonitor = true;
-    TEST( boolMonitor );
+    monitor = 0;
+    monitor.setWaitPolicy( policy );
+    monitor.resetWaitStats();
 
     int64_t nOps = NLOOPS;
     Thread waiter;
@@ -71,6 +73,31 @@ int main( int, char** )
     const float time = clock.getTimef();
 
     TEST( waiter.join( ));
-    std::cout << 2*NLOOPS/time << " ops/ms" << std::endl;
+    const lunchbox::WaitStats stats = monitor.getWaitStats();
+    std::cout << std::setw( 6 ) << policy.nSpins << ", " << std::setw( 6 )
+              << policy.nYields << ", " << std::setw( 8 ) << 2*NLOOPS/time
+              << ", " << std::setw( 8 ) << 2*NLOOPS/waiter.time << ", "
+              << stats << std::endl;
+    TEST( stats.spun + stats.yielded + stats.blocked <= 2 * NLOOPS );
+    TEST( stats.timedOut == 0 );
+    // only phases of the policy satisfy waits
+    TEST( policy.nSpins > 0 || stats.spun == 0 );
+    TEST( policy.nYields > 0 || stats.yielded == 0 );
+}
+
+int main( int, char** )
+{
+    TEST( !boolMonitor );
+    boolMonitor = true;
+    TEST( boolMonitor );
+
+    TEST( !monitor.timedWaitEQ( 42, 10 ));
+    TEST( monitor.getWaitStats().timedOut == 1 );
+
+    std::cout << " spins, yields, ops/ms A, ops/ms B, stats" << std::endl;
+    _testPingPong( lunchbox::WaitPolicy( ));
+    _testPingPong( lunchbox::WaitPolicy( 0, 10 ));
+    _testPingPong( lunchbox::WaitPolicy( 1000, 0 ));
+    _testPingPong( lunchbox::WaitPolicy( 1000, 10 ));
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,164 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Tests that the containers move elements instead of copying them
+
+#include <test.h>
+#include <lunchbox/lfQueue.h>
+#include <lunchbox/lfVector.h>
+#include <lunchbox/mpmcQueue.h>
+#include <lunchbox/mtQueue.h>
+
+#ifdef LB_MOVE_SEMANTICS
+namespace
+{
+size_t _copies = 0;
+
+class Counted
+{
+public:
+    Counted() : value( 0 ) {}
+    Counted( const int v, const int offset ) : value( v + offset ) {}
+    explicit Counted( const int v ) : value( v ) {}
+    Counted( const Counted& from ) : value( from.value ) { ++_copies; }
+    Counted( Counted&& from ) : value( from.value ) { from.value = -1; }
+
+    Counted& operator = ( const Counted& from )
+    {
+        value = from.value;
+        ++_copies;
+        return *this;
+    }
+
+    Counted& operator = ( Counted&& from )
+    {
+        value = from.value;
+        from.value = -1;
+        return *this;
+    }
+
+    int value;
+};
+}
+
+static void _testMTQueue()
+{
+    lunchbox::MTQueue< Counted > queue;
+    Counted counted( 1 );
+    queue.push( std::move( counted ));
+    TEST( counted.value == -1 );
+    queue.pushFront( Counted( 0 ));
+    queue.emplace( 2 );
+    queue.emplace_back( 1, 2 );
+
+    std::vector< Counted > elements( 4 );
+    for( int i = 0; i < 4; ++i )
+        elements[ i ].value = i + 4;
+    queue.push( std::move( elements ));
+    TEST( elements.empty( ));
+    TEST( queue.getSize() == 8 );
+
+    Counted result;
+    TEST( queue.tryPop( result ));
+    TEST( result.value == 0 );
+    TEST( queue.pop().value == 1 );
+    TEST( queue.timedPop( 10, result ));
+    TEST( result.value == 2 );
+
+    elements = queue.timedPopRange( 10, 2, 2 );
+    TEST( elements.size() == 2 );
+    TEST( elements[ 0 ].value == 3 && elements[ 1 ].value == 4 );
+
+    elements.clear();
+    queue.tryPop( 3, elements );
+    TEST( elements.size() == 3 && elements[ 2 ].value == 7 );
+    TEST( queue.isEmpty( ));
+    TESTINFO( _copies == 0, _copies );
+}
+
+static void _testLFQueue()
+{
+    lunchbox::LFQueue< Counted, true > queue( 3 );
+    Counted counted( 0 );
+    TEST( queue.push( std::move( counted )));
+    TEST( counted.value == -1 );
+    TEST( queue.emplace( 1 ));
+    TEST( queue.emplace( 1, 1 ));
+
+    counted.value = 3;
+    TEST( !queue.push( std::move( counted )));
+    TEST( counted.value == 3 ); // untouched on failure
+    TEST( !queue.emplace( 3 ));
+
+    Counted result;
+    TEST( queue.pop( result ));
+    TEST( result.value == 0 );
+
+    Counted results[ 2 ];
+    TEST( queue.pop( results, 2 ) == 2 );
+    TEST( results[ 0 ].value == 1 && results[ 1 ].value == 2 );
+    TESTINFO( _copies == 0, _copies );
+}
+
+static void _testMPMCQueue()
+{
+    lunchbox::MPMCQueue< Counted > queue( 2 );
+    TEST( queue.push( Counted( 0 )));
+    TEST( queue.emplace( 1 ));
+
+    Counted counted( 2 );
+    TEST( !queue.push( std::move( counted )));
+    TEST( counted.value == 2 );
+
+    Counted result;
+    TEST( queue.pop( result ));
+    TEST( result.value == 0 );
+    TEST( queue.pop().value == 1 );
+    TESTINFO( _copies == 0, _copies );
+}
+
+static void _testLFVector()
+{
+    lunchbox::LFVector< Counted > vector;
+    Counted counted( 0 );
+    vector.push_back( std::move( counted ));
+    TEST( counted.value == -1 );
+    vector.push_back( Counted( 1 ), false );
+    vector.emplace_back( 2 );
+    vector.emplace_back( 1, 2 );
+    TEST( vector.size() == 4 );
+    for( int i = 0; i < 4; ++i )
+        TEST( vector[ i ].value == i );
+
+    Counted result;
+    TEST( vector.pop_back( result ));
+    TEST( result.value == 3 );
+    TEST( vector.size() == 3 );
+    TESTINFO( _copies == 0, _copies );
+}
+#endif
+
+int main( int, char** )
+{
+#ifdef LB_MOVE_SEMANTICS
+    _testMTQueue();
+    _testLFQueue();
+    _testMPMCQueue();
+    _testLFVector();
+#endif
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,187 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define TEST_RUNTIME 300 // seconds
+#include <test.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/mpmcQueue.h>
+#include <lunchbox/mtQueue.h>
+#include <lunchbox/sleep.h>
+#include <lunchbox/thread.h>
+#include <iostream>
+
+#define NOPS 200000
+#define MAXTHREADS 64
+
+namespace
+{
+// non-blocking push on both queue types
+bool _push( lunchbox::MPMCQueue< uint64_t >& queue, const uint64_t value )
+{
+    return queue.push( value );
+}
+
+bool _push( lunchbox::MTQueue< uint64_t >& queue, const uint64_t value )
+{
+    queue.push( value );
+    return true;
+}
+}
+
+template< class Q > class WriteThread : public lunchbox::Thread
+{
+public:
+    WriteThread() : queue( 0 ), nOps( 0 ) {}
+    virtual ~WriteThread() {}
+
+    virtual void run()
+    {
+        for( uint64_t i = 1; i <= nOps; ++i )
+            while( !_push( *queue, i ))
+                lunchbox::Thread::yield();
+    }
+
+    Q* queue;
+    uint64_t nOps;
+};
+
+template< class Q > class ReadThread : public lunchbox::Thread
+{
+public:
+    ReadThread() : queue( 0 ), nOps( 0 ), sum( 0 ) {}
+    virtual ~ReadThread() {}
+
+    virtual void run()
+    {
+        sum = 0;
+        for( uint64_t i = 0; i < nOps; ++i )
+            sum += queue->pop();
+    }
+
+    Q* queue;
+    uint64_t nOps;
+    uint64_t sum;
+};
+
+/** Takes back its own elements, waking a timedPop() without an element */
+class StealThread : public lunchbox::Thread
+{
+public:
+    explicit StealThread( lunchbox::MPMCQueue< uint64_t >& queue )
+        : _queue( queue ) {}
+    virtual ~StealThread() {}
+
+    virtual void run()
+    {
+        uint64_t value;
+        for( size_t i = 0; i < 200; ++i ) // about one second
+        {
+            if( _queue.push( 1 ))
+                _queue.pop( value );
+            lunchbox::sleep( 5 );
+        }
+    }
+
+private:
+    lunchbox::MPMCQueue< uint64_t >& _queue;
+};
+
+template< class Q > void _test()
+{
+    Q queue( 1024 );
+    WriteThread< Q > writers[ MAXTHREADS ];
+    ReadThread< Q > readers[ MAXTHREADS ];
+
+    for( size_t nThreads = 1; nThreads <= MAXTHREADS; nThreads <<= 1 )
+    {
+        const uint64_t nOps = NOPS / nThreads;
+        for( size_t i = 0; i < nThreads; ++i )
+        {
+            writers[i].queue = &queue;
+            writers[i].nOps = nOps;
+            readers[i].queue = &queue;
+            readers[i].nOps = nOps;
+        }
+
+        lunchbox::Clock clock;
+        for( size_t i = 0; i < nThreads; ++i )
+        {
+            TEST( readers[i].start( ));
+            TEST( writers[i].start( ));
+        }
+
+        uint64_t sum = 0;
+        for( size_t i = 0; i < nThreads; ++i )
+        {
+            TEST( writers[i].join( ));
+            TEST( readers[i].join( ));
+            sum += readers[i].sum;
+        }
+        const float time = clock.getTimef();
+
+        TEST( queue.isEmpty( ));
+        TESTINFO( sum == nThreads * nOps * ( nOps + 1 ) / 2,
+                  sum << " in " << nThreads << " threads" );
+
+        std::cout << std::setw(30) << lunchbox::className( queue ) << ", "
+                  << std::setw(12) << 2 * nThreads * nOps / time << ", "
+                  << std::setw(3) << nThreads << std::endl;
+    }
+}
+
+int main( int, char** )
+{
+    lunchbox::MPMCQueue< uint64_t > queue( 5 );
+    TEST( queue.getCapacity() == 8 );
+    TEST( queue.isEmpty( ));
+
+    uint64_t result = 0;
+    TEST( !queue.pop( result ));
+    TEST( !queue.timedPop( 10, result ));
+    for( uint64_t i = 0; i < 8; ++i )
+        TEST( queue.push( i ));
+    TEST( !queue.push( 8 ));
+    TEST( queue.getSize() == 8 );
+
+    for( uint64_t i = 0; i < 8; ++i )
+    {
+        TEST( queue.pop( result ));
+        TEST( result == i );
+    }
+    TEST( queue.isEmpty( ));
+
+    // wakeups without an element do not extend the timeout
+    StealThread stealer( queue );
+    TEST( stealer.start( ));
+    for( bool popped = true; popped; )
+    {
+        lunchbox::Clock clock;
+        popped = queue.timedPop( 100, result );
+        const float time = clock.getTimef();
+        TESTINFO( popped || time < 500.f, time );
+    }
+    TEST( stealer.join( ));
+    TEST( queue.isEmpty( ));
+
+    std::cout << "                         Class,       ops/ms, "
+              << "threads (read + write)" << std::endl;
+    _test< lunchbox::MPMCQueue< uint64_t > >();
+    std::cout << std::endl;
+    _test< lunchbox::MTQueue< uint64_t > >();
+
+    return EXIT_SUCCESS;
+}
@@ -1,5 +1,5 @@
 
-/* Copyright (c) 2010-2013, Stefan Eilemann <eile@equalizergraphics.com>
+/* Copyright (c) 2010-2014, Stefan Eilemann <eile@equalizergraphics.com>
  *                    2012, Daniel Nachbaur <danielnachbaur@gmail.com>
  *
  * This library is free software; you can redistribute it and/or modify it under
@@ -58,6 +58,15 @@ public:
 
 int main( int, char** )
 {
+    lunchbox::MTQueue< uint64_t > local;
+    TEST( local.timedPopRange( 10 ).empty( ));
+    local.push( 1 );
+    local.push( 2 );
+    TEST( local.waitSize( 2 ) == 2 );
+    const std::vector< uint64_t > range = local.timedPopRange( 10, 1, 5 );
+    TEST( range.size() == 2 && range[0] == 1 && range[1] == 2 );
+    TEST( local.isEmpty( ));
+
     ReadThread reader[ NTHREADS ];
     for( size_t i = 0; i < NTHREADS; ++i )
         TEST( reader[i].start( ));
@@ -0,0 +1,155 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define TEST_RUNTIME 300 // seconds
+#include <test.h>
+#include <lunchbox/atomic.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/magazinePool.h>
+#include <lunchbox/pool.h>
+#include <lunchbox/sleep.h>
+#include <lunchbox/thread.h>
+#include <iostream>
+
+#define MAXTHREADS 64
+#define NOPS 4000000
+#define BATCH 8
+
+namespace
+{
+lunchbox::a_int32_t _nItems;
+
+struct Item
+{
+    Item() { ++_nItems; }
+    ~Item() { --_nItems; }
+    char data[ 64 ];
+};
+
+typedef lunchbox::MagazinePool< Item, 4 > SmallPool;
+
+template< class P > class Thread : public lunchbox::Thread
+{
+public:
+    Thread() : pool( 0 ), nOps( 0 ) {}
+
+    virtual void run()
+    {
+        Item* items[ BATCH ];
+        for( size_t i = 0; i < nOps; i += BATCH )
+        {
+            for( size_t j = 0; j < BATCH; ++j )
+                items[j] = pool->alloc();
+            for( size_t j = 0; j < BATCH; ++j )
+                pool->release( items[j] );
+        }
+    }
+
+    P* pool;
+    size_t nOps;
+};
+
+void _testMagazinePool()
+{
+    {
+        SmallPool pool;
+        Item* items[ 20 ];
+        for( size_t i = 0; i < 20; ++i )
+            items[i] = pool.alloc();
+        TEST( _nItems == 20 );
+        for( size_t i = 0; i < 20; ++i )
+            pool.release( items[i] );
+        TEST( _nItems == 20 );
+
+        // two magazines stay with the thread, three went to the depot
+        TESTINFO( pool.getNCached() == 12, pool.getNCached( ));
+        TEST( pool.alloc() == items[19] );
+        pool.release( items[19] );
+
+        // the first trim sees all magazines in use
+        TEST( pool.trim() == 0 );
+        TEST( pool.trim() == 12 );
+        TEST( pool.getNCached() == 0 );
+        TEST( _nItems == 8 );
+
+        pool.setMaxCached( 4 );
+        TEST( pool.getMaxCached() == 4 );
+        for( size_t i = 0; i < 20; ++i )
+            items[i] = pool.alloc();
+        for( size_t i = 0; i < 20; ++i )
+            pool.release( items[i] );
+        TEST( pool.getNCached() == 4 );
+        TEST( _nItems == 12 );
+
+        // the magazines of an exiting thread go to the depot
+        pool.setMaxCached( 100 );
+        Thread< SmallPool > thread;
+        thread.pool = &pool;
+        thread.nOps = BATCH;
+        TEST( thread.start( ));
+        TEST( thread.join( ));
+        // join() may return before the thread-local destructors ran
+        for( size_t i = 0; i < 1000 && pool.getNCached() < BATCH; ++i )
+            lunchbox::sleep( 1 );
+        TESTINFO( pool.getNCached() == BATCH, pool.getNCached( ));
+        TEST( _nItems == 16 );
+
+        pool.flush();
+        TEST( pool.getNCached() == 0 );
+        TEST( _nItems == 0 );
+
+        pool.release( pool.alloc( ));
+    }
+    TEST( _nItems == 0 );
+}
+
+template< class P > float _benchmark( const size_t nThreads )
+{
+    P pool;
+    Thread< P > threads[ MAXTHREADS ];
+    lunchbox::Clock clock;
+    for( size_t i = 0; i < nThreads; ++i )
+    {
+        threads[i].pool = &pool;
+        threads[i].nOps = NOPS / nThreads;
+        TEST( threads[i].start( ));
+    }
+    for( size_t i = 0; i < nThreads; ++i )
+        TEST( threads[i].join( ));
+    return float( NOPS / nThreads * nThreads ) / clock.getTimef();
+}
+}
+
+int main( int, char** )
+{
+    _testMagazinePool();
+
+    std::cout << "threads, MagazinePool ops/ms, Pool< T, true > ops/ms"
+              << std::endl;
+    for( size_t nThreads = 1; nThreads <= MAXTHREADS; nThreads <<= 1 )
+    {
+        const float magazineRate =
+            _benchmark< lunchbox::MagazinePool< Item > >( nThreads );
+        const float lockedRate =
+            _benchmark< lunchbox::Pool< Item, true > >( nThreads );
+        TEST( _nItems == 0 );
+        std::cout << std::setw( 7 ) << nThreads << ", " << std::setw( 20 )
+                  << magazineRate << ", " << std::setw( 23 ) << lockedRate
+                  << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
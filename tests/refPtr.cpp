@@ -18,9 +18,13 @@
 
 #define TEST_RUNTIME 300 // seconds
 #include <test.h>
+#include <lunchbox/atomic.h>
+#include <lunchbox/biasedReferenced.h>
 #include <lunchbox/clock.h>
+#include <lunchbox/localReferenced.h>
 #include <lunchbox/refPtr.h>
 #include <lunchbox/referenced.h>
+#include <lunchbox/sleep.h>
 #include <lunchbox/thread.h>
 #include <iostream>
 
@@ -107,8 +111,151 @@ public:
         }
 };
 
+lunchbox::a_int32_t nDeleted;
+
+class LocalFoo : public lunchbox::LocalReferenced
+{
+public:
+    LocalFoo() {}
+private:
+    virtual ~LocalFoo() { ++nDeleted; }
+};
+
+class BiasedFoo : public lunchbox::BiasedReferenced
+{
+public:
+    BiasedFoo() {}
+private:
+    virtual ~BiasedFoo() { ++nDeleted; }
+};
+
+typedef lunchbox::RefPtr< LocalFoo > LocalFooPtr;
+typedef lunchbox::RefPtr< BiasedFoo > BiasedFooPtr;
+BiasedFooPtr biasedFoo;
+
+template< class T > float _benchmark( const lunchbox::RefPtr< T >& object )
+{
+    lunchbox::RefPtr< T > copy;
+    lunchbox::Clock clock;
+    for( size_t i = 0; i < NREFS * 10; ++i )
+    {
+        copy = object;
+        lunchbox::RefPtr< T > other( copy );
+        copy = 0;
+    }
+    return clock.getTimef() / ( 3 * NREFS * 10 ) * 1000000;
+}
+
+/** Takes and releases references to an object owned by the main thread. */
+class BiasedThread : public lunchbox::Thread
+{
+public:
+    virtual void run()
+        {
+            const BiasedFooPtr object = biasedFoo;
+            for( size_t i = 0; i < NREFS; ++i )
+            {
+                BiasedFooPtr myFoo = object;
+                boost::intrusive_ptr< BiasedFoo > boostFoo( myFoo.get( ));
+            }
+        }
+};
+
+/** Releases a reference taken by the main thread. */
+class ReleaseThread : public lunchbox::Thread
+{
+public:
+    virtual void run() { object = 0; }
+    BiasedFooPtr object;
+};
+
+/** Creates an object and exits while it is still referenced. */
+class OwnerThread : public lunchbox::Thread
+{
+public:
+    virtual void run() { object = new BiasedFoo; }
+    BiasedFooPtr object;
+};
+
+void _testLocalBiased()
+{
+    // single-threaded use
+    {
+        LocalFooPtr local = new LocalFoo;
+        LocalFooPtr localCopy = local;
+        boost::intrusive_ptr< LocalFoo > boostLocal( local.get( ));
+        TEST( local->getRefCount() == 3 );
+
+        BiasedFooPtr biased = new BiasedFoo;
+        BiasedFooPtr biasedCopy = biased;
+        boost::intrusive_ptr< BiasedFoo > boostBiased( biased.get( ));
+        TEST( biased->getRefCount() == 3 );
+
+        const FooPtr atomic = new Foo;
+        std::cout << "ns per single-threaded RefPtr operation: Referenced "
+                  << _benchmark( atomic ) << ", LocalReferenced "
+                  << _benchmark( local ) << ", BiasedReferenced "
+                  << _benchmark( biased ) << std::endl;
+    }
+    TEST( nDeleted == 2 );
+    nDeleted = 0;
+
+    // references of other threads
+    biasedFoo = new BiasedFoo;
+    BiasedThread threads[NTHREADS];
+    for( size_t i = 0; i < NTHREADS; ++i )
+        TEST( threads[i].start( ));
+    for( size_t i = 0; i < NTHREADS; ++i )
+        TEST( threads[i].join( ));
+    TEST( biasedFoo->getRefCount() == 1 );
+    biasedFoo = 0;
+    TEST( nDeleted == 1 );
+    nDeleted = 0;
+
+    // reference of the owner released by another thread
+    BiasedFooPtr object = new BiasedFoo;
+    ReleaseThread releaser;
+    releaser.object = object;
+    TEST( object->getRefCount() == 2 );
+    TEST( releaser.start( ));
+    TEST( releaser.join( ));
+    TEST( object->getRefCount() == 1 );
+
+    // deleted when the owner merges queued objects
+    const BiasedFoo* pending = object.get();
+    object = 0;
+    TEST( pending->getRefCount() == 0 );
+    TEST( nDeleted == 0 );
+    lunchbox::BiasedReferenced::mergeQueued();
+    TEST( nDeleted == 1 );
+
+    // or when it releases the last reference to another object
+    object = new BiasedFoo;
+    releaser.object = object;
+    TEST( releaser.start( ));
+    TEST( releaser.join( ));
+    object = new BiasedFoo;
+    TEST( nDeleted == 1 );
+    object = 0;
+    TEST( nDeleted == 3 );
+    nDeleted = 0;
+
+    // last reference released after the owner thread exited
+    OwnerThread owner;
+    TEST( owner.start( ));
+    TEST( owner.join( ));
+    TEST( owner.object->getRefCount() == 1 );
+    owner.object = 0;
+    // join() may return before the owner cleans up its thread-local queue
+    for( size_t i = 0; i < 1000 && nDeleted == 0; ++i )
+        lunchbox::sleep( 1 );
+    TEST( nDeleted == 1 );
+}
+
 int main( int, char** )
 {
+    _testLocalBiased();
+
     foo = new Foo;
 
     TestThread threads[NTHREADS];
@@ -21,12 +21,18 @@
 
 #include "test.h"
 
+#include <lunchbox/clock.h>
 #include <lunchbox/mtQueue.h>
 #include <lunchbox/requestHandler.h>
 #include <lunchbox/sleep.h>
 #include <lunchbox/thread.h>
 #include <lunchbox/uint128_t.h>
 
+#include <algorithm>
+#include <iostream>
+
+#define NREQUESTS 20000
+
 using lunchbox::uint128_t;
 
 lunchbox::RequestHandler handler_;
@@ -66,6 +72,50 @@ public:
     }
 };
 
+/** Serves requests, recording the time before serving them */
+class Server : public lunchbox::Thread
+{
+public:
+    Server() : served( NREQUESTS ) {}
+
+    virtual void run() final
+    {
+        for( size_t i = 0; i < NREQUESTS; ++i )
+        {
+            const uint32_t request = requestQ_.pop();
+            served[i] = clock.getTimed();
+            handler_.serveRequest( request );
+        }
+    }
+
+    lunchbox::Clock clock;
+    std::vector< double > served;
+};
+
+static void _testServeLatency()
+{
+    Server server;
+    TEST( server.start( ));
+
+    std::vector< float > latencies( NREQUESTS );
+    lunchbox::Clock clock;
+    for( size_t i = 0; i < NREQUESTS; ++i )
+    {
+        const uint32_t request = handler_.registerRequest();
+        requestQ_.push( request );
+        TEST( handler_.waitRequest( request ));
+        latencies[i] = float( server.clock.getTimed() - server.served[i] );
+    }
+    const float time = clock.getTimef();
+    TEST( server.join( ));
+
+    std::sort( latencies.begin(), latencies.end( ));
+    const float p50 = latencies[ NREQUESTS / 2 ] * 1000.f;
+    const float p99 = latencies[ NREQUESTS * 99 / 100 ] * 1000.f;
+    std::cout << NREQUESTS / time << " requests/ms, serve-to-wake p50 "
+              << p50 << " us, p99 " << p99 << " us" << std::endl;
+}
+
 int main( int, char** )
 {
     uint8_t* payload = (uint8_t*)42;
@@ -100,5 +150,6 @@ int main( int, char** )
     TEST( handler_.isRequestServed( voidFuture.getID( )));
 
     TEST( thread.join( ));
+    _testServeLatency();
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,287 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define TEST_RUNTIME 300 // seconds
+#include <test.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/lfQueue.h>
+#include <lunchbox/ringBuffer.h>
+#include <lunchbox/thread.h>
+#include <iostream>
+
+#define NPRODUCERS 4
+#define NRECORDS 100000
+#define MAXRECORD 200
+
+namespace
+{
+typedef lunchbox::RingBuffer RingBuffer;
+typedef std::vector< uint8_t > Bytes;
+
+size_t _getRecordSize( const uint32_t seq ) { return 8 + seq % MAXRECORD; }
+
+void _fill( uint8_t* data, const size_t size, const uint32_t id,
+            const uint32_t seq )
+{
+    ::memcpy( data, &id, 4 );
+    ::memcpy( data + 4, &seq, 4 );
+    for( size_t i = 8; i < size; ++i )
+        data[i] = uint8_t( seq + i );
+}
+
+bool _check( const uint8_t* data, const size_t size, uint32_t& id,
+             uint32_t& seq )
+{
+    ::memcpy( &id, data, 4 );
+    ::memcpy( &seq, data + 4, 4 );
+    if( size != _getRecordSize( seq ))
+        return false;
+    for( size_t i = 8; i < size; ++i )
+        if( data[i] != uint8_t( seq + i ))
+            return false;
+    return true;
+}
+
+class Producer : public lunchbox::Thread
+{
+public:
+    Producer() : ring( 0 ), id( 0 ) {}
+
+    virtual void run()
+    {
+        for( uint32_t seq = 0; seq < NRECORDS; ++seq )
+        {
+            const size_t size = _getRecordSize( seq );
+            RingBuffer::WriteSpan record = ring->reserve( size );
+            while( record.isEmpty( ))
+            {
+                lunchbox::Thread::yield();
+                record = ring->reserve( size );
+            }
+            _fill( record.data, record.size, id, seq );
+            ring->commit( record );
+        }
+    }
+
+    RingBuffer* ring;
+    uint32_t id;
+};
+
+/** Streams records of a fixed size into a ring buffer */
+class RingWriter : public lunchbox::Thread
+{
+public:
+    RingWriter() : ring( 0 ), size( 0 ) {}
+
+    virtual void run()
+    {
+        for( size_t i = 0; i < NRECORDS; ++i )
+        {
+            RingBuffer::WriteSpan record = ring->reserve( size );
+            while( record.isEmpty( ))
+            {
+                lunchbox::Thread::yield();
+                record = ring->reserve( size );
+            }
+            ::memset( record.data, int( i ), size );
+            ring->commit( record );
+        }
+    }
+
+    RingBuffer* ring;
+    size_t size;
+};
+
+/** Baseline: heap-allocated buffers passed through an LFQueue */
+class QueueWriter : public lunchbox::Thread
+{
+public:
+    QueueWriter() : queue( 0 ), size( 0 ) {}
+
+    virtual void run()
+    {
+        for( size_t i = 0; i < NRECORDS; ++i )
+        {
+            Bytes* bytes = new Bytes( size );
+            ::memset( &(*bytes)[0], int( i ), size );
+            while( !queue->push( bytes ))
+                lunchbox::Thread::yield();
+        }
+    }
+
+    lunchbox::LFQueue< Bytes* >* queue;
+    size_t size;
+};
+}
+
+static void _testBasic()
+{
+    RingBuffer ring( 100 );
+    TEST( ring.getSize() == 128 );
+    TEST( ring.isEmpty( ));
+    TEST( ring.peek().isEmpty( ));
+
+    RingBuffer::WriteSpan first = ring.reserve( 10 );
+    TEST( !first.isEmpty( ));
+    TEST( first.size == 10 );
+    RingBuffer::WriteSpan second = ring.reserve( 20 );
+    TEST( !second.isEmpty( ));
+    TEST( !ring.isEmpty( ));
+    ::memset( first.data, 1, first.size );
+    ::memset( second.data, 2, second.size );
+
+    ring.commit( second );
+    TEST( ring.peek().isEmpty( )); // first not committed yet
+    ring.commit( first );
+
+    RingBuffer::ReadSpan record = ring.peek();
+    TEST( record.size == 10 );
+    TEST( record.data[0] == 1 && record.data[9] == 1 );
+    ring.release();
+    record = ring.peek();
+    TEST( record.size == 20 );
+    TEST( record.data[0] == 2 && record.data[19] == 2 );
+    ring.release();
+    TEST( ring.peek().isEmpty( ));
+    TEST( ring.isEmpty( ));
+
+    // fill: 32 bytes per record with header and alignment, 8 bytes padding
+    size_t nRecords = 0;
+    for( RingBuffer::WriteSpan write = ring.reserve( 20 ); !write.isEmpty();
+         write = ring.reserve( 20 ))
+    {
+        ring.commit( write );
+        ++nRecords;
+    }
+    TEST( nRecords == 3 );
+    for( size_t i = 0; i < nRecords; ++i )
+    {
+        TEST( ring.peek().size == 20 );
+        ring.release();
+    }
+
+    // wrap around with padding
+    for( uint32_t seq = 0; seq < 1000; ++seq )
+    {
+        const size_t size = 1 + seq % 50;
+        RingBuffer::WriteSpan write = ring.reserve( size );
+        TEST( !write.isEmpty( ));
+        ::memset( write.data, int( seq ), size );
+        ring.commit( write );
+
+        RingBuffer::ReadSpan read = ring.peek();
+        TEST( read.size == size );
+        TEST( read.data[0] == uint8_t( seq ) &&
+              read.data[ size - 1 ] == uint8_t( seq ));
+        ring.release();
+    }
+    TEST( ring.isEmpty( ));
+}
+
+static void _testConcurrent()
+{
+    RingBuffer ring( 4096 );
+    Producer producers[ NPRODUCERS ];
+    for( uint32_t i = 0; i < NPRODUCERS; ++i )
+    {
+        producers[i].ring = &ring;
+        producers[i].id = i;
+        TEST( producers[i].start( ));
+    }
+
+    uint32_t next[ NPRODUCERS ] = { 0 };
+    for( size_t i = 0; i < NRECORDS * NPRODUCERS; ++i )
+    {
+        RingBuffer::ReadSpan record = ring.peek();
+        while( record.isEmpty( ))
+        {
+            lunchbox::Thread::yield();
+            record = ring.peek();
+        }
+
+        uint32_t id = 0;
+        uint32_t seq = 0;
+        TEST( _check( record.data, record.size, id, seq ));
+        TEST( id < NPRODUCERS );
+        TESTINFO( seq == next[ id ], seq << " != " << next[ id ] );
+        ++next[ id ];
+        ring.release();
+    }
+
+    for( size_t i = 0; i < NPRODUCERS; ++i )
+        TEST( producers[i].join( ));
+    TEST( ring.isEmpty( ));
+}
+
+static void _testPerformance()
+{
+    std::cout << "      Class,  size, records/ms" << std::endl;
+    for( size_t size = 64; size <= 4096; size <<= 3 )
+    {
+        RingBuffer ring( 1024 * 1024 );
+        RingWriter ringWriter;
+        ringWriter.ring = &ring;
+        ringWriter.size = size;
+
+        lunchbox::Clock clock;
+        TEST( ringWriter.start( ));
+        for( size_t i = 0; i < NRECORDS; ++i )
+        {
+            RingBuffer::ReadSpan record = ring.peek();
+            while( record.isEmpty( ))
+            {
+                lunchbox::Thread::yield();
+                record = ring.peek();
+            }
+            TEST( record.size == size && record.data[0] == uint8_t( i ));
+            ring.release();
+        }
+        TEST( ringWriter.join( ));
+        const float ringTime = clock.getTimef();
+
+        lunchbox::LFQueue< Bytes* > queue( 1024 * 1024 / size );
+        QueueWriter queueWriter;
+        queueWriter.queue = &queue;
+        queueWriter.size = size;
+
+        clock.reset();
+        TEST( queueWriter.start( ));
+        for( size_t i = 0; i < NRECORDS; ++i )
+        {
+            Bytes* bytes = 0;
+            while( !queue.pop( bytes ))
+                lunchbox::Thread::yield();
+            TEST( bytes->size() == size && (*bytes)[0] == uint8_t( i ));
+            delete bytes;
+        }
+        TEST( queueWriter.join( ));
+        const float queueTime = clock.getTimef();
+
+        std::cout << " RingBuffer, " << std::setw( 5 ) << size << ", "
+                  << std::setw( 10 ) << NRECORDS / ringTime << std::endl
+                  << "    LFQueue, " << std::setw( 5 ) << size << ", "
+                  << std::setw( 10 ) << NRECORDS / queueTime << std::endl;
+    }
+}
+
+int main( int, char** )
+{
+    _testBasic();
+    _testConcurrent();
+    _testPerformance();
+    return EXIT_SUCCESS;
+}
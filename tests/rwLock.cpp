@@ -17,6 +17,7 @@
 
 #define TEST_RUNTIME 600 // seconds, needed for NighlyMemoryCheck
 #include "test.h"
+#include "latency.h"
 
 #include <lunchbox/atomic.h>
 #include <lunchbox/clock.h>
@@ -24,6 +25,7 @@
 #include <lunchbox/init.h>
 #include <lunchbox/lock.h>
 #include <lunchbox/omp.h>
+#include <lunchbox/rwLock.h>
 #include <lunchbox/spinLock.h>
 #include <lunchbox/timedLock.h>
 
@@ -48,14 +50,23 @@ public:
     T* lock;
     size_t ops;
     double sTime;
+    Latencies latencies; // of writers
 
     virtual void run()
         {
             ops = 0;
             sTime = 0.;
+            latencies.clear();
+            latencies.reserve( MAXSAMPLES );
+            const lunchbox::Clock clock;
+
             while( LB_LIKELY( _running ))
             {
-                lock->set();
+                // the first set() waits for the start of the run
+                if( ops > 0 )
+                    setSampled( *lock, clock, latencies );
+                else
+                    lock->set();
                 TEST( lock->isSetWrite( ));
                 // cppcheck-suppress duplicateExpression
                 if( hold > 0 ) // static, optimized out
@@ -117,7 +128,7 @@ template< class T, uint32_t hold > void _test()
     ReadThread< T, hold > readers[MAXTHREADS];
 
     std::cout << "               Class, write ops/ms,  read ops/ms, w threads, "
-              << "r threads" << std::endl;
+              << "r threads, w p50 us, w p99 us" << std::endl;
     for( size_t nWrite = 0; nWrite <= nThreads;
          nWrite = (nWrite == 0) ? 1 : nWrite << 1 )
     {
@@ -161,6 +172,7 @@ template< class T, uint32_t hold > void _test()
                 nWriteOps += writers[j].ops;
                 wTime -= writers[j].sTime;
             }
+            const Latencies latencies = getSortedLatencies( writers, nWrite );
             if( nWrite > 0 )
                 wTime /= double( nWrite );
             if( wTime == 0.f )
@@ -183,6 +195,9 @@ template< class T, uint32_t hold > void _test()
                       << std::setw(12) << 3 * nWriteOps / wTime << ", "
                       << std::setw(12) << 3 * nReadOps / rTime << ", "
                       << std::setw(9) << nWrite << ", " << std::setw(9) << nRead
+                      << ", " << std::setw(8)
+                      << getPercentile( latencies, 50. ) << ", "
+                      << std::setw(8) << getPercentile( latencies, 99. )
                       << std::endl;
         }
     }
@@ -197,6 +212,7 @@ int main( int argc, char **argv )
 
     std::cerr << "0 ms in locked region" << std::endl;
     _test< lunchbox::SpinLock, 0 >();
+    _test< lunchbox::RWLock, 0 >();
 #if 0 // time collection not yet correct
     std::cerr << "1 ms in locked region" << std::endl;
     _test< lunchbox::SpinLock, 1 >();
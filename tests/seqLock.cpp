@@ -0,0 +1,220 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define TEST_RUNTIME 300 // seconds
+#include <test.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/monitor.h>
+#include <lunchbox/scopedMutex.h>
+#include <lunchbox/seqLock.h>
+#include <lunchbox/thread.h>
+#include <iostream>
+
+#define MAXTHREADS 8
+#define NREADS 1000000
+
+namespace
+{
+lunchbox::a_int32_t _running;
+
+/** A value of N words, all equal if read consistently */
+template< size_t N > struct Value
+{
+    Value() { set( 0 ); }
+
+    void set( const uint64_t value )
+    {
+        for( size_t i = 0; i < N; ++i )
+            words[i] = value;
+    }
+
+    bool isConsistent() const
+    {
+        for( size_t i = 1; i < N; ++i )
+            if( words[i] != words[0] )
+                return false;
+        return true;
+    }
+
+    uint64_t words[ N ];
+};
+
+/** Baseline: a value guarded by a SpinLock */
+template< class T > class LockedValue
+{
+public:
+    T get() const
+    {
+        lunchbox::ScopedFastWrite mutex( _lock );
+        return _value;
+    }
+
+    void set( const T& value )
+    {
+        lunchbox::ScopedFastWrite mutex( _lock );
+        _value = value;
+    }
+
+private:
+    mutable lunchbox::SpinLock _lock;
+    T _value;
+};
+
+template< class L, size_t N > class Reader : public lunchbox::Thread
+{
+public:
+    Reader() : lock( 0 ), nInconsistent( 0 ) {}
+
+    virtual void run()
+    {
+        for( size_t i = 0; i < NREADS; ++i )
+            if( !lock->get().isConsistent( ))
+                ++nInconsistent;
+    }
+
+    const L* lock;
+    size_t nInconsistent;
+};
+
+template< class L, size_t N > class Writer : public lunchbox::Thread
+{
+public:
+    Writer() : lock( 0 ), nWrites( 0 ) {}
+
+    virtual void run()
+    {
+        Value< N > value;
+        while( _running )
+        {
+            value.set( ++nWrites );
+            lock->set( value );
+            lunchbox::Thread::yield();
+        }
+    }
+
+    L* lock;
+    uint64_t nWrites;
+};
+
+template< class L, size_t N > float _benchmark( const size_t nThreads )
+{
+    L lock;
+    Reader< L, N > readers[ MAXTHREADS ];
+    Writer< L, N > writer;
+    writer.lock = &lock;
+
+    _running = 1;
+    TEST( writer.start( ));
+    lunchbox::Clock clock;
+    for( size_t i = 0; i < nThreads; ++i )
+    {
+        readers[i].lock = &lock;
+        TEST( readers[i].start( ));
+    }
+    for( size_t i = 0; i < nThreads; ++i )
+        TEST( readers[i].join( ));
+    const float time = clock.getTimef();
+    _running = 0;
+    TEST( writer.join( ));
+
+    for( size_t i = 0; i < nThreads; ++i )
+        TESTINFO( readers[i].nInconsistent == 0, readers[i].nInconsistent );
+    return float( NREADS * nThreads ) / time;
+}
+
+/** Modifies a non-trivially copyable monitor value */
+class StringWriter : public lunchbox::Thread
+{
+public:
+    explicit StringWriter( lunchbox::Monitor< std::string >& monitor )
+        : _monitor( monitor ) {}
+
+    virtual void run()
+    {
+        for( size_t i = 0; _running; ++i )
+            _monitor = std::string( 16 + i % 256, char( 'a' + i % 26 ));
+    }
+
+private:
+    lunchbox::Monitor< std::string >& _monitor;
+};
+
+void _testNonTrivial()
+{
+    lunchbox::Monitor< std::string > monitor( "a" );
+    StringWriter writer( monitor );
+    _running = 1;
+    TEST( writer.start( ));
+
+    for( size_t i = 0; i < NREADS / 10; ++i )
+    {
+        const std::string value = monitor.waitNE( std::string( ));
+        TEST( value.find_first_not_of( value[0] ) == std::string::npos );
+    }
+    _running = 0;
+    TEST( writer.join( ));
+}
+
+template< size_t N > void _testPerformance()
+{
+    typedef Value< N > Value_t;
+    for( size_t nThreads = 1; nThreads <= MAXTHREADS; nThreads <<= 1 )
+    {
+        const float seqRate =
+            _benchmark< lunchbox::SeqLock< Value_t >, N >( nThreads );
+        const float lockedRate =
+            _benchmark< LockedValue< Value_t >, N >( nThreads );
+        std::cout << std::setw( 5 ) << sizeof( Value_t ) << ", "
+                  << std::setw( 7 ) << nThreads << ", " << std::setw( 12 )
+                  << seqRate << ", " << std::setw( 12 ) << lockedRate
+                  << std::endl;
+    }
+}
+}
+
+int main( int, char** )
+{
+    lunchbox::SeqLock< Value< 4 > > lock;
+    TEST( lock.getSequence() == 0 );
+    TEST( lock.get().isConsistent( ));
+
+    Value< 4 > value;
+    value.set( 42 );
+    lock.set( value );
+    TEST( lock.getSequence() == 2 );
+    TEST( lock.get().words[3] == 42 );
+
+    lock.beginWrite().words[0] = 17;
+    TEST( lock.getSequence() == 3 );
+    TEST( !lock.tryGet( value ));
+    lock.endWrite();
+    TEST( lock.tryGet( value ));
+    TEST( value.words[0] == 17 && value.words[1] == 42 );
+
+    lunchbox::Monitor< lunchbox::uint128_t > monitor;
+    monitor = lunchbox::uint128_t( 1, 2 );
+    TEST( monitor == lunchbox::uint128_t( 1, 2 ));
+    TEST( monitor.waitGE( lunchbox::uint128_t( 1, 0 )) ==
+          lunchbox::uint128_t( 1, 2 ));
+    _testNonTrivial();
+
+    std::cout << "bytes, threads, SeqLock reads/ms, SpinLock reads/ms"
+              << std::endl;
+    _testPerformance< 2 >();
+    _testPerformance< 8 >();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,92 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define TEST_RUNTIME 300 // seconds
+#include <test.h>
+#include <lunchbox/atomic.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/shardedCounter.h>
+#include <lunchbox/thread.h>
+#include <iostream>
+
+#define MAXTHREADS 64
+#define NOPS 1000000
+
+namespace
+{
+template< class C > class Thread : public lunchbox::Thread
+{
+public:
+    Thread() : counter( 0 ), nOps( 0 ) {}
+
+    virtual void run()
+    {
+        for( size_t i = 0; i < nOps; ++i )
+            ++(*counter);
+    }
+
+    C* counter;
+    size_t nOps;
+};
+
+template< class C > float _benchmark( C& counter, const size_t nThreads )
+{
+    Thread< C > threads[ MAXTHREADS ];
+    lunchbox::Clock clock;
+    for( size_t i = 0; i < nThreads; ++i )
+    {
+        threads[i].counter = &counter;
+        threads[i].nOps = NOPS / nThreads;
+        TEST( threads[i].start( ));
+    }
+    for( size_t i = 0; i < nThreads; ++i )
+        TEST( threads[i].join( ));
+    return float( NOPS / nThreads * nThreads ) / clock.getTimef();
+}
+}
+
+int main( int, char** )
+{
+    lunchbox::ShardedCounter counter( 42 );
+    TEST( counter.get() == 42 );
+    TEST( counter.getNSlots() > 0 );
+    TEST(( counter.getNSlots() & ( counter.getNSlots() - 1 )) == 0 );
+
+    ++counter;
+    counter += 10;
+    --counter;
+    counter -= 2;
+    TEST( counter.get() == 50 );
+
+    std::cout << "threads, ShardedCounter ops/ms, a_ssize_t ops/ms"
+              << std::endl;
+    for( size_t nThreads = 1; nThreads <= MAXTHREADS; nThreads <<= 1 )
+    {
+        lunchbox::ShardedCounter sharded;
+        lunchbox::a_ssize_t atomic( 0 );
+        const float shardedRate = _benchmark( sharded, nThreads );
+        const float atomicRate = _benchmark( atomic, nThreads );
+
+        const ssize_t nOps = ssize_t( NOPS / nThreads * nThreads );
+        TESTINFO( sharded.get() == nOps, sharded.get( ));
+        TEST( ssize_t( atomic ) == nOps );
+        std::cout << std::setw( 7 ) << nThreads << ", " << std::setw( 22 )
+                  << shardedRate << ", " << std::setw( 16 ) << atomicRate
+                  << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
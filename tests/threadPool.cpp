@@ -0,0 +1,271 @@
+
+/* Copyright (c) 2014, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define TEST_RUNTIME 300 // seconds
+#include <test.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/mtQueue.h>
+#include <lunchbox/sleep.h>
+#include <lunchbox/threadPool.h>
+#include <lunchbox/workStealingDeque.h>
+#include <boost/bind.hpp>
+#include <iostream>
+
+#define NTASKS 100000
+#define MAXTHREADS 16
+#define NSTEALERS 4
+
+namespace
+{
+typedef lunchbox::WorkStealingDeque< uint64_t > Deque;
+lunchbox::a_int32_t _nExecuted;
+
+void _increment() { ++_nExecuted; }
+int _square( const int x ) { return x * x; }
+
+void _postSteadily( lunchbox::ThreadPool& pool )
+{
+    for( size_t i = 0; i < 200; ++i ) // about one second
+    {
+        pool.post( &_increment );
+        lunchbox::sleep( 5 );
+    }
+}
+
+uint64_t _fibonacci( lunchbox::ThreadPool& pool, const uint64_t n )
+{
+    if( n < 12 ) // sequential cutoff
+        return n < 2 ? n : _fibonacci( pool, n - 1 ) + _fibonacci( pool, n-2 );
+
+    ++_nExecuted;
+    lunchbox::Future< uint64_t > left =
+        pool.post( boost::bind( &_fibonacci, boost::ref( pool ), n - 1 ));
+    const uint64_t right = _fibonacci( pool, n - 2 );
+    return left.wait() + right;
+}
+
+class StealThread : public lunchbox::Thread
+{
+public:
+    StealThread() : deque( 0 ), sum( 0 ), nStolen( 0 ) {}
+
+    virtual void run()
+    {
+        sum = 0;
+        nStolen = 0;
+        while( !done )
+        {
+            uint64_t value;
+            if( deque->steal( value ))
+            {
+                sum += value;
+                ++nStolen;
+            }
+        }
+        uint64_t value; // drain after owner stopped
+        while( deque->steal( value ))
+        {
+            sum += value;
+            ++nStolen;
+        }
+    }
+
+    Deque* deque;
+    uint64_t sum;
+    uint64_t nStolen;
+    static lunchbox::a_int32_t done;
+};
+lunchbox::a_int32_t StealThread::done;
+
+/** The hand-rolled baseline: all workers pop from one shared MTQueue. */
+class SharedQueueWorker : public lunchbox::Thread
+{
+public:
+    SharedQueueWorker() : queue( 0 ) {}
+
+    virtual void run()
+    {
+        while( true )
+        {
+            lunchbox::ThreadPool::Task* task = queue->pop();
+            if( !task )
+                return;
+            (*task)();
+            delete task;
+        }
+    }
+
+    lunchbox::MTQueue< lunchbox::ThreadPool::Task* >* queue;
+};
+}
+
+static void _testDeque()
+{
+    Deque deque( 4 );
+    TEST( deque.isEmpty( ));
+
+    uint64_t result = 0;
+    TEST( !deque.pop( result ));
+    TEST( !deque.steal( result ));
+
+    for( uint64_t i = 0; i < 100; ++i ) // grows
+        deque.push( i );
+    TEST( deque.getSize() == 100 );
+
+    TEST( deque.steal( result ));
+    TEST( result == 0 ); // FIFO for thieves
+    TEST( deque.pop( result ));
+    TEST( result == 99 ); // LIFO for owner
+
+    for( uint64_t i = 98; i > 0; --i )
+    {
+        TEST( deque.pop( result ));
+        TEST( result == i );
+    }
+    TEST( deque.isEmpty( ));
+
+    // concurrent owner push/pop with thieves
+    StealThread thieves[ NSTEALERS ];
+    StealThread::done = 0;
+    for( size_t i = 0; i < NSTEALERS; ++i )
+    {
+        thieves[i].deque = &deque;
+        TEST( thieves[i].start( ));
+    }
+
+    uint64_t sum = 0;
+    for( uint64_t i = 1; i <= NTASKS; ++i )
+    {
+        deque.push( i );
+        if(( i % 3 ) == 0 && deque.pop( result ))
+            sum += result;
+    }
+    while( deque.pop( result ))
+        sum += result;
+
+    StealThread::done = 1;
+    uint64_t nStolen = 0;
+    for( size_t i = 0; i < NSTEALERS; ++i )
+    {
+        TEST( thieves[i].join( ));
+        sum += thieves[i].sum;
+        nStolen += thieves[i].nStolen;
+    }
+    TESTINFO( sum == uint64_t( NTASKS ) * ( NTASKS + 1 ) / 2,
+              sum << ", " << nStolen << " stolen" );
+}
+
+static void _testPool()
+{
+    lunchbox::ThreadPool pool( 4 );
+    TEST( pool.getSize() == 4 );
+    TEST( !pool.isWorkerThread( ));
+
+    lunchbox::Future< int > square = pool.post( boost::bind( &_square, 7 ));
+    TEST( square.wait() == 49 );
+    TEST( square.isReady( ));
+
+    _nExecuted = 0;
+    lunchbox::Future< void > done = pool.post( &_increment );
+    done.wait();
+    TEST( _nExecuted == 1 );
+
+    _nExecuted = 0;
+    TEST( _fibonacci( pool, 25 ) == 75025 );
+    TEST( _nExecuted == 986 ); // calls with n >= 12 post a child task
+
+    // finished jobs do not extend the timeout of a non-worker thread
+    lunchbox::Future< void > slow =
+        pool.post( boost::bind( &lunchbox::sleep, 1000 ));
+    lunchbox::Future< void > steady =
+        pool.post( boost::bind( &_postSteadily, boost::ref( pool )));
+    const lunchbox::Clock clock;
+    bool timedOut = false;
+    try
+    {
+        slow.wait( 100 );
+    }
+    catch( const lunchbox::FutureTimeout& )
+    {
+        timedOut = true;
+    }
+    const float time = clock.getTimef();
+    TESTINFO( timedOut && time < 500.f, time );
+    slow.wait();
+    steady.wait();
+}
+
+static void _benchmark()
+{
+    std::cout << "                Class,       tasks/ms, threads"
+              << std::endl;
+    for( size_t nThreads = 1; nThreads <= MAXTHREADS; nThreads <<= 1 )
+    {
+        _nExecuted = 0;
+        lunchbox::Clock clock;
+        {
+            lunchbox::ThreadPool pool( nThreads );
+            for( size_t i = 0; i < NTASKS; ++i )
+                pool.post( &_increment );
+        }
+        float time = clock.getTimef();
+        TEST( _nExecuted == NTASKS );
+        std::cout << std::setw( 21 ) << "ThreadPool" << ", "
+                  << std::setw( 14 ) << NTASKS / time << ", "
+                  << std::setw( 7 ) << nThreads << std::endl;
+
+        _nExecuted = 0;
+        clock.reset();
+        {
+            lunchbox::ThreadPool pool( nThreads );
+            _fibonacci( pool, 27 );
+        }
+        time = clock.getTimef();
+        std::cout << std::setw( 21 ) << "ThreadPool recursive" << ", "
+                  << std::setw( 14 ) << _nExecuted / time << ", "
+                  << std::setw( 7 ) << nThreads << std::endl;
+
+        _nExecuted = 0;
+        lunchbox::MTQueue< lunchbox::ThreadPool::Task* > queue;
+        SharedQueueWorker workers[ MAXTHREADS ];
+        clock.reset();
+        for( size_t i = 0; i < nThreads; ++i )
+        {
+            workers[i].queue = &queue;
+            TEST( workers[i].start( ));
+        }
+        for( size_t i = 0; i < NTASKS; ++i )
+            queue.push( new lunchbox::ThreadPool::Task( &_increment ));
+        for( size_t i = 0; i < nThreads; ++i )
+            queue.push( 0 );
+        for( size_t i = 0; i < nThreads; ++i )
+            TEST( workers[i].join( ));
+        time = clock.getTimef();
+        TEST( _nExecuted == NTASKS );
+        std::cout << std::setw( 21 ) << "MTQueue" << ", "
+                  << std::setw( 14 ) << NTASKS / time << ", "
+                  << std::setw( 7 ) << nThreads << std::endl;
+    }
+}
+
+int main( int, char** )
+{
+    _testDeque();
+    _testPool();
+    _benchmark();
+    return EXIT_SUCCESS;
+}
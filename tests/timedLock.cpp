@@ -18,10 +18,28 @@
 #include <test.h>
 
 #include <lunchbox/clock.h>
+#include <lunchbox/sleep.h>
+#include <lunchbox/thread.h>
 #include <lunchbox/timedLock.h>
 
 #include <iostream>
 
+#define NLOOPS 1000000
+
+class Waiter : public lunchbox::Thread
+{
+public:
+    explicit Waiter( lunchbox::TimedLock& lock ) : _lock( lock ) {}
+    virtual void run()
+    {
+        TEST( _lock.set( ));
+        _lock.unset();
+    }
+
+private:
+    lunchbox::TimedLock& _lock;
+};
+
 int main( int, char** )
 {
     lunchbox::TimedLock lock;
@@ -42,5 +60,22 @@ int main( int, char** )
     TESTINFO( time > 99.0f, "was: " << time );
     TESTINFO( time < 200.0f, "was: " << time );
 
+    // contended acquisition, later uncontended use has to stay in user space
+    Waiter waiter( lock );
+    TEST( waiter.start( ));
+    lunchbox::sleep( 10 );
+    lock.unset();
+    TEST( waiter.join( ));
+
+    clock.reset();
+    for( size_t i = 0; i < NLOOPS; ++i )
+    {
+        lock.set();
+        lock.unset();
+    }
+    time = clock.getTimef();
+    std::cout << time * 1000000.f / NLOOPS
+              << " ns/set-unset after a contended set" << std::endl;
+
     return EXIT_SUCCESS;
 }